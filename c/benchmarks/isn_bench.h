@@ -0,0 +1,178 @@
+/** \file
+ *  \brief ISN Micro-Benchmark Harness
+ *  \author Uros Platise <uros@isotel.org>
+ *
+ * Minimal header-only harness for the host benchmarks, which runs the
+ * measured function repeatedly and reports time per operation and the
+ * throughput:
+ * ~~~
+ * static void run(void *arg, size_t n) { ... do n operations ... }
+ *
+ * isn_bench_t b = ISN_BENCH("ring 64 B", 64);
+ * isn_bench_run(&b, run, NULL, 1000000);
+ * isn_bench_report(&b);
+ * ~~~
+ * On Linux, with the environment ISN_BENCH_PERF=1, each measured run is also
+ * wrapped with the perf_event_open() hardware counters: cycles, instructions,
+ * branch misses, L1 data and last level cache read misses. These of the best
+ * run are reported per unit of the layer operation, as given by:
+ * ~~~
+ * isn_bench_t b = ISN_BENCH_PER("frame decode", size, "byte", size);
+ * ~~~
+ * Counters not supported by the CPU, or the VM, are left out; perf may need
+ * `sysctl kernel.perf_event_paranoid=2` or lower.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_BENCH_H__
+#define __ISN_BENCH_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#define ISN_BENCH_COUNTERS  5
+
+typedef struct {
+    const char *name;
+    size_t bytes_per_op;        ///< to report throughput, or 0
+    size_t ops;                 ///< number of operations of the best run
+    double elapsed;             ///< seconds of the best run
+    const char *unit;           ///< of the counters, as "byte" or "packet", or NULL for per op
+    double units_per_op;
+    double counters[ISN_BENCH_COUNTERS];    ///< of the best run
+    unsigned counted;           ///< bit per valid counter
+} isn_bench_t;
+
+#define ISN_BENCH(name, bytes_per_op)   (isn_bench_t){ name, bytes_per_op, 0, 0.0 }
+
+/** Counters are reported per unit, of which there are units_per_op in each operation */
+#define ISN_BENCH_PER(name, bytes_per_op, unit, units_per_op)   (isn_bench_t){ name, bytes_per_op, 0, 0.0, unit, units_per_op }
+
+#ifndef ISN_BENCH_REPEAT
+# define ISN_BENCH_REPEAT   5   ///< runs, of which the fastest one is reported
+#endif
+
+static inline double isn_bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char * const isn_bench_counter_names[ISN_BENCH_COUNTERS] = {
+    "cycles", "instr", "br-miss", "L1d-miss", "LLC-miss"
+};
+
+static int isn_bench_perf_fd[ISN_BENCH_COUNTERS];
+
+/** Opens the counters once, if requested by the ISN_BENCH_PERF \returns bit per opened counter */
+static inline unsigned isn_bench_perf_open(void) {
+    static int opened = 0;
+    static unsigned mask = 0;
+    if (opened) return mask;
+    opened = 1;
+#ifdef __linux__
+    const char *env = getenv("ISN_BENCH_PERF");
+    if (!env || !*env || *env == '0') return 0;
+
+    #define ISN_BENCH_CACHE_MISS(cache)  ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+    static const struct { uint32_t type; uint64_t config; } events[ISN_BENCH_COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, ISN_BENCH_CACHE_MISS(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, ISN_BENCH_CACHE_MISS(PERF_COUNT_HW_CACHE_LL)}
+    };
+    for (int i = 0; i < ISN_BENCH_COUNTERS; i++) {
+        struct perf_event_attr attr = {0};
+        attr.size           = sizeof(attr);
+        attr.type           = events[i].type;
+        attr.config         = events[i].config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        isn_bench_perf_fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (isn_bench_perf_fd[i] >= 0) mask |= 1u << i;
+    }
+    if (!mask) fprintf(stderr, "perf counters are not available\n");
+#endif
+    return mask;
+}
+
+static inline void isn_bench_perf_start(unsigned mask) {
+#ifdef __linux__
+    for (int i = 0; i < ISN_BENCH_COUNTERS; i++) {
+        if (!(mask & (1u << i))) continue;
+        ioctl(isn_bench_perf_fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(isn_bench_perf_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/** Stops the counters and reads them, scaled if the kernel multiplexed them */
+static inline void isn_bench_perf_stop(unsigned mask, double *counters) {
+#ifdef __linux__
+    for (int i = 0; i < ISN_BENCH_COUNTERS; i++) {
+        if (mask & (1u << i)) ioctl(isn_bench_perf_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i = 0; i < ISN_BENCH_COUNTERS; i++) {
+        uint64_t v[3];      // value, time enabled, time running
+        if (!(mask & (1u << i)) || read(isn_bench_perf_fd[i], v, sizeof(v)) != sizeof(v)) continue;
+        counters[i] = v[2] ? (double)v[0] * v[1] / v[2] : 0.0;
+    }
+#endif
+}
+
+/** Run fn(arg, ops) ISN_BENCH_REPEAT times and keep the fastest */
+static inline void isn_bench_run(isn_bench_t *b, void (*fn)(void *arg, size_t ops), void *arg, size_t ops) {
+    double counters[ISN_BENCH_COUNTERS] = {0};
+    unsigned mask = isn_bench_perf_open();
+    fn(arg, ops / 10 + 1);      // warm-up
+    b->ops = ops;
+    b->elapsed = 0;
+    b->counted = mask;
+    for (int i = 0; i < ISN_BENCH_REPEAT; i++) {
+        isn_bench_perf_start(mask);
+        double start = isn_bench_now();
+        fn(arg, ops);
+        double t = isn_bench_now() - start;
+        isn_bench_perf_stop(mask, counters);
+        if (!b->elapsed || t < b->elapsed) {
+            b->elapsed = t;
+            for (int c = 0; c < ISN_BENCH_COUNTERS; c++) b->counters[c] = counters[c];
+        }
+    }
+}
+
+static inline void isn_bench_report(const isn_bench_t *b) {
+    double ns = b->elapsed * 1e9 / (b->ops ? b->ops : 1);
+    printf("%-32s %10.2f ns/op", b->name, ns);
+    if (b->bytes_per_op) printf(" %10.1f MB/s", b->bytes_per_op * b->ops / b->elapsed / 1e6);
+    printf("\n");
+
+    if (!b->counted) return;
+    double units = (double)b->ops * (b->units_per_op > 0 ? b->units_per_op : 1);
+    printf("%32s per %s:", "", b->unit ? b->unit : "op");
+    for (int i = 0; i < ISN_BENCH_COUNTERS; i++) {
+        if (b->counted & (1u << i)) printf(" %.3f %s", b->counters[i] / units, isn_bench_counter_names[i]);
+    }
+    if ((b->counted & 3) == 3 && b->counters[0] > 0) printf(" %.2f IPC", b->counters[1] / b->counters[0]);
+    printf("\n");
+}
+
+#endif
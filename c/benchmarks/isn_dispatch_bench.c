@@ -0,0 +1,68 @@
+/** \file
+ *  \brief Benchmark of the Dispatch Layer
+ *
+ * Dispatches a mix of packets of several protocols, one by one with recv()
+ * and at once with recv_batch(). Counters are reported per packet.
+ */
+
+#include <stdio.h>
+#include "isn.h"
+#include "isn_bench.h"
+
+#define PACKETS     256
+
+static size_t received;
+
+static size_t count_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    received++;
+    return size;
+}
+
+static size_t count_recv_batch(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller) {
+    received += count;
+    return count;
+}
+
+static isn_receiver_t user1 = {count_recv}, user2 = {count_recv}, msg = {count_recv, count_recv_batch}, other = {count_recv};
+
+static isn_bindings_t bindings[] = {
+    {ISN_PROTO_USER1, &user1},
+    {ISN_PROTO_USER2, &user2},
+    {ISN_PROTO_MSG,   &msg},
+    {ISN_PROTO_OTHER, &other}
+};
+
+static isn_dispatch_t dispatch;
+static isn_packet_t pkts[PACKETS];
+static uint8_t data[PACKETS][16];
+
+static void recv_each(void *arg, size_t ops) {
+    for (size_t i = 0; i < ops; i++) {
+        for (int p = 0; p < PACKETS; p++) dispatch.drv.recv(&dispatch, pkts[p].src, pkts[p].size, NULL);
+    }
+}
+
+static void recv_batch(void *arg, size_t ops) {
+    for (size_t i = 0; i < ops; i++) isn_recv_batch(&dispatch, pkts, PACKETS, NULL);
+}
+
+int main() {
+    /* Mostly messages in runs, with user packets and others in between */
+    static const uint8_t protocols[] = {ISN_PROTO_MSG, ISN_PROTO_MSG, ISN_PROTO_MSG, ISN_PROTO_USER1, ISN_PROTO_MSG, ISN_PROTO_USER2, 0x55};
+    for (int p = 0; p < PACKETS; p++) {
+        data[p][0] = protocols[(p * 7 / 3) % sizeof(protocols)];
+        pkts[p] = (isn_packet_t){data[p], sizeof(data[p])};
+    }
+    isn_dispatch_init(&dispatch, bindings);
+
+    isn_bench_t b = ISN_BENCH_PER("dispatch recv", 0, "packet", PACKETS);
+    isn_bench_run(&b, recv_each, NULL, 20000);
+    isn_bench_report(&b);
+
+    b = ISN_BENCH_PER("dispatch recv_batch", 0, "packet", PACKETS);
+    isn_bench_run(&b, recv_batch, NULL, 20000);
+    isn_bench_report(&b);
+
+    printf("%zu packets\n", received);
+    return 0;
+}
@@ -0,0 +1,102 @@
+/** \file
+ *  \brief Benchmark of the Frame Decoders on Mixed Terminal Text and Frames
+ *
+ * Feeds the compact and long frame decoders with the traffic of mostly text
+ * lines, as a console printing next to the frames, and of frames only, in
+ * 512 byte chunks. Counters are reported per byte of the traffic.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "isn.h"
+#include "isn_bench.h"
+
+#define TRAFFIC_SIZE    (64 * 1024)
+#define CHUNK           512
+
+static uint8_t traffic[TRAFFIC_SIZE];
+static size_t traffic_size;
+static size_t other_bytes, frame_bytes;
+
+static size_t other_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    other_bytes += size;
+    return size;
+}
+
+static size_t child_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    frame_bytes += size;
+    return size;
+}
+
+static uint8_t phy_buf[ISN_FRAME_LONG_MAXSIZE + 8];
+static size_t phy_size;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    if (dest) *dest = phy_buf;
+    return (size > sizeof(phy_buf)) ? sizeof(phy_buf) : size;
+}
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    phy_size = size;
+    return size;
+}
+
+static isn_driver_t phy;
+
+/** Text lines with a frame every few lines, or frames only */
+static void synthesize(isn_layer_t *encoder, int text) {
+    static const char line[] = "[   12.345678] sensor: temperature 23.5 C, humidity 41 %, all fine\r\n";
+    uint8_t payload[32];
+    traffic_size = 0;
+    for (int i = 0; traffic_size + sizeof(line) + sizeof(phy_buf) < TRAFFIC_SIZE; i++) {
+        if (text) {
+            memcpy(&traffic[traffic_size], line, sizeof(line) - 1);
+            traffic_size += sizeof(line) - 1;
+        }
+        if (!text || i % 4 == 0) {
+            memset(payload, i, sizeof(payload));
+            isn_write(encoder, payload, sizeof(payload));
+            memcpy(&traffic[traffic_size], phy_buf, phy_size);
+            traffic_size += phy_size;
+        }
+    }
+}
+
+static void decode(void *arg, size_t ops) {
+    isn_driver_t *decoder = arg;
+    for (size_t i = 0; i < ops; i++) {
+        for (size_t pos = 0; pos < traffic_size; pos += CHUNK) {
+            size_t size = (traffic_size - pos < CHUNK) ? traffic_size - pos : CHUNK;
+            decoder->recv(decoder, &traffic[pos], size, &phy);
+        }
+    }
+}
+
+int main() {
+    phy.getsendbuf = phy_getsendbuf;
+    phy.send       = phy_send;
+    phy.free       = phy_free;
+
+    isn_receiver_t child = {child_recv}, other = {other_recv};
+    isn_frame_t frame;
+    isn_frame_long_t frame_long;
+    isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &child, &other, &phy, ISN_CLOCK_ms(100));
+    isn_frame_long_init(&frame_long, &child, &other, &phy, ISN_CLOCK_ms(100));
+
+    static const struct { const char *name; int text; int lng; } cases[] = {
+        {"compact frame, mixed text", 1, 0},
+        {"compact frames", 0, 0},
+        {"long frame, mixed text", 1, 1},
+        {"long frames", 0, 1}
+    };
+    for (size_t c = 0; c < ARRAY_SIZE(cases); c++) {
+        isn_layer_t *decoder = cases[c].lng ? (isn_layer_t *)&frame_long : (isn_layer_t *)&frame;
+        synthesize(decoder, cases[c].text);
+        other_bytes = frame_bytes = 0;
+        isn_bench_t b = ISN_BENCH_PER(cases[c].name, traffic_size, "byte", traffic_size);
+        isn_bench_run(&b, decode, decoder, 1000);
+        isn_bench_report(&b);
+        printf("%zu other and %zu frame bytes\n", other_bytes, frame_bytes);
+    }
+    return 0;
+}
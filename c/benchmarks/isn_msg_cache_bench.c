@@ -0,0 +1,71 @@
+/** \file
+ *  \brief Benchmark of the Descriptor Cache
+ *
+ * Measures the enumeration of all descriptors of a message layer, running
+ * over the compact frame layer, with and without the descriptor cache.
+ * Counters are reported per message picked by the isn_msg_sched().
+ */
+
+#include <string.h>
+#include "isn.h"
+#include "isn_bench.h"
+
+#define MESSAGES    16
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[128];
+}
+isn_sink_t;
+
+static isn_sink_t phy;
+static isn_frame_t frame;
+static isn_message_t message;
+
+static isn_msg_table_t msg_table[MESSAGES + 1];
+static isn_msg_cache_entry_t entries[MESSAGES + 1];
+static uint8_t cache_buf[MESSAGES * 64];
+static isn_msg_cache_t cache;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    if (dest) *dest = phy.buf;
+    return (size > sizeof(phy.buf)) ? sizeof(phy.buf) : size;
+}
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) { return size; }
+
+static void enumerate(void *arg, size_t ops) {
+    for (size_t i = 0; i < ops; i++) {
+        for (uint8_t msgnum = 0; msgnum < MESSAGES; msgnum++) isn_msg_post(&message, msgnum, ISN_MSG_PRI_DESCRIPTION);
+        while (isn_msg_sched(&message));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+
+    msg_table[0] = (isn_msg_table_t){0, 0, NULL, "%T0{Descriptor Cache Benchmark}"};
+    for (int i = 1; i < MESSAGES; i++) {
+        msg_table[i] = (isn_msg_table_t){0, 0, NULL, "Parameter {:a}={%lu}{:b}={%lu}{:c}={%lu}[V]"};
+    }
+    msg_table[MESSAGES] = (isn_msg_table_t)ISN_MSG_DESC_END(0);
+
+    isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &message, NULL, &phy, ISN_CLOCK_ms(100));
+    isn_msg_init(&message, msg_table, ARRAY_SIZE(msg_table), &frame);
+    while (isn_msg_sched(&message));
+
+    isn_bench_t b = ISN_BENCH_PER("enumerate 16 descriptors", 0, "pick", MESSAGES);
+    isn_bench_run(&b, enumerate, NULL, 100000);
+    isn_bench_report(&b);
+
+    isn_msg_cache_init(&cache, &isn_frame_encoder, &frame, &phy, entries, ARRAY_SIZE(entries), cache_buf, sizeof(cache_buf));
+    isn_msg_setcache(&message, &cache);
+    isn_msg_cache_build(&message);
+
+    b = ISN_BENCH_PER("enumerate 16 cached descriptors", 0, "pick", MESSAGES);
+    isn_bench_run(&b, enumerate, NULL, 100000);
+    isn_bench_report(&b);
+    return 0;
+}
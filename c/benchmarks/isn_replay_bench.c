@@ -0,0 +1,104 @@
+/** \file
+ *  \brief Benchmark of a Stack by Replay of Captured Traffic
+ *
+ * Replays a capture as fast as possible into the compact frame layer with
+ * a loopback above it, and verifies the responses. Without an argument it
+ * first captures synthetic traffic of 1000 frames.
+ *
+ * Usage: BenchReplay [capture.pcap]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "isn.h"
+#include "posix/isn_capture.h"
+#include "isn_bench.h"
+
+#define FRAMES  1000
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[128];
+    uint8_t last[128];
+    size_t last_size;
+}
+isn_collector_t;
+
+static isn_collector_t phy;
+static isn_frame_t frame;
+static isn_redirect_t loopback;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    if (dest) *dest = phy.buf;
+    return (size > sizeof(phy.buf)) ? sizeof(phy.buf) : size;
+}
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    memcpy(phy.last, dest, size);
+    phy.last_size = size;
+    return size;
+}
+
+/** Encode frames with an own frame layer, and capture them passing the frame with loopback */
+static int synthesize(const char *filename) {
+    isn_frame_t encoder;
+    isn_frame_init(&encoder, ISN_FRAME_MODE_COMPACT, &loopback, NULL, &phy, ISN_CLOCK_ms(100));
+
+    isn_capture_t *cap = isn_capture_create(filename, &frame, &phy);
+    if (!cap) return -1;
+    isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &loopback, NULL, cap, ISN_CLOCK_ms(100));
+
+    uint8_t payload[32], encoded[128];
+    for (int i = 0; i < FRAMES; i++) {
+        size_t size = 1 + i % sizeof(payload);
+        memset(payload, i, size);
+        isn_write(&encoder, payload, size);
+        memcpy(encoded, phy.last, phy.last_size);
+        ((isn_driver_t *)cap)->recv(cap, encoded, phy.last_size, &phy);
+    }
+    isn_capture_drop(cap);
+    return 0;
+}
+
+static void replay(void *arg, size_t ops) {
+    isn_replay_t *rep = arg;
+    for (size_t i = 0; i < ops; i++) {
+        isn_replay_rewind(rep);
+        while (isn_replay_poll(rep) > 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    char filename[] = "/tmp/isn_replay_XXXXXX";
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+    isn_loopback_init(&loopback);
+
+    if (argc < 2) {
+        int fd = mkstemp(filename);
+        if (fd < 0 || synthesize(filename) < 0) return 1;
+        close(fd);
+    }
+
+    isn_replay_t *rep = isn_replay_create(argc < 2 ? filename : argv[1], &frame);
+    if (!rep) {
+        fprintf(stderr, "Cannot load the capture\n");
+        return 1;
+    }
+    isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &loopback, NULL, rep, ISN_CLOCK_ms(100));
+
+    replay(rep, 1);
+    uint32_t records = ((isn_driver_t *)rep)->stats.rx_packets;
+    isn_bench_t b = ISN_BENCH("replay capture", ((isn_driver_t *)rep)->stats.rx_counter);
+    isn_bench_run(&b, replay, rep, 100);
+    isn_bench_report(&b);
+    printf("%u records per pass, %u mismatches\n", records, isn_replay_mismatches(rep));
+
+    int err = isn_replay_mismatches(rep) ? 2 : 0;
+    isn_replay_drop(rep);
+    if (argc < 2) unlink(filename);
+    return err;
+}
@@ -0,0 +1,101 @@
+/** \file
+ *  \brief Benchmark of the Zero-Copy Circular Buffer
+ *
+ * Measures the single threaded reserve/commit/peek/consume round trip
+ * for various segment sizes, and the throughput between two threads,
+ * which also verifies the stream under concurrent access.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "isn_ring.h"
+#include "isn_bench.h"
+
+static uint8_t buf[4096];
+static isn_ring_t ring;
+static size_t segment;
+
+static void roundtrip(void *arg, size_t ops) {
+    void *dest;
+    const void *src;
+    for (size_t i = 0; i < ops; i++) {
+        size_t size = isn_ring_reserve(&ring, &dest, segment);
+        memset(dest, (int)i, size);
+        isn_ring_commit(&ring, size);
+        size = isn_ring_peek(&ring, &src);
+        isn_ring_consume(&ring, size);
+    }
+}
+
+static void bytes(void *arg, size_t ops) {
+    for (size_t i = 0; i < ops; i++) {
+        isn_ring_putbyte(&ring, (uint8_t)i);
+        isn_ring_getbyte(&ring);
+    }
+}
+
+static volatile int failed;
+
+static void *consumer(void *arg) {
+    size_t total = *(size_t *)arg, rx = 0;
+    uint8_t seq = 0;
+    const void *src;
+    while (rx < total) {
+        size_t size = isn_ring_peek(&ring, &src);
+        if (!size) sched_yield();      // let the producer run on single core hosts
+        for (size_t i = 0; i < size; i++) {
+            if (((const uint8_t *)src)[i] != seq++) failed = 1;
+        }
+        isn_ring_consume(&ring, size);
+        rx += size;
+    }
+    return NULL;
+}
+
+static void threaded(void *arg, size_t ops) {
+    size_t total = ops * segment, tx = 0;
+    uint8_t seq = 0;
+    pthread_t th;
+    void *dest;
+
+    isn_ring_reset(&ring);
+    pthread_create(&th, NULL, consumer, &total);
+    while (tx < total) {
+        size_t size = isn_ring_reserve(&ring, &dest, total - tx < segment ? total - tx : segment);
+        if (!size) sched_yield();
+        for (size_t i = 0; i < size; i++) ((uint8_t *)dest)[i] = seq++;
+        isn_ring_commit(&ring, size);
+        tx += size;
+    }
+    pthread_join(th, NULL);
+}
+
+int main(int argc, char *argv[]) {
+    static const size_t segments[] = {16, 64, 256, 1024};
+    char name[64];
+
+    isn_ring_init(&ring, buf, sizeof(buf));
+    for (size_t i = 0; i < sizeof(segments) / sizeof(segments[0]); i++) {
+        segment = segments[i];
+        snprintf(name, sizeof(name), "roundtrip %zu B", segment);
+        isn_bench_t b = ISN_BENCH(name, segment);
+        isn_bench_run(&b, roundtrip, NULL, 1000000);
+        isn_bench_report(&b);
+    }
+
+    isn_bench_t b = ISN_BENCH("putbyte/getbyte", 1);
+    isn_bench_run(&b, bytes, NULL, 10000000);
+    isn_bench_report(&b);
+
+    for (size_t i = 0; i < sizeof(segments) / sizeof(segments[0]); i++) {
+        segment = segments[i];
+        snprintf(name, sizeof(name), "2 threads %zu B", segment);
+        isn_bench_t b = ISN_BENCH(name, segment);
+        isn_bench_run(&b, threaded, NULL, 100000);
+        isn_bench_report(&b);
+    }
+    if (failed) printf("Stream corrupted\n");
+    return failed;
+}
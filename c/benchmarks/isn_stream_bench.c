@@ -0,0 +1,67 @@
+/** \file
+ *  \brief Benchmark of the Sample Streaming Layer
+ *
+ * Measures the throughput of blocks streamed over the user layer, in a
+ * loopback into the receiver's ring, which is consumed after each block.
+ */
+
+#include <string.h>
+#include "isn.h"
+#include "isn_stream.h"
+#include "isn_bench.h"
+
+#define BLOCK_SIZE  256
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[BLOCK_SIZE + 16];
+}
+isn_loopback_phy_t;
+
+static isn_loopback_phy_t phy;
+static isn_user_t tx_user, rx_user;
+static isn_stream_t tx, rx;
+static uint8_t blocks[ISN_STREAM_BUF_SIZE(BLOCK_SIZE, 2)];
+static uint8_t ring_buf[4 * BLOCK_SIZE];
+static isn_ring_t ring;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    if (dest) *dest = phy.buf;
+    return (size > sizeof(phy.buf)) ? sizeof(phy.buf) : size;
+}
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    return rx_user.drv.recv(&rx_user, dest, size, drv);
+}
+
+static void stream(void *arg, size_t ops) {
+    for (size_t i = 0; i < ops; i++) {
+        void *s = isn_stream_getblock(&tx);
+        if (s) {
+            memset(s, (int)i, BLOCK_SIZE);
+            isn_stream_commit(&tx, (uint32_t)i);
+        }
+        isn_stream_flush(&tx);
+
+        const void *src;
+        size_t size;
+        while ((size = isn_ring_peek(&ring, &src)) > 0) isn_ring_consume(&ring, size);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+
+    isn_ring_init(&ring, ring_buf, sizeof(ring_buf));
+    isn_user_init(&tx_user, NULL, &phy, ISN_PROTO_USER1);
+    isn_user_init(&rx_user, &rx, &phy, ISN_PROTO_USER1);
+    isn_stream_init(&tx, &tx_user, blocks, BLOCK_SIZE, 2, NULL);
+    isn_stream_init(&rx, NULL, NULL, 0, 0, &ring);
+
+    isn_bench_t b = ISN_BENCH("stream 256 B blocks", BLOCK_SIZE);
+    isn_bench_run(&b, stream, NULL, 1000000);
+    isn_bench_report(&b);
+    return (rx.gaps || tx.drv.stats.tx_dropped) ? 1 : 0;
+}
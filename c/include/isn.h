@@ -19,5 +19,6 @@
 #include "isn_io.h"
 #include "isn_reactor.h"
 #include "isn_clock.h"
+#include "isn_arena.h"
 
 #endif
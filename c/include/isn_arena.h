@@ -0,0 +1,125 @@
+/** \file
+ *  \brief ISN Object Arena
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_arena.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Arena Object Arena
+ *
+ * # Scope
+ *
+ * Places all objects of one protocol stack, and their buffers, into a single
+ * contiguous block of memory, with objects aligned to the cache line. Such
+ * a stack is constructed without a call to the malloc() per each object,
+ * keeps the objects on the receive path close one to another, and is released
+ * at once.
+ *
+ * # Concept
+ *
+ * The arena is a simple bump allocator; objects cannot be freed individually,
+ * only the entire arena with isn_arena_drop(), or it may be reused after
+ * isn_arena_reset(). Memory returned is zero-initialized.
+ *
+ * On hosts the arena is typically created on the heap with isn_arena_create(),
+ * i.e. a gateway building a stack per each device:
+ * ~~~
+ * isn_arena_t *arena = isn_arena_create(1024);
+ * isn_frame_t *frame = ISN_ARENA_NEW(arena, isn_frame_t);
+ * isn_dispatch_t *dispatch = ISN_ARENA_NEW(arena, isn_dispatch_t);
+ *
+ * isn_dispatch_init(dispatch, bindings);
+ * isn_frame_init(frame, ISN_FRAME_MODE_COMPACT, dispatch, NULL, phy, ISN_CLOCK_ms(100));
+ * ...
+ * isn_arena_drop(arena);
+ * ~~~
+ * while on MCUs a compile-time sized static pool is declared instead:
+ * ~~~
+ * ISN_ARENA_STATIC(stack_pool, 512);
+ *
+ * isn_frame_t *frame = ISN_ARENA_NEW(&stack_pool, isn_frame_t);
+ * ~~~
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_ARENA_H__
+#define __ISN_ARENA_H__
+
+#include "isn_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* CONFIGURATION                                                      */
+/*--------------------------------------------------------------------*/
+
+/** Alignment of objects, a cache line size on hosts, MCUs may lower it to 4 */
+#ifndef CONFIG_ISN_ARENA_ALIGN
+# define CONFIG_ISN_ARENA_ALIGN     64
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t *base;      ///< aligned start of the memory block
+    size_t size;        ///< size of the memory block
+    size_t used;        ///< number of bytes handed out
+    size_t high;        ///< high watermark of the used
+}
+isn_arena_t;
+
+/** Declares a static, compile-time sized pool */
+#define ISN_ARENA_STATIC(name, size_) \
+    static uint8_t name ## _mem[size_] __attribute__((aligned(CONFIG_ISN_ARENA_ALIGN))); \
+    static isn_arena_t name = {name ## _mem, size_, 0, 0}
+
+/** Allocates an object of a given type, returns NULL if arena is exhausted */
+#define ISN_ARENA_NEW(arena, type)      ((type *)isn_arena_alloc(arena, sizeof(type)))
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Creates an arena of a given size with a single malloc(), including this structure */
+isn_arena_t* isn_arena_create(size_t size);
+
+/** Drops the arena created by isn_arena_create() and all objects in it */
+void isn_arena_drop(isn_arena_t *obj);
+
+/** Arena over user provided memory
+ *
+ * \param obj
+ * \param mem pointer to memory, which is aligned if needed
+ * \param size of the memory
+ */
+void isn_arena_init(isn_arena_t *obj, void *mem, size_t size);
+
+/** Allocate zero-initialized and aligned memory
+ *
+ * \param obj
+ * \param size
+ * \returns pointer or NULL if arena is exhausted
+ */
+void *isn_arena_alloc(isn_arena_t *obj, size_t size);
+
+/** Releases all objects at once, for the arena to be reused */
+void isn_arena_reset(isn_arena_t *obj);
+
+/** Returns number of remaining bytes */
+static inline size_t isn_arena_avail(const isn_arena_t *obj) { return obj->size - obj->used; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+/** \file
+ *  \brief ISN Tasklet Argument Pool
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_argpool.c
+ */
+/**
+ * \ingroup GR_ISN_Reactor
+ * \defgroup GR_ISN_ArgPool Tasklet Argument Pool
+ *
+ * # Scope
+ *
+ * Carries a small payload, i.e. a received frame, with a deferred tasklet,
+ * without a static buffer or a malloc(), and without a hand-made release.
+ *
+ * # Concept
+ *
+ * The pool has a fixed number of equally sized slots in caller provided, or
+ * on hosts heap, memory. Slots are claimed and released lock-free, so they
+ * may be released by another thread or core. The reactor copies the payload
+ * into a slot, passes the slot as the argument of the tasklet, and releases
+ * it when the tasklet and its caller have completed, also when the tasklet is
+ * posted to a channel of another core, or is dropped:
+ * ~~~
+ * ISN_ARGPOOL_STATIC(frames_pool, 64, 8);
+ * isn_reactor_setargpool(&frames_pool);
+ *
+ * static void *process_frame(void *arg) {
+ *     const uint8_t *frame = arg;     // valid until this tasklet and its caller complete
+ *     ...
+ *     return NULL;
+ * }
+ *
+ * size_t recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+ *     return (isn_reactor_queue_copy(process_frame, src, size) < 0) ? 0 : size;
+ * }
+ * ~~~
+ * For cross-core posts the pool must be placed in memory shared by the cores.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_ARGPOOL_H__
+#define __ISN_ARGPOOL_H__
+
+#include "isn_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+typedef struct isn_argpool_s {
+    volatile uint32_t *bitmap;      ///< Set bit per used slot
+    uint8_t *slots;
+    uint16_t slot_size;             ///< Including the header, multiple of 8
+    uint16_t payload_size;
+    uint16_t nslots;
+    volatile uint16_t used;
+    uint16_t high;                  ///< High watermark of the used
+    uint32_t failed;                ///< Number of allocations failed as the pool was exhausted
+}
+isn_argpool_t;
+
+/** Size of a slot for the payload, including the header pointing to the pool */
+#define ISN_ARGPOOL_SLOT_SIZE(payload)          ((sizeof(isn_argpool_t *) + (payload) + 7) & ~(size_t)7)
+
+/** Size of the memory for nslots slots of payload bytes, including the bitmap */
+#define ISN_ARGPOOL_SIZE(payload, nslots)       (((nslots) + 63) / 64 * 8 + (nslots) * ISN_ARGPOOL_SLOT_SIZE(payload))
+
+/** Declares a static, compile-time sized pool */
+#define ISN_ARGPOOL_STATIC(name, payload, nslots) \
+    static uint64_t name ## _mem[ISN_ARGPOOL_SIZE(payload, nslots) / 8]; \
+    static isn_argpool_t name = {(uint32_t *)name ## _mem, (uint8_t *)name ## _mem + ((nslots) + 63) / 64 * 8, \
+                                 ISN_ARGPOOL_SLOT_SIZE(payload), payload, nslots, 0, 0, 0}
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Creates a pool with a single malloc(), including this structure */
+isn_argpool_t* isn_argpool_create(size_t payload_size, uint16_t nslots);
+
+void isn_argpool_drop(isn_argpool_t *obj);
+
+/** Pool over user provided memory
+ *
+ * \param obj
+ * \param mem of ISN_ARGPOOL_SIZE(payload_size, nslots) bytes, 8-byte aligned
+ * \param payload_size max. size of the payload per slot
+ * \param nslots number of slots
+ */
+void isn_argpool_init(isn_argpool_t *obj, void *mem, size_t payload_size, uint16_t nslots);
+
+/** Claim a slot, from any thread, core or interrupt
+ *
+ * \returns pointer to the payload of at least size bytes, or NULL if too big or pool is exhausted
+ */
+void *isn_argpool_alloc(isn_argpool_t *obj, size_t size);
+
+/** Claim a slot and copy the data in it \returns pointer to the copy, or NULL */
+void *isn_argpool_copy(isn_argpool_t *obj, const void *data, size_t size);
+
+/** Release the slot to its pool, from any thread, core or interrupt
+ *
+ * \param ptr returned by isn_argpool_alloc() or isn_argpool_copy(), NULL is ignored
+ */
+void isn_argpool_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
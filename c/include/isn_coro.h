@@ -0,0 +1,164 @@
+/** \file
+ *  \brief Stackless Coroutines for the Reactor
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_reactor.h
+ */
+/**
+ * \ingroup GR_ISN_Reactor
+ * \defgroup GR_ISN_Coro Stackless Coroutines
+ *
+ * # Scope
+ *
+ * Writes multi-step flows, as query a device, wait for the reply, retry and
+ * post-process, as a single reactor tasklet, instead of a chain of tasklets
+ * with hand-made states. A coroutine requires no stack of its own, only the
+ * few bytes of the isn_coro_t, and it keeps its reactor entry while waiting,
+ * so resuming costs as much as any other tasklet execution.
+ *
+ * # Concept
+ *
+ * A coroutine is a tasklet which body is enclosed by ISN_CORO_BEGIN() and
+ * ISN_CORO_END(). Each of the waits records the resume point, and returns
+ * from the tasklet with a pointer to itself, which keeps the tasklet in the
+ * queue, see isn_reactor_change_timed_self(). The next execution jumps to
+ * the recorded point. As the stack is not preserved, the variables that live
+ * across the waits must be kept in the argument, together with the state:
+ * ~~~
+ * typedef struct {
+ *     isn_coro_t co;
+ *     int retries;
+ * } query_t;
+ *
+ * void *query_task(void *arg) {
+ *     query_t *q = arg;
+ *     ISN_CORO_BEGIN(&q->co, query_task);
+ *
+ *     ISN_CORO_LOCK(&q->co, i2c_mutex);                   // exclusive access to the bus
+ *     for (q->retries = 0; q->retries < 3; q->retries++) {
+ *         i2c_start_read();
+ *         ISN_CORO_WAIT(&q->co, ISN_CLOCK_ms(10));        // i2c_done_isr() calls isn_coro_notify(&q->co)
+ *         if (!ISN_CORO_TIMEDOUT(&q->co)) break;
+ *         ISN_CORO_DELAY(&q->co, ISN_CLOCK_ms(1));
+ *     }
+ *     isn_reactor_mutex_unlock(i2c_mutex);
+ *
+ *     ISN_CORO_END(&q->co, NULL);
+ * }
+ *
+ * isn_reactor_queue(query_task, &query);
+ * ~~~
+ *
+ * Waits:
+ *
+ * - ISN_CORO_YIELD() continues in the next reactor pass,
+ * - ISN_CORO_DELAY() and ISN_CORO_REPEAT() continue after a delay, the latter one without accumulating errors,
+ * - ISN_CORO_LOCK() continues once the mutex is obtained, without executing meanwhile,
+ * - ISN_CORO_WAIT() continues when another tasklet, a channel event from another core, an interrupt or a
+ *   message handler, i.e. on the reply of the \ref GR_ISN_Message query, calls isn_coro_notify(), or on timeout,
+ * - ISN_CORO_AWAIT() polls a condition in each reactor pass, and should be used only for short waits.
+ *
+ * Waits may not be used in a switch statement of the coroutine body, and there
+ * may be only one wait per source line, as the line number is the resume point.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_CORO_H__
+#define __ISN_CORO_H__
+
+#include "isn_reactor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+/** Coroutine State */
+typedef struct {
+    uint16_t lc;                    ///< Resume point, 0 to start from the beginning
+    int index;                      ///< Reactor handle waiting for the isn_coro_notify(), or -1
+    uint8_t timedout;               ///< Set when the last ISN_CORO_WAIT() has timed out
+    isn_reactor_tasklet_t self;     ///< The tasklet, returned to remain in the queue
+}
+isn_coro_t;
+
+#define ISN_CORO_INIT               { 0, -1, 0, NULL }
+
+/** Restart the coroutine from the beginning on its next execution */
+static inline void isn_coro_init(isn_coro_t *co) { co->lc = 0; co->index = -1; co->timedout = 0; }
+
+/** Start of the coroutine body, in the tasklet self */
+#define ISN_CORO_BEGIN(co, self_) \
+    (co)->self = ISN_EVENT(self_); \
+    switch ((co)->lc) { case 0:
+
+/** End of the coroutine body, returning retval to the caller of the tasklet, if any */
+#define ISN_CORO_END(co, retval) \
+    } (co)->lc = 0; return (retval)
+
+/** Continue in the next reactor pass */
+#define ISN_CORO_YIELD(co) \
+    do { (co)->lc = __LINE__; return (void *)(co)->self; case __LINE__:; } while (0)
+
+/** Continue after at least delay ticks */
+#define ISN_CORO_DELAY(co, delay) \
+    do { isn_reactor_change_timed_self(ISN_REACTOR_DELAY_ticks(delay)); ISN_CORO_YIELD(co); } while (0)
+
+/** Continue a period of ticks after the previous execution time, for periodic loops */
+#define ISN_CORO_REPEAT(co, period) \
+    do { isn_reactor_change_timed_self(ISN_REACTOR_REPEAT_ticks(period)); ISN_CORO_YIELD(co); } while (0)
+
+/** Continue once the mutex is locked by this coroutine, which should unlock it later */
+#define ISN_CORO_LOCK(co, mutex) \
+    do { \
+        isn_reactor_change_mutex_self(mutex); \
+        (co)->lc = __LINE__; return (void *)(co)->self; case __LINE__: \
+        if (isn_reactor_mutex_lock(mutex)) return (void *)(co)->self; \
+        isn_reactor_change_mutex_self(0); \
+    } while (0)
+
+/** Continue on isn_coro_notify(), or after timeout ticks, see ISN_CORO_TIMEDOUT() */
+#define ISN_CORO_WAIT(co, timeout) \
+    do { \
+        (co)->index = isn_reactor_self(); \
+        isn_reactor_change_timed_self(ISN_REACTOR_DELAY_ticks(timeout)); \
+        (co)->lc = __LINE__; return (void *)(co)->self; case __LINE__: \
+        (co)->timedout = ((co)->index >= 0); \
+        (co)->index = -1; \
+    } while (0)
+
+/** Non-zero if the last ISN_CORO_WAIT() ended by timeout */
+#define ISN_CORO_TIMEDOUT(co)       ((co)->timedout)
+
+/** Continue when the condition is true, checked in each reactor pass */
+#define ISN_CORO_AWAIT(co, cond) \
+    do { (co)->lc = __LINE__; case __LINE__: if (!(cond)) return (void *)(co)->self; } while (0)
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Resume the coroutine waiting in the ISN_CORO_WAIT(), from any tasklet or interrupt
+ *
+ * \returns 1 if coroutine was waiting, 0 otherwise
+ */
+static inline int isn_coro_notify(isn_coro_t *co) {
+    int handle = co->index;
+    if (handle < 0) return 0;
+    co->index = -1;
+    return isn_reactor_retime(handle, ISN_CLOCK_NOW);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
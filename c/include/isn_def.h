@@ -207,6 +207,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "config.h"
 
 #ifdef __cplusplus
@@ -271,15 +272,47 @@ typedef struct {
     uint32_t tx_retries;    ///< Number of retries
 } ISN_PACKED_ALIGNED isn_driver_stats_t;
 
+#define ISN_DRIVER_STATS_DESC_RX    "RX rx{{:packets}={%lu}{:bytes}={%lu}{:errors}={%lu}"
+#define ISN_DRIVER_STATS_DESC_RXTX  "+{:retries}={%lu}{:dropped}={%lu}}\nTX tx{{:packets}={%lu}"
+#define ISN_DRIVER_STATS_DESC_TX    "+{:bytes}={%lu}{:dropped}={%lu}{:retries}={%lu}}\n"
+
 #define ISN_DRIVER_STATS_DESC(cb, paragraph) \
-    {0, sizeof(isn_driver_stats_t), cb, paragraph "RX rx{{:packets}={%lu}{:bytes}={%lu}{:errors}={%lu}"}, \
-    {0, 0,                        NULL, "+{:retries}={%lu}{:dropped}={%lu}}\nTX tx{{:packets}={%lu}"}, \
-    {0, 0,                        NULL, "+{:bytes}={%lu}{:dropped}={%lu}{:retries}={%lu}}\n" }
+    {0, sizeof(isn_driver_stats_t), cb, paragraph ISN_DRIVER_STATS_DESC_RX}, \
+    {0, 0,                        NULL, ISN_DRIVER_STATS_DESC_RXTX}, \
+    {0, 0,                        NULL, ISN_DRIVER_STATS_DESC_TX }
                                       //"----+----1----+----2----+----3----+----4----+----5----+----6-"
 
 /** C-like Weak Abstract class of isn_drives_t */
 typedef void isn_layer_t;
 
+/**
+ * Packet Descriptor, as passed to the recv_batch()
+ */
+typedef struct {
+    const void *src;        ///< pointer to received data
+    size_t size;            ///< size of the received data
+}
+isn_packet_t;
+
+/**
+ * Frame Encoder, to produce complete frames ahead of time, i.e. for caching
+ */
+typedef struct {
+    uint8_t header;         ///< bytes preceding the payload
+    uint8_t overhead;       ///< max bytes added to the payload, including the header
+    uint16_t max_payload;   ///< max size of the payload in a single frame
+
+    /** Complete the frame in place
+     *
+     * \param layer frame layer, providing the format
+     * \param frame buffer holding the payload at frame + header, and space for the overhead
+     * \param size of the payload
+     * \returns size of the complete frame
+     */
+    size_t (*encode)(const isn_layer_t *layer, uint8_t *frame, size_t size);
+}
+isn_encoder_t;
+
 /**
  * ISN Layer (Driver)
  */
@@ -301,6 +334,21 @@ typedef struct isn_driver_s {
      */
     size_t (*recv)(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
 
+    /** Receive a Batch of Packets (optional)
+     *
+     * Layers which can amortize the per packet overhead, i.e. the timeout checks,
+     * the protocol lookup, and the chain of calls, may provide this method, otherwise
+     * it must be NULL. Callers should use the isn_recv_batch() which falls back to
+     * recv() per each packet.
+     *
+     * \param pkts array of received packets
+     * \param count number of packets in the array
+     * \param caller device driver structure, enbles simple echoing or multi-path replies
+     * \returns number of packets processed; if less than count, the packet at this index
+     *          was not (completely) processed, as with the recv(), and source should retry
+     */
+    size_t (*recv_batch)(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller);
+
     /** Allocate buffer for transmission thru layers
      *
      * If dest is NULL then function only performs a check on availability and returns
@@ -338,17 +386,42 @@ typedef struct isn_driver_s {
 
     /** Driver statistics */
     isn_driver_stats_t stats;
+
+    /** Memory class of the buffers provided by this layer, see isn_memclass_t */
+    uint8_t memclass;
 }
 isn_driver_t;
 
 /**
  * ISN Layer Receiver only
+ *
+ * Shares the first two members with the isn_driver_t, so the recv_batch is
+ * left NULL when initialized as `&(isn_receiver_t){recv}`.
  */
 typedef struct {
     size_t (*recv)(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller);
+    size_t (*recv_batch)(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller);
 }
 isn_receiver_t;
 
+/**
+ * Pass a batch of packets to a layer
+ *
+ * Uses the layer's recv_batch() if provided, otherwise calls recv() for each
+ * packet and stops at the first packet which was not completely accepted.
+ *
+ * \returns number of packets completely processed
+ */
+static inline size_t isn_recv_batch(isn_layer_t *layer, const isn_packet_t *pkts, size_t count, isn_layer_t *caller) {
+    isn_receiver_t *drv = (isn_receiver_t *)layer;
+    if (drv->recv_batch) return drv->recv_batch(drv, pkts, count, caller);
+    size_t i;
+    for (i=0; i<count; i++) {
+        if (drv->recv(drv, pkts[i].src, pkts[i].size, caller) < pkts[i].size) break;
+    }
+    return i;
+}
+
 /**
  * Callback event handler
  */
@@ -371,10 +444,58 @@ static inline void volatile_memcpy(volatile void* dst, volatile const void *src,
 void isn_memcpy(volatile void* dst, volatile const void *src, size_t size) __attribute__ ((weak, alias("volatile_memcpy")));
 
 #else
-#include <string.h>
 static inline void* isn_memcpy(volatile void* dst, volatile const void *src, size_t size) { return memcpy( (void *)dst, (const void *)src, size ); }
 #endif
 
+/**
+ * Memory Class of the buffers, which a layer provides with the getsendbuf(),
+ * or passes to its children with the recv().
+ *
+ * Buffers in the DMA, uncached or shared memory are copied with the safe
+ * isn_memcpy(), and all others with the memcpy(), which is word wide or
+ * vectorized by the compiler. Layers that pass buffers of their parent
+ * through, the frame, user, transport and QoS layers, inherit the class of
+ * the parent in their init, so the parent is to be initialized first.
+ */
+typedef enum {
+    ISN_MEMCLASS_DEFAULT = 0,   ///< Untagged, resolved by the CONFIG_ISN_MEMCLASS_DEFAULT
+    ISN_MEMCLASS_NORMAL,        ///< Cached RAM
+    ISN_MEMCLASS_DMA            ///< DMA, uncached or shared memory
+}
+isn_memclass_t;
+
+/** Memory class of untagged layers; hosted systems do not share buffers with the DMA */
+#ifndef CONFIG_ISN_MEMCLASS_DEFAULT
+# if defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+#  define CONFIG_ISN_MEMCLASS_DEFAULT   ISN_MEMCLASS_NORMAL
+# else
+#  define CONFIG_ISN_MEMCLASS_DEFAULT   ISN_MEMCLASS_DMA
+# endif
+#endif
+
+/** Memory class of a driver, i.e. a parent, or the caller of the recv()
+ *
+ * \param layer implementing the isn_driver_t, or NULL
+ * \returns memory class of the layer, or the default one for NULL or untagged layers
+ */
+static inline isn_memclass_t isn_memclass(const isn_layer_t *layer) {
+    uint8_t memclass = layer ? ((const isn_driver_t *)layer)->memclass : (uint8_t)ISN_MEMCLASS_DEFAULT;
+    return (memclass == ISN_MEMCLASS_DEFAULT) ? (isn_memclass_t)CONFIG_ISN_MEMCLASS_DEFAULT : (isn_memclass_t)memclass;
+}
+
+/** Buffer Copy, dispatched by the memory class of the buffers */
+static inline void isn_memcpy_class(isn_memclass_t memclass, volatile void* dst, volatile const void *src, size_t size) {
+    if (memclass == ISN_MEMCLASS_DEFAULT) memclass = CONFIG_ISN_MEMCLASS_DEFAULT;
+    if (memclass == ISN_MEMCLASS_NORMAL) memcpy((void *)dst, (const void *)src, size);
+    else isn_memcpy(dst, src, size);
+}
+
+/** Buffer Copy between the buffers of two layers, safe if any of them is in the DMA memory */
+static inline void isn_layer_memcpy(const isn_layer_t *dst_layer, volatile void* dst, const isn_layer_t *src_layer, volatile const void *src, size_t size) {
+    isn_memclass_t dc = isn_memclass(dst_layer), sc = isn_memclass(src_layer);
+    isn_memcpy_class(dc > sc ? dc : sc, dst, src, size);
+}
+
 
 /**\} */
 
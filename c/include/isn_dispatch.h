@@ -96,6 +96,17 @@ isn_dispatch_t;
 /* Public functions                                                     */
 /*----------------------------------------------------------------------*/
 
+/** Returns protocol of the packet, with all frame protocols mapped to their base id */
+static inline int isn_dispatch_protocol(const void *buf) {
+    int protocol = *(const uint8_t *)buf;
+
+    // exceptions are frame protocols
+    if ((protocol & ISN_PROTO_FRAME_MASK) == ISN_PROTO_FRAME) protocol = ISN_PROTO_FRAME;
+    else if ((protocol & ISN_PROTO_FRAME_LONG_MASK) == ISN_PROTO_FRAME_LONG) protocol = ISN_PROTO_FRAME_LONG;
+    else if ((protocol & ISN_PROTO_FRAME_JUMBO_MASK) == ISN_PROTO_FRAME_JUMBO) protocol = ISN_PROTO_FRAME_JUMBO;
+    return protocol;
+}
+
 isn_dispatch_t* isn_dispatch_create();
 
 void isn_dispatch_drop(isn_dispatch_t *obj);
@@ -34,8 +34,8 @@
  * (c) Copyright 2020, Isotel, http://isotel.org
  */
 
-#ifndef __ISN_DISPATCH_H__
-#define __ISN_DISPATCH_H__
+#ifndef __ISN_DUP_H__
+#define __ISN_DUP_H__
 
 #include "isn_def.h"
 
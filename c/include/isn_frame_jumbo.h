@@ -33,6 +33,7 @@
 
 #include "isn_def.h"
 #include "isn_clock.h"
+#include "isn_timeout.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,7 @@ typedef struct {
     uint8_t recv_size;
     uint16_t recv_len;
     uint32_t last_ts;
+    isn_timeout_t *adaptive;
     uint8_t recv_buf[ISN_FRAME_JUMBO_MAXSIZE];   // make this parameter user defined
 }
 isn_frame_jumbo_t;
@@ -78,6 +80,22 @@ isn_frame_jumbo_t;
  */
 void isn_frame_jumbo_init(isn_frame_jumbo_t *obj, isn_layer_t* child, isn_layer_t* other, isn_layer_t* parent, isn_clock_counter_t timeout);
 
+/** Learn the frame timeout from the link, see \ref GR_ISN_Timeout
+ *
+ * \param obj
+ * \param adaptive initialized timeout, or NULL to keep the last timeout fixed
+ */
+void isn_frame_jumbo_setadaptive(isn_frame_jumbo_t *obj, isn_timeout_t *adaptive);
+
+/** Encode the payload at frame + header into a complete frame in place
+ *
+ * \returns size of the frame
+ */
+size_t isn_frame_jumbo_encode(const isn_layer_t *drv, uint8_t *frame, size_t size);
+
+/** Encoder of the jumbo frames, i.e. for the isn_msg_cache_init() */
+extern const isn_encoder_t isn_frame_jumbo_encoder;
+
 /** Creates an instance of a Short and Compact Frame Layer
  *  Instance is allocated with malloc and can be freed with isn_frame_drop()
  *
@@ -0,0 +1,170 @@
+/** \file
+ *  \brief ISN Metrics Registry
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_metrics.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Metrics Metrics Registry
+ *
+ * # Scope
+ *
+ * Collects run-time counters of the protocol layers, reactor and drivers,
+ * and exposes them thru the \ref GR_ISN_Message as a generated set of
+ * message table entries, optionally streamed out periodically. The same
+ * ISN channel is thus used to monitor the performance of the devices.
+ *
+ * # Concept
+ *
+ * Layers register their isn_driver_stats_t with isn_metrics_add_layer(),
+ * and other counters are added as pre-defined message table entries with
+ * isn_metrics_add(), as the reactor provides with the ISN_REACTOR_STATS_DESC().
+ * The isn_metrics_generate() then appends the entries to the end of the
+ * application message table, followed by the terminating message:
+ * ~~~
+ * static isn_msg_table_t isn_msg_table[16] = {
+ *     { 0, 0, NULL, "%T0{MyCompany FlashLight} {#sno}={12345678}" },
+ *     { 0, sizeof(led_t), led_cb, "LED {:red}={%hu}{:green}={%hu}{:blue}={%hu}" },
+ * };
+ * static isn_metric_t metrics[4];
+ *
+ * isn_metrics_init(&isn_metrics, metrics, ARRAY_SIZE(metrics));
+ * isn_metrics_add_layer(&isn_metrics, "UART ", &isn_uart);
+ * isn_metrics_add_layer(&isn_metrics, "Frame ", &isn_frame);
+ * isn_metrics_add(&isn_metrics, (isn_msg_table_t[]){ ISN_REACTOR_STATS_DESC("Reactor ") }, 1);
+ *
+ * uint8_t size = isn_metrics_generate(&isn_metrics, isn_msg_table, 2, ARRAY_SIZE(isn_msg_table));
+ * isn_msg_init(&isn_message, isn_msg_table, size, &isn_frame);
+ * isn_metrics_stream(&isn_metrics, &isn_message, ISN_CLOCK_s(5));
+ * ~~~
+ * Host may reset the driver statistics by writing zeros to them.
+ *
+ * Streaming is driven by the reactor when message layer is radiated, see
+ * isn_msg_radiate(), otherwise call isn_metrics_sched() from the main loop.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_METRICS_H__
+#define __ISN_METRICS_H__
+
+#include "isn_def.h"
+#include "isn_msg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* CONFIGURATION                                                      */
+/*--------------------------------------------------------------------*/
+
+/** Size of the generated descriptor, which holds the label */
+#ifndef CONFIG_ISN_METRICS_DESC_SIZE
+# define CONFIG_ISN_METRICS_DESC_SIZE   64
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+/** Registered metric */
+typedef struct {
+    const isn_msg_table_t *entries;     ///< pre-defined message table entries, or NULL for driver statistics
+    uint8_t count;                      ///< number of entries
+    isn_driver_stats_t *stats;          ///< driver statistics
+    char desc[CONFIG_ISN_METRICS_DESC_SIZE];    ///< generated first descriptor of the driver statistics
+}
+isn_metric_t;
+
+typedef struct isn_metrics_s {
+    isn_metric_t *metrics;
+    uint8_t size;
+    uint8_t count;
+
+    isn_msg_table_t *table;             ///< message table with generated entries
+    uint8_t first;                      ///< message number of the first generated entry
+    uint8_t last;                       ///< message number following the generated entries
+
+    isn_message_t *msg;                 ///< message layer used for streaming
+    isn_clock_counter_t period;         ///< streaming period, 0 to disable
+    isn_clock_counter_t last_ts;
+    uint8_t queued;                     ///< stream event is in the reactor queue
+
+    struct isn_metrics_s *next;         ///< list of registries, to map messages back to metrics
+}
+isn_metrics_t;
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Metrics Registry
+ *
+ * \param obj
+ * \param metrics pre-allocated table of metrics
+ * \param size of the table
+ */
+void isn_metrics_init(isn_metrics_t *obj, isn_metric_t *metrics, uint8_t size);
+
+/** Register driver statistics
+ *
+ * \param obj
+ * \param label prepended to the descriptor, i.e. a name followed by a space
+ * \param stats
+ * \returns 0 on success, -1 if the registry is full
+ */
+int isn_metrics_add_stats(isn_metrics_t *obj, const char *label, isn_driver_stats_t *stats);
+
+/** Register statistics of a protocol layer, which must be of isn_driver_t type */
+static inline int isn_metrics_add_layer(isn_metrics_t *obj, const char *label, isn_layer_t *layer) {
+    return isn_metrics_add_stats(obj, label, &((isn_driver_t *)layer)->stats);
+}
+
+/** Register pre-defined message table entries, which must remain valid
+ *
+ * \returns 0 on success, -1 if the registry is full
+ */
+int isn_metrics_add(isn_metrics_t *obj, const isn_msg_table_t *entries, uint8_t count);
+
+/** \returns number of message table entries, excluding the terminating one, required for all metrics */
+uint8_t isn_metrics_entries(const isn_metrics_t *obj);
+
+/** Append metrics to the message table
+ *
+ * \param obj
+ * \param table application message table
+ * \param first position where to place the first metric, typically number of application messages
+ * \param size total capacity of the table
+ * \returns new size of the table to be passed to isn_msg_init(), including the terminating message,
+ *          or 0 if table is too small
+ */
+uint8_t isn_metrics_generate(isn_metrics_t *obj, isn_msg_table_t *table, uint8_t first, uint8_t size);
+
+/** Stream out metrics periodically
+ *
+ * \param obj
+ * \param msg message layer initialized with the generated table
+ * \param period in clock ticks, or 0 to disable
+ */
+void isn_metrics_stream(isn_metrics_t *obj, isn_message_t *msg, isn_clock_counter_t period);
+
+/** Post all metrics to be sent out at once */
+void isn_metrics_post(isn_metrics_t *obj);
+
+/** Post metrics if period has elapsed, to be called from the main loop when reactor is not used
+ *
+ * \returns 1 if metrics were posted
+ */
+int isn_metrics_sched(isn_metrics_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -86,6 +86,11 @@
  * 3. The 3rd message is the mandatory last terminator message and may in addition
  *    provide device checksum.
  *
+ * Optional fifth field holds the length of the descriptor, i.e. ISN_MSG_DESC_LEN(),
+ * to avoid measuring it on every transmission. Tables, their argument structs and
+ * message numbers can also be generated from a schema by the `tools/isn_msggen.py`,
+ * which verifies the structs against the descriptors at build time.
+ *
  * The table is then passed to the isn_msg_init(). The parent protocol (`isn_parent_protocol`)
  * will act as stimulus from the interface side, and the device itself posts message by
  * isn_msg_send() and isn_msg_sendqby() methods. The main loop handles these requests
@@ -120,6 +125,21 @@
  *    it should specify the priority from `ISN_MSG_PRI_LOW` to `ISN_MSG_PRI_HIGHEST`
  *    preferably by using macros.
  *
+ * Priorities tell which messages are pending, and these are sent out in a
+ * round-robin way. Where freshness matters, i.e. telemetry that is worth
+ * something only if it arrives within 20 ms, deadlines may be enabled instead:
+ * ~~~
+ * static isn_clock_counter_t deadlines[ARRAY_SIZE(isn_msg_table)];
+ *
+ * isn_msg_setdeadlines(&isn_message, deadlines);
+ * isn_msg_send_within(&isn_message, MSG_TELEMETRY, ISN_MSG_PRI_NORMAL, ISN_CLOCK_ms(20));
+ * ~~~
+ * The scheduler then picks the earliest deadline first among the sendable
+ * messages, after the received input and the requested descriptors, and the
+ * messages without a deadline when none is left. Messages sent after their
+ * deadline are counted in the `deadlines_missed`, and those in time in the
+ * `deadlines_met`, to measure how well the link serves them.
+ *
  * # Requesting for Data or Updating the Data
  *
  * Message layer allows to send request to other device for arguments using the
@@ -221,6 +241,41 @@
  * so a device may just monitor this return value to identify if
  * other peer is responding correctly. When all requests are handled
  * function returns 0 (pending requests).
+ *
+ * # Transactions
+ *
+ * Related parameters, i.e. the gains and the limits of a PID controller, would
+ * otherwise take an ISN_MGG_PRI_UPDATE_ARGS round trip each, and the device would
+ * run with a half updated set in between. A transaction carries updates of several
+ * messages in a single message of the ISN_MSG_TXN_SIZE, as records of a message
+ * number followed by its arguments, zero terminated. Both sides add it to their
+ * tables with the isn_msg_txn_cb() handler:
+ * ~~~
+ * static isn_msg_table_t isn_msg_table[] = {
+ *   ...
+ *   { 0, ISN_MSG_TXN_SIZE, isn_msg_txn_cb, "Transaction" },
+ *   ISN_MSG_DESC_END(0)
+ * };
+ * static isn_msg_txn_t txn;
+ *
+ * isn_msg_settxn(&isn_message, &txn, MSG_TXN, NULL);
+ * ~~~
+ * The requester then collects the updates and commits them:
+ * ~~~
+ * isn_msg_txn_begin(&isn_message);
+ * isn_msg_txn_add(&isn_message, MSG_GAINS, &gains);
+ * isn_msg_txn_add(&isn_message, MSG_LIMITS, &limits);
+ * isn_msg_txn_commit(&isn_message);
+ * ...
+ * if (txn.state == ISN_MSG_TXN_APPLIED) ...
+ * ~~~
+ * The device checks all records, and the optional validate handler, before any is
+ * applied; then calls the handlers one after another within a single schedule, so
+ * no other message is handled in between, and replies once with the records as
+ * applied, or with none when rejected. The confirmation is passed to the handlers
+ * of the requester, as a reply to the update would be. The commit is locked and
+ * resent as any other ISN_MGG_PRI_UPDATE_ARGS. Either side may begin a transaction,
+ * once the previous one is confirmed.
  */
 /*
  * This Source Code Form is subject to the terms of the Mozilla Public
@@ -266,6 +321,21 @@ extern "C" {
 # define CONFIG_ISN_MSG_SINGLE_QUERY 0
 #endif
 
+/** Check the message table at init and clear pending messages without arguments.
+ *  Tables generated by the tools/isn_msggen.py are verified at build time and
+ *  this check may be disabled when only such tables are used.
+ */
+#ifndef CONFIG_ISN_MSG_SANITY_CHECK
+# define CONFIG_ISN_MSG_SANITY_CHECK 1
+#endif
+
+/** Size of the transaction message, by default fitting the short frame with the message header,
+ *  and at most the receive buffer, RECV_MESSAGE_SIZE
+ */
+#ifndef CONFIG_ISN_MSG_TXN_SIZE
+# define CONFIG_ISN_MSG_TXN_SIZE 62
+#endif
+
 /*--------------------------------------------------------------------*/
 /* DEFINITIONS                                                        */
 /*--------------------------------------------------------------------*/
@@ -295,7 +365,8 @@ extern "C" {
 #define ISN_MSG_PRI_LOW             0x01
 #define ISN_MSG_PRI_CLEAR           0x00
 
-#define ISN_MSG_DESC_END(pri)       { pri, 0, NULL, "%!" }
+#define ISN_MSG_DESC_END(pri)       { pri, 0, NULL, "%!", 2 }
+#define ISN_MSG_DESC_LEN(literal)   (sizeof(literal) - 1)   ///< Length of the string literal descriptor, for the desc_len
 
 typedef uint8_t isn_msg_size_t;
 
@@ -304,13 +375,67 @@ typedef struct {
     isn_msg_size_t       size;      ///< size of data
     isn_events_handler_t handler;   ///< callback handler, or NULL if a message contains no arguments
     const char*          desc;      ///< pointer to message descriptor
+    isn_msg_size_t       desc_len;  ///< length of the descriptor, or 0 to be determined at run-time
 }
 isn_msg_table_t;
 
+/** Immutable part of the message table, which may reside in flash and be shared among
+ *  message layers, see isn_msg_init_desc(). Layout and initializers match the isn_msg_table_t.
+ */
+typedef struct {
+    uint8_t              priority;  ///< initial priority, copied to the priorities at init
+    isn_msg_size_t       size;      ///< size of data
+    isn_events_handler_t handler;   ///< callback handler, or NULL if a message contains no arguments
+    const char*          desc;      ///< pointer to message descriptor
+    isn_msg_size_t       desc_len;  ///< length of the descriptor, or 0 to be determined at run-time
+}
+isn_msg_desc_t;
+
 extern uint8_t handler_priority;
 
+/** Encoded descriptor in the cache */
+typedef struct {
+    uint16_t offset;
+    uint16_t size;                  ///< size of the complete frame, 0 if not yet encoded
+    uint16_t payload;               ///< size of the message, for the statistics
+}
+isn_msg_cache_entry_t;
+
+/** Cache of the encoded descriptors, see isn_msg_cache_init() */
+typedef struct {
+    const isn_encoder_t *encoder;   ///< format of the parent frame layer
+    isn_layer_t *frame;             ///< parent frame layer, which is bypassed
+    isn_layer_t *phy;               ///< parent of the frame layer, receiving complete frames
+    isn_msg_cache_entry_t *entries; ///< one per message
+    uint8_t count;                  ///< number of entries
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t used;
+}
+isn_msg_cache_t;
+
 #define RECV_MESSAGE_SIZE           64
 
+#define ISN_MSG_TXN_SIZE            CONFIG_ISN_MSG_TXN_SIZE ///< Size of the transaction message
+
+#define ISN_MSG_TXN_IDLE            0       ///< Not committed, records may be added
+#define ISN_MSG_TXN_PENDING         1       ///< Committed, waiting for the confirmation
+#define ISN_MSG_TXN_APPLIED         2       ///< Applied on the device, as confirmed
+#define ISN_MSG_TXN_REJECTED        3       ///< Rejected by the device, none applied
+
+/** Transaction, see isn_msg_settxn() */
+typedef struct {
+    uint8_t buf[ISN_MSG_TXN_SIZE];  ///< Records of message number and arguments, zero terminated
+    uint8_t msgnum;                 ///< Transaction message in the table
+    uint8_t used;                   ///< Size of the records added
+    volatile uint8_t state;         ///< One of the ISN_MSG_TXN_*
+    uint8_t requester;              ///< Set by the isn_msg_txn_begin() until confirmed, the reply while pending is the confirmation
+    uint8_t confirmed;              ///< Last was own transaction, and its confirmation, if received again, is ignored
+    uint8_t calling;                ///< Handler of a record is in a call
+    isn_events_handler_t validate;  ///< Optional, given the received records, returns NULL to reject them
+}
+isn_msg_txn_t;
+
 /** Internal struct, note the alignment of the message_buffer, which should be aligned to (4)
  *  More info on align: https://stackoverflow.com/questions/4306186/structure-padding-and-packing
  */
@@ -320,13 +445,17 @@ typedef struct isn_message_s {
 
     /* Private data */
     isn_driver_t* parent_driver;
-    isn_msg_table_t* isn_msg_table;             ///< Ref to the message table
+    isn_msg_table_t* isn_msg_table;             ///< Ref to the message table, or NULL when initialized by isn_msg_init_desc()
+    const isn_msg_desc_t* isn_msg_desc;         ///< Descriptors, either of the isn_msg_table or the shared ones
+    volatile uint8_t* priorities;               ///< Priority of each message, in the isn_msg_table or a separate array
+    uint8_t priorities_stride;                  ///< Distance between the priorities
     uint8_t message_buffer[RECV_MESSAGE_SIZE];  ///< Receive buffer
     uint8_t isn_msg_table_size;                 ///< It's size
     uint8_t isn_msg_received_msgnum;            ///< Receive buffer's message number to which isn_msg_received_data belongs
     void* isn_msg_received_data;                ///< Receive buffer's pointer
     const void *handler_input;                  ///< Copy of handlers input data to be used with isn_msg_isinput_valid() only
     int32_t handler_msgnum;                     ///< Message number of a handler in a call
+    uint8_t *handler_output;                    ///< Transmit buffer reserved by the isn_msg_getoutbuf() during a handler call
     uint8_t handler_priority;
     uint8_t pending;
     uint8_t active;                             ///< Number of active messages
@@ -336,6 +465,11 @@ typedef struct isn_message_s {
     uint32_t resend_timer;
 
     struct isn_message_s *dup;                  ///< Duplicate updates to another message layer (i.e. for tracing or cross-updating)
+    isn_msg_cache_t *cache;                     ///< Encoded descriptors, or NULL
+    isn_clock_counter_t *deadlines;             ///< Deadline of each message, 0 if none, or NULL when scheduled round-robin
+    uint32_t deadlines_met;                     ///< Messages sent by their deadline
+    uint32_t deadlines_missed;                  ///< Messages sent after their deadline
+    isn_msg_txn_t *txn;                         ///< Transaction, or NULL
 
     isn_reactor_queue_t queue;                  ///< Reactor queue
     isn_reactor_mutex_t busy_mutex;             ///< Controlled by msg layer when busy
@@ -345,6 +479,9 @@ isn_message_t;
 
 extern isn_message_t *isn_msg_self;
 
+/** Current priority of the message */
+#define ISN_MSG_PRIORITY(obj, msgnum)   (obj)->priorities[(msgnum) * (obj)->priorities_stride]
+
 /*----------------------------------------------------------------------*/
 /* Public functions                                                     */
 /*----------------------------------------------------------------------*/
@@ -362,6 +499,31 @@ void isn_msg_drop(isn_message_t *obj);
  */
 void isn_msg_init(isn_message_t *obj, isn_msg_table_t* messages, uint8_t size, isn_layer_t* parent);
 
+/** Initialize Message Layer with Shared Descriptors
+ *
+ * The scheduling state is kept in a compact per-instance array, so descriptors may be const,
+ * and shared by several message layers, i.e. virtual devices of the same kind. Handlers
+ * may tell them apart by the isn_msg_self.
+ * ~~~
+ * static const isn_msg_desc_t led_desc[] = {
+ *   { 0, 0,             NULL,   "%T0{MyCompany FlashLight} {#sno}={12345678}" },
+ *   { 0, sizeof(led_t), led_cb, "LED {:red}={%hu}{:green}={%hu}{:blue}={%hu}" },
+ *   ISN_MSG_DESC_END(0)
+ * };
+ * static uint8_t led1_priorities[ARRAY_SIZE(led_desc)], led2_priorities[ARRAY_SIZE(led_desc)];
+ *
+ * isn_msg_init_desc(&led1, led_desc, led1_priorities, ARRAY_SIZE(led_desc), &isn_parent_protocol);
+ * isn_msg_init_desc(&led2, led_desc, led2_priorities, ARRAY_SIZE(led_desc), &isn_other_protocol);
+ * ~~~
+ *
+ * \param obj
+ * \param descs table of message descriptors
+ * \param priorities array of size elements, initialized from the descs
+ * \param size of the table, which is equal to number of messages in a table
+ * \param parent object
+ */
+void isn_msg_init_desc(isn_message_t *obj, const isn_msg_desc_t *descs, uint8_t *priorities, uint8_t size, isn_layer_t* parent);
+
 /** Enable reactor
  *
  * \param obj
@@ -371,6 +533,44 @@ void isn_msg_init(isn_message_t *obj, isn_msg_table_t* messages, uint8_t size, i
  */
 void isn_msg_radiate(isn_message_t *obj, isn_reactor_queue_t priority_queue, isn_reactor_mutex_t busy_mutex, isn_reactor_mutex_t holdon_mutex);
 
+/** Cache of Encoded Descriptors
+ *
+ * Descriptors are constant, yet each request for them copies them into the frame, which
+ * is then encoded again. With the cache each descriptor is encoded once, on the first
+ * request, and later sent out directly to the parent of the frame layer with a single copy:
+ * ~~~
+ * static isn_msg_cache_entry_t entries[ARRAY_SIZE(isn_msg_table)];
+ * static uint8_t cache_buf[1024];
+ * static isn_msg_cache_t cache;
+ *
+ * isn_msg_cache_init(&cache, &isn_frame_encoder, &isn_frame, &isn_uart, entries, ARRAY_SIZE(entries), cache_buf, sizeof(cache_buf));
+ * isn_msg_setcache(&isn_message, &cache);
+ * ~~~
+ * Descriptors which do not fit the buffer, or the max_payload of the encoder, are sent as usual,
+ * as are those for which the phy has no buffer at the moment. The cache may be shared by the message
+ * layers with the same descriptors, see isn_msg_init_desc(), and parent frame layers of the same format.
+ *
+ * \param cache
+ * \param encoder of the parent frame layer, i.e. isn_frame_encoder
+ * \param frame parent frame layer of the message layer
+ * \param phy parent of the frame layer
+ * \param entries array with an entry for each message
+ * \param count number of entries
+ * \param buf to store the encoded frames
+ * \param size of the buf
+ */
+void isn_msg_cache_init(isn_msg_cache_t *cache, const isn_encoder_t *encoder, isn_layer_t *frame, isn_layer_t *phy,
+                        isn_msg_cache_entry_t *entries, uint8_t count, void *buf, size_t size);
+
+/** Enable the cache, or disable it with NULL */
+static inline void isn_msg_setcache(isn_message_t *obj, isn_msg_cache_t *cache) {obj->cache = cache;}
+
+/** Encode all descriptors ahead, instead on the first request
+ *
+ * \returns number of descriptors in the cache
+ */
+int isn_msg_cache_build(isn_message_t *obj);
+
 /** Duplicate message updates
  * 
  * \param obj
@@ -415,6 +615,67 @@ void isn_msg_post(isn_message_t *obj, uint8_t message_id, uint8_t priority);
  */
 void isn_msg_send(isn_message_t *obj, uint8_t message_id, uint8_t priority);
 
+/** Post message by id to be sent by the deadline, interrupt/thread safe
+ *
+ * Used as the isn_msg_post() when the deadlines are enabled by the isn_msg_setdeadlines(),
+ * and otherwise the deadline is ignored. A pending message keeps the earlier deadline.
+ *
+ * \param obj
+ * \param message_id
+ * \param priority as with the isn_msg_post()
+ * \param deadline absolute time, i.e. ISN_CLOCK_NOW + ISN_CLOCK_ms(20)
+ */
+void isn_msg_post_until(isn_message_t *obj, uint8_t message_id, uint8_t priority, isn_clock_counter_t deadline);
+
+/** Send message by id with its maximum age
+ *
+ * \param obj
+ * \param message_id
+ * \param priority as with the isn_msg_send()
+ * \param max_age relative to now, after which the message is sent late
+ */
+void isn_msg_send_within(isn_message_t *obj, uint8_t message_id, uint8_t priority, isn_clock_counter_t max_age);
+
+/** Enable the earliest deadline first scheduling, or disable it with NULL
+ *
+ * \param obj
+ * \param deadlines array with an entry for each message, cleared, as are the statistics
+ */
+void isn_msg_setdeadlines(isn_message_t *obj, isn_clock_counter_t *deadlines);
+
+/** Enable the transactions
+ *
+ * \param obj
+ * \param txn transaction state and buffer
+ * \param msgnum of the transaction message, of the ISN_MSG_TXN_SIZE with the isn_msg_txn_cb() handler
+ * \param validate optional handler given the received records, before any is applied, returns NULL to reject them
+ */
+void isn_msg_settxn(isn_message_t *obj, isn_msg_txn_t *txn, uint8_t msgnum, isn_events_handler_t validate);
+
+/** Handler of the transaction message, to be put in the message table */
+void *isn_msg_txn_cb(const void *data);
+
+/** Begin a new transaction
+ *
+ * \returns 0 on success, or -1 if not enabled or the previous one is still pending
+ */
+int isn_msg_txn_begin(isn_message_t *obj);
+
+/** Add an update of the message to the transaction
+ *
+ * \param obj
+ * \param message_id of a message with arguments and a handler
+ * \param data arguments of the message size
+ * \returns 0 on success, or -1 if the message cannot be a part of it, or it does not fit
+ */
+int isn_msg_txn_add(isn_message_t *obj, uint8_t message_id, const void *data);
+
+/** Commit the transaction, to be sent as a single update
+ *
+ * \returns 0 on success, or -1 if empty or already committed
+ */
+int isn_msg_txn_commit(isn_message_t *obj);
+
 /** Send message quickly by callback handler given msgnum, start of the search
  *
  * Typical usage:
@@ -475,6 +736,30 @@ int isn_msg_discardpending(isn_message_t *obj);
  */
 int isn_msg_isinput_valid(isn_message_t *obj, const void *arg);
 
+/**
+ * Callback may call this function to obtain the transmit buffer of its reply
+ * and write the arguments there directly, saving a copy of large messages.
+ *
+ * The buffer is reserved from the parent on the first call and the same
+ * pointer is returned by the subsequent calls within the same callback.
+ * Returning it from the callback sends it as is, returning any other pointer
+ * copies the data into it, and returning NULL releases it.
+ * ~~~
+ * static void *samples_cb(const void *data) {
+ *     samples_t *out = isn_msg_getoutbuf(&isn_message);
+ *     if (!out) out = &samples;    // fallback, copied on send
+ *     fill_samples(out);
+ *     return out;
+ * }
+ * ~~~
+ *
+ * \param obj
+ * \returns pointer to the message arguments in the transmit buffer, or NULL
+ *   when called outside a callback, when no reply will be sent, or when the
+ *   parent has no buffer of the message size available
+ */
+void *isn_msg_getoutbuf(isn_message_t *obj);
+
 /**
  * Set logger (debugging) level
  */
@@ -494,7 +779,7 @@ static inline int isn_msg_noactive(isn_message_t *obj) { return obj->active; }
  * \param obj
  * \param msgnum index to message_id previously provided by this same function to speed up the search.
  */
-static inline int isn_msg_isdone(isn_message_t *obj, uint8_t msgnum) { return obj->isn_msg_table[msgnum].priority == ISN_MSG_PRI_CLEAR;}
+static inline int isn_msg_isdone(isn_message_t *obj, uint8_t msgnum) { return ISN_MSG_PRIORITY(obj, msgnum) == ISN_MSG_PRI_CLEAR;}
 
 /**
  * To be used within the callback, it may ask with which priority
@@ -0,0 +1,167 @@
+/** \file
+ *  \brief ISN Transmit QoS Scheduler
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_qos.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_QoS Transmit QoS Scheduler
+ *
+ * # Scope
+ *
+ * Implements a transparent transmit scheduler, which is placed in between the
+ * children layers and their parent, typically the PHY, to arbitrate the parent
+ * transmission buffer among several callers, so that latency-critical message
+ * replies are not blocked by bulk user streams.
+ *
+ * # Concept
+ *
+ * Each child layer calls the getsendbuf() with itself as the `caller`, which
+ * propagates thru the intermediate layers, as \ref GR_ISN_Frame, \ref GR_ISN_User,
+ * and so on, down to this object. The `caller` is matched against the list of
+ * classes given by isn_qos_class_t, each holding its own small queue of packets.
+ *
+ * As long nothing is queued and parent has space available, the parent buffer is
+ * handed out directly (zero-copy). When parent is busy, packets are stored into
+ * the class queue and are later sent out by the isn_qos_flush() according to the
+ * selected policy:
+ *
+ * - `ISN_QOS_POLICY_STRICT`, the class with the highest priority is always served first,
+ * - `ISN_QOS_POLICY_WEIGHTED`, the bandwidth is shared among classes proportionally to
+ *   their weights, using the deficit round-robin.
+ *
+ * Per class statistics is kept in the isn_qos_class_t.stats.
+ *
+ * An example of usage, giving the message layer precedence over the user stream:
+ * ~~~
+ * static isn_qos_slot_t msg_slots[2], user_slots[4];
+ * static isn_qos_class_t qos_classes[] = {
+ *     {&isn_message, 2, 1, msg_slots,  ARRAY_SIZE(msg_slots)},
+ *     {&isn_user,    1, 1, user_slots, ARRAY_SIZE(user_slots)},
+ * };
+ *
+ * isn_qos_init(&isn_qos, ISN_QOS_POLICY_STRICT, qos_classes, ARRAY_SIZE(qos_classes), &isn_frame, &isn_uart);
+ * isn_frame_init(&isn_frame, ISN_FRAME_MODE_COMPACT, &isn_dispatch, NULL, &isn_qos, ISN_CLOCK_ms(100));
+ * ~~~
+ * and call isn_qos_flush() whenever parent may have released its buffers, i.e. from
+ * the main loop or from a timed reactor event.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_QOS_H__
+#define __ISN_QOS_H__
+
+#include "isn_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* CONFIGURATION                                                      */
+/*--------------------------------------------------------------------*/
+
+/** Max size of a queued packet, as seen by the parent layer */
+#ifndef CONFIG_ISN_QOS_SLOT_SIZE
+# define CONFIG_ISN_QOS_SLOT_SIZE   64
+#endif
+
+/** Deficit round-robin quantum per unit of weight, must be >= CONFIG_ISN_QOS_SLOT_SIZE */
+#ifndef CONFIG_ISN_QOS_QUANTUM
+# define CONFIG_ISN_QOS_QUANTUM     CONFIG_ISN_QOS_SLOT_SIZE
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+typedef enum {
+    ISN_QOS_POLICY_STRICT   = 0,    ///< Strict priority, higher value first
+    ISN_QOS_POLICY_WEIGHTED = 1     ///< Weighted fair, deficit round-robin
+}
+isn_qos_policy_t;
+
+/** Single packet queue entry */
+typedef struct {
+    uint16_t size;
+    uint8_t  data[CONFIG_ISN_QOS_SLOT_SIZE];
+}
+isn_qos_slot_t;
+
+/** QoS Class Table Entry
+ *
+ * Provide the first five parameters, the run-time parameters are reset by the isn_qos_init()
+ */
+typedef struct {
+    const isn_layer_t *caller;  ///< Layer, as passed to the getsendbuf() caller argument, NULL matches any caller
+    uint8_t priority;           ///< Used by the strict policy, higher value is served first
+    uint8_t weight;             ///< Used by the weighted policy, relative share of bandwidth
+    isn_qos_slot_t *slots;      ///< Queue of packets
+    uint8_t depth;              ///< Number of slots
+
+    uint8_t wri, rdi, count;    ///< Queue run-time state
+    int32_t deficit;            ///< Deficit round-robin counter in bytes
+    isn_driver_stats_t stats;   ///< Per class statistics, only tx part is used
+}
+isn_qos_class_t;
+
+typedef struct {
+    /* ISN Abstract Class Driver */
+    isn_driver_t drv;
+
+    /* Private data */
+    isn_driver_t* parent;
+    isn_driver_t* child;
+    isn_qos_class_t *classes;
+    uint8_t classes_size;
+    isn_qos_policy_t policy;
+    uint8_t queued;             ///< Total number of queued packets
+    uint8_t rr;                 ///< Weighted round-robin position
+    uint8_t rr_credited;        ///< Quantum was already added to rr class
+    isn_qos_class_t *alloc;     ///< Class to which the last slot was handed out
+    void *direct;               ///< Parent buffer handed out directly
+    isn_qos_class_t *direct_class;
+}
+isn_qos_t;
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+isn_qos_t* isn_qos_create();
+
+void isn_qos_drop(isn_qos_t *obj);
+
+/** QoS Scheduler
+ *
+ * \param obj
+ * \param policy selects strict priority or weighted fair arbitration
+ * \param classes table, provide pointer to pre-allocated table, the run-time parameters will be reset by this function
+ * \param classes_size number of entries in the table
+ * \param child layer to which received data is passed thru, may be NULL if parent forwards data elsewhere
+ * \param parent protocol layer, which is typically a PHY
+ */
+void isn_qos_init(isn_qos_t *obj, isn_qos_policy_t policy, isn_qos_class_t *classes, uint8_t classes_size,
+                  isn_layer_t* child, isn_layer_t* parent);
+
+/** Send out queued packets as long parent accepts them
+ *
+ * \param obj
+ * \returns number of packets still queued
+ */
+int isn_qos_flush(isn_qos_t *obj);
+
+/** Change policy at run-time */
+static inline void isn_qos_setpolicy(isn_qos_t *obj, isn_qos_policy_t policy) { obj->policy = policy; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -140,7 +140,9 @@ The problem is, where is this reference counter or atomic or bit-bang mem? to ke
 
 #include <stddef.h>
 #include <stdint.h>
+#include "isn_def.h"
 #include "isn_clock.h"
+#include "isn_argpool.h"
 
 /*--------------------------------------------------------------------*/
 /* DEFINITIONS                                                        */
@@ -168,6 +170,23 @@ typedef int (* isn_reactor_queue_t)(const isn_reactor_tasklet_t tasklet, void* a
 
 extern isn_clock_counter_t _isn_reactor_active_timestamp;
 
+extern uint32_t isn_tasklet_queue_size;     ///< Number of pending tasklets
+extern uint32_t isn_tasklet_queue_max;      ///< High watermark of the isn_tasklet_queue_size
+extern uint32_t isn_tasklet_lateness_max;   ///< Max. delay of tasklet execution past its time, in clock ticks
+extern uint32_t isn_tasklet_queue_capacity; ///< Number of entries, grows on hosts as needed
+
+/** Snapshot of reactor counters, as returned by isn_reactor_stats_cb() */
+typedef struct {
+    uint32_t queue_size;
+    uint32_t queue_max;
+    uint32_t lateness_max;
+    uint32_t queue_capacity;
+} ISN_PACKED_ALIGNED isn_reactor_stats_t;
+
+/** Message table entry exposing the reactor counters, see \ref GR_ISN_Metrics */
+#define ISN_REACTOR_STATS_DESC(paragraph) \
+    {0, sizeof(isn_reactor_stats_t), isn_reactor_stats_cb, paragraph "Queue {:size}={%lu}{:max}={%lu}{:lateness}={%lu}[ticks]{:capacity}={%lu}"}
+
 struct isn_tasklet_queue;
 typedef struct isn_tasklet_entry {
     isn_reactor_tasklet_t tasklet;
@@ -175,6 +194,8 @@ typedef struct isn_tasklet_entry {
     struct isn_tasklet_queue* caller_queue; ///< Cross-cpu calling back mecninism
     void                 *arg;
     isn_clock_counter_t   time;
+    void                 *pooled;       ///< Argument slot, released when the tasklet and its caller complete
+    uint16_t              gen;          ///< Generation, incremented when freed, to invalidate the handles
 } isn_tasklet_entry_t;
 
 typedef struct isn_tasklet_queue {
@@ -223,40 +244,79 @@ int isn_reactor_channel_call_at(isn_tasklet_queue_t *queue, const isn_reactor_ta
     isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
     void* arg, isn_clock_counter_t timed);
 
+/** Post a timed event to a channel with a copy of the data as its argument, see \ref GR_ISN_ArgPool
+ * \returns 0 on success, -1 if channel is full, or no slot is available in the pool set by isn_reactor_setargpool()
+ */
+int isn_reactor_channel_call_copy_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+    isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+    const void *data, size_t size, isn_clock_counter_t timed);
+
 static inline void isn_reactor_wakeup_channel(isn_tasklet_queue_t *queue) {
     if (queue->rdi != queue->wri && queue->wakeup) queue->wakeup(); 
 }
 
-/* Processor Local */
+/* Processor Local
+ *
+ * Queuing returns a handle, which carries the queue index and the generation
+ * of the entry. Entries are reused, and the handle of a tasklet which has
+ * completed or was dropped remains invalid even when its entry is taken
+ * by another tasklet, so a handle may be kept and checked at any time.
+ *
+ * The generation wraps, on the MCU after 65536 and on POSIX, where the index
+ * takes 20 bits, after 2048 reuses of the same entry, at which point a stale
+ * handle would alias a new tasklet. Freed entries are reused in FIFO order,
+ * so this requires as many tasklets queued while the handle is kept.
+ */
 
 /** Queue a timed tasklet and follow-up with return or call to another function
- * \returns index in the queue >=0 on success, -1 if queue is full
+ * \returns handle >=0 on success, -1 if queue is full
  */
 int isn_reactor_call_at(const isn_reactor_tasklet_t tasklet,
     const isn_reactor_tasklet_t caller, void* arg, isn_clock_counter_t timed);
 
 /** Queue a tasklet and follow-up with return or call to another function
- * \returns index in the queue >=0 on success, -1 if queue is full
+ * \returns handle >=0 on success, -1 if queue is full
  */
 static inline int isn_reactor_call(const isn_reactor_tasklet_t tasklet,
     const isn_reactor_tasklet_t caller, void* arg) {
     return isn_reactor_call_at(tasklet, caller, arg, ISN_CLOCK_NOW);
 }
 
+/** Set the pool for the arguments of the isn_reactor_call_copy_at(), and isn_reactor_channel_call_copy_at() */
+void isn_reactor_setargpool(isn_argpool_t *pool);
+
+/** Queue a timed tasklet with a copy of the data as its argument
+ *
+ * The copy is placed in a slot of the pool set by isn_reactor_setargpool(), which
+ * is released once the tasklet and its caller complete, or when the tasklet is dropped.
+ *
+ * \returns handle >=0 on success, -1 if queue is full or no slot is available
+ */
+int isn_reactor_call_copy_at(const isn_reactor_tasklet_t tasklet,
+    const isn_reactor_tasklet_t caller, const void *data, size_t size, isn_clock_counter_t timed);
+
+/** Queue a tasklet with a copy of the data as its argument
+ * \returns handle >=0 on success, -1 if queue is full or no slot is available
+ */
+static inline int isn_reactor_queue_copy(const isn_reactor_tasklet_t tasklet, const void *data, size_t size) {
+    return isn_reactor_call_copy_at(tasklet, NULL, data, size, ISN_CLOCK_NOW);
+}
+
 /** Queues an event and passes further its callee.
- *  This function must be called from an event.
+ *  This function must be called from an event. If arg is the pooled argument
+ *  of the calling event, it is passed further as well.
  */
 int isn_reactor_pass(const isn_reactor_tasklet_t tasklet, void* arg);
 
 /** Queue an tasklet
- * \returns index in the queue >=0 on success, -1 if queue is full
+ * \returns handle >=0 on success, -1 if queue is full
  */
 static inline int isn_reactor_queue(const isn_reactor_tasklet_t tasklet, void* arg) {
     return isn_reactor_call_at(tasklet, NULL, arg, ISN_CLOCK_NOW);
 }
 
 /** Queue a timed tasklet
- * \returns index in the queue >=0 on success, -1 if queue is full
+ * \returns handle >=0 on success, -1 if queue is full
  */
 static inline int isn_reactor_queue_at(const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed) {
     return isn_reactor_call_at(tasklet, NULL, arg, timed);
@@ -298,7 +358,7 @@ int isn_reactor_mutex_is_locked(isn_reactor_mutex_t mutex_bits);
 
 /** Is tasklet still pending in the queue, given by exact specs to ensure full integrity
  *
- * \param index returned by any of the above queuing methods, one may also pass invalid index
+ * \param index handle returned by any of the above queuing methods, one may also pass invalid handle
  * \param tasklet the tasklet, used in validation
  * \param arg used in validation
  * \returns 0 if no-longer in queue or invalid index, and 1 is valid and in the queue
@@ -310,18 +370,46 @@ int isn_reactor_isvalid(int index, const isn_reactor_tasklet_t tasklet, const vo
  */
 int isn_reactor_change_timed(int index, const isn_reactor_tasklet_t tasklet, const void* arg, isn_clock_counter_t newtime);
 
+/** Is tasklet still pending in the queue, in O(1) by the generation of the handle only
+ *
+ * \param handle returned by any of the above queuing methods, or -1
+ * \returns 0 if no-longer in queue or invalid handle, and 1 is valid and in the queue
+ */
+int isn_reactor_valid(int handle);
+
+/** Modify timed tasklet in O(1), i.e. to prolong a timeout on each received byte
+ * \returns 0 if no-longer in queue or invalid handle, and 1 when modified successfully
+ */
+int isn_reactor_retime(int handle, isn_clock_counter_t newtime);
+
+/** Drop the tasklet in O(1), neither tasklet nor its caller are executed
+ * \returns 0 if no-longer in queue, invalid handle or the active tasklet, and 1 when dropped
+ */
+int isn_reactor_cancel(int handle);
+
 /** Modify time for reoccuring (self-triggered) event, from the event.
  *  So the function modifies the time of the active event and only has effect
  *  if event returns with a pointer to itself.
  */
 int isn_reactor_change_timed_self(isn_clock_counter_t newtime);
 
+/** Modify mutex bits of the active event, from the event.
+ *  If event returns with a pointer to itself, it is not executed again until
+ *  given mutex is unlocked; 0 removes the mutex. See \ref GR_ISN_Coro.
+ */
+int isn_reactor_change_mutex_self(isn_reactor_mutex_t mutex_bits);
+
+/** \returns handle of the active event, to be used with isn_reactor_retime()
+ *    from other events or interrupts, or -1 when called outside the event
+ */
+int isn_reactor_self(void);
+
 /** Drop specific tasklet
  * \returns 0 if no-longer in queue or invalid index, and 1 when modified successfully
  */
 int isn_reactor_drop(int index, const isn_reactor_tasklet_t tasklet, const void* arg);
 
-/** Drop tasklets from queue of given tasklet and arg
+/** Drop tasklets from queue of given tasklet and arg, except the active one
  *  \returns number of removed tasklets
  */
 int isn_reactor_dropall(const isn_reactor_tasklet_t tasklet, const void* arg);
@@ -358,13 +446,23 @@ isn_clock_counter_t isn_reactor_run(void);
 /** Executes all tasklets from foreign queues (channels), NULL terminated, followed by local pending tasklets */
 isn_clock_counter_t isn_reactor_runall(isn_tasklet_queue_t *queue, ...);
 
+/** Message handler returning the isn_reactor_stats_t, writing to it resets the max counters */
+void *isn_reactor_stats_cb(const void *arg);
+
 /** Self-test, performs basic and mutex queues check
  *  Side effect, it uses one mutex and does not free it.
  * \returns 0 on success, or negative value showing progress
  */
 int isn_reactor_selftest();
 
-/** Initialize reactor and provide queue buffer */
+/** Initialize reactor and provide queue buffer
+ *
+ * On hosts, see src/posix, the buffer is not used and may be NULL. Entries are
+ * allocated in chunks of queue_size, or CONFIG_ISN_REACTOR_CHUNK if 0, and
+ * another chunk is added whenever the queue is full, so queuing only fails
+ * when out of memory, or beyond 1M (2^20) pending tasklets, as the handle
+ * keeps the remaining 11 bits for the generation.
+ */
 void isn_reactor_init(isn_tasklet_entry_t *tasklet_queue, size_t queue_size);
 
 #endif
@@ -0,0 +1,136 @@
+/** \file
+ *  \brief ISN Zero-Copy Circular Buffer
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_ring.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Ring Zero-Copy Circular Buffer
+ *
+ * # Scope
+ *
+ * Single producer, single consumer circular buffer of any size, which
+ * provides linear, non-wrapped segments to both sides, so drivers may
+ * return it directly from the getsendbuf() and forward received data with
+ * the recv() without copying. Either side may run in an interrupt.
+ *
+ * # Concept
+ *
+ * The producer reserves a linear segment with isn_ring_reserve(), which
+ * finds the largest free space either at the end or at the beginning of
+ * the buffer, fills it and publishes it with isn_ring_commit(). When the
+ * segment was placed at the beginning, the unused tail is cut off by
+ * moving the dynamic wrap point, at which the consumer wraps to the start.
+ * Reservation may be repeated any number of times before commit, and is
+ * implicitly canceled by the next one.
+ *
+ * The consumer obtains the next linear segment with isn_ring_peek() and
+ * releases the processed part with isn_ring_consume(). Wrapped content is
+ * thus received in at most two pieces:
+ * ~~~
+ * const void *src;
+ * size_t size;
+ * while ((size = isn_ring_peek(&rx, &src)) > 0) {
+ *     size_t fw = child->recv(child, src, size, obj);
+ *     isn_ring_consume(&rx, fw);
+ *     if (fw != size) break;
+ * }
+ * ~~~
+ * The isn_ring_putbyte() and isn_ring_getbyte() serve byte oriented
+ * interrupt routines.
+ *
+ * One byte of the buffer always remains unused to distinguish the full
+ * from an empty buffer. When ring is empty, the largest segment is about
+ * half of the buffer or more.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_RING_H__
+#define __ISN_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+
+    volatile uint32_t wri;      ///< Write index, owned by the producer, never incremented up to the rdi
+    volatile uint32_t rdi;      ///< Read index, owned by the consumer, when equal to wri buffer is empty
+    volatile uint32_t wrw;      ///< Dynamic wrap point, at which the consumer wraps to the start
+
+    uint32_t alloc_wri;         ///< Reserved segment, not yet published
+    uint32_t alloc_wrw;
+    uint32_t alloc_size;
+}
+isn_ring_t;
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Initialize Ring Buffer
+ *
+ * \param obj
+ * \param buf memory of the buffer
+ * \param size of the buffer, at least 2 bytes
+ */
+void isn_ring_init(isn_ring_t *obj, void *buf, size_t size);
+
+/** Empty the buffer, may only be called when neither side is active */
+void isn_ring_reset(isn_ring_t *obj);
+
+/** Reserve a linear segment, producer side
+ *
+ * \param obj
+ * \param dest receives pointer to the segment, may be NULL just to query the available size
+ * \param size desired size
+ * \returns desired or limited (max) size in the case desired size is too big, or 0 if full
+ */
+size_t isn_ring_reserve(isn_ring_t *obj, void **dest, size_t size);
+
+/** Publish the first size bytes of the last reserved segment to the consumer */
+void isn_ring_commit(isn_ring_t *obj, size_t size);
+
+/** Get the next linear segment, consumer side
+ *
+ * \param obj
+ * \param src receives pointer to the segment
+ * \returns size of the segment, or 0 if buffer is empty
+ */
+size_t isn_ring_peek(isn_ring_t *obj, const void **src);
+
+/** Release size bytes of the segment returned by isn_ring_peek() */
+void isn_ring_consume(isn_ring_t *obj, size_t size);
+
+/** \returns number of bytes available to the consumer */
+size_t isn_ring_used(const isn_ring_t *obj);
+
+/** Store a single byte, to be used by the producer running in an interrupt
+ *
+ * \returns 0 on success, or -1 if buffer is full and byte was dropped
+ */
+int isn_ring_putbyte(isn_ring_t *obj, uint8_t b);
+
+/** \returns next byte or -1 if buffer is empty */
+int isn_ring_getbyte(isn_ring_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
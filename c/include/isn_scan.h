@@ -0,0 +1,134 @@
+/** \file
+ *  \brief ISN Frame Header Scanning
+ *  \author Uros Platise <uros@isotel.org>
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Scan Frame Header Scanning
+ *
+ * # Scope
+ *
+ * Finds the next candidate frame header in the out-of-frame data, i.e. a
+ * terminal text or padding mixed with the frames, many bytes at a time, so
+ * the frame decoders forward such runs to their other layer in a single call.
+ *
+ * # Concept
+ *
+ * Uses 32 or 16 byte vectors when compiled with AVX2 or SSE2, which is the
+ * default on x86-64 hosts, and otherwise a word at a time, 8 bytes on 64-bit
+ * and 4 bytes on 32-bit MCUs, with the bit tricks, so without any branch per
+ * byte. The tail is checked byte by byte. The scans are exact, so a returned
+ * position always holds a header byte.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_SCAN_H__
+#define __ISN_SCAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \cond Implementation */
+
+typedef uintptr_t isn_scan_word_t;
+
+#define ISN_SCAN_REP(b)     ((isn_scan_word_t)-1 / 0xFF * (b))
+
+/** High bit set in each zero byte of x */
+static inline isn_scan_word_t isn_scan_zero_bytes(isn_scan_word_t x) {
+    return ~(((x & ISN_SCAN_REP(0x7F)) + ISN_SCAN_REP(0x7F)) | x | ISN_SCAN_REP(0x7F));
+}
+
+static inline isn_scan_word_t isn_scan_load(const uint8_t *buf) {
+    isn_scan_word_t w;
+    memcpy(&w, buf, sizeof(w));
+    return w;
+}
+
+/** \endcond */
+
+/** Find the short and compact frame header, a byte above 0x80
+ *
+ * \returns index of the first header byte, or size if none
+ */
+static inline size_t isn_scan_frame(const uint8_t *buf, size_t size) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i min32 = _mm256_set1_epi8((char)0x80);
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+        uint32_t m = (uint32_t)_mm256_movemask_epi8(v) & (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, min32));
+        if (m) return i + __builtin_ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i min16 = _mm_set1_epi8((char)0x80);
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        uint32_t m = (uint32_t)_mm_movemask_epi8(v) & (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(v, min16));
+        if (m) return i + __builtin_ctz(m);
+    }
+#endif
+    for (; i + sizeof(isn_scan_word_t) <= size; i += sizeof(isn_scan_word_t)) {
+        isn_scan_word_t w = isn_scan_load(buf + i);
+        // high bit set, and any of the lower 7 bits
+        if (w & (((w & ISN_SCAN_REP(0x7F)) + ISN_SCAN_REP(0x7F)) & ISN_SCAN_REP(0x80))) break;
+    }
+    for (; i < size && buf[i] <= 0x80; i++);
+    return i;
+}
+
+/** Find the header of the given type, i.e. the long or jumbo frame
+ *
+ * \param buf
+ * \param size
+ * \param mask of the header bits, as ISN_PROTO_FRAME_LONG_MASK
+ * \param value of the header bits, as ISN_PROTO_FRAME_LONG
+ * \returns index of the first byte for which (byte & mask) == value, or size if none
+ */
+static inline size_t isn_scan_masked(const uint8_t *buf, size_t size, uint8_t mask, uint8_t value) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask32 = _mm256_set1_epi8((char)mask), value32 = _mm256_set1_epi8((char)value);
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+        uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(v, mask32), value32));
+        if (m) return i + __builtin_ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i mask16 = _mm_set1_epi8((char)mask), value16 = _mm_set1_epi8((char)value);
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+        uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, mask16), value16));
+        if (m) return i + __builtin_ctz(m);
+    }
+#endif
+    for (; i + sizeof(isn_scan_word_t) <= size; i += sizeof(isn_scan_word_t)) {
+        isn_scan_word_t w = (isn_scan_load(buf + i) & ISN_SCAN_REP(mask)) ^ ISN_SCAN_REP(value);
+        if (isn_scan_zero_bytes(w)) break;
+    }
+    for (; i < size && (buf[i] & mask) != value; i++);
+    return i;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,139 @@
+/** \file
+ *  \brief ISN Compile-time Composed Protocol Stacks
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_static.hpp
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Static Compile-time Composed Stacks
+ *
+ * # Scope
+ *
+ * Layers call their parents and children thru the function pointers of the
+ * isn_driver_t, which allows the stack to be wired at run-time. On MCUs the
+ * stack is typically fixed, i.e. UART -> FRAME -> DISPATCH -> MSG, and these
+ * indirect calls may be replaced by direct, inlinable calls at compile time.
+ *
+ * # Concept
+ *
+ * Each layer calls its neighbours thru the macros named as
+ * `ISN_<LAYER>_<PARENT|CHILD|OTHER>_<METHOD>`, which default to the
+ * run-time wired `ISN_DYNAMIC_<METHOD>` given below. These are provided by the
+ * frame, long and jumbo frame, user, message, transport, dup and redirect layers,
+ * the latter calling its `TARGET`. The \ref GR_ISN_Dispatch
+ * in addition accepts an X-macro list of static bindings in the
+ * `ISN_DISPATCH_STATIC_BINDINGS`, matched by a switch before the run-time table.
+ *
+ * A fixed stack is then built as a single translation unit, which overrides
+ * the macros and includes the layer sources, so the compiler sees all the
+ * methods. These are forward declared here for each layer of the stack, as
+ * selected by its `ISN_STATIC_<LAYER>`, i.e. FRAME, FRAME_LONG, FRAME_JUMBO,
+ * DISPATCH, USER, TRANS, REDIRECT, DUP and MSG:
+ * ~~~
+ * // isn_stack.c
+ * #define ISN_FRAME_CHILD_RECV(l, src, size, caller)  isn_dispatch_recv(l, src, size, caller)
+ * #define ISN_MSG_PARENT_GETSENDBUF(l, d, size, c)    isn_frame_getsendbuf(l, d, size, c)
+ * #define ISN_MSG_PARENT_SEND(l, d, size)             isn_frame_send(l, d, size)
+ * #define ISN_MSG_PARENT_FREE(l, ptr)                 isn_frame_free(l, ptr)
+ * #define ISN_DISPATCH_STATIC_BINDINGS(X) \
+ *     X(ISN_PROTO_MSG, isn_message_recv, &isn_message)
+ *
+ * #define ISN_STATIC_FRAME
+ * #define ISN_STATIC_DISPATCH
+ * #define ISN_STATIC_MSG
+ * #include "isn_static.h"
+ * #include "isn_frame.c"
+ * #include "isn_dispatch.c"
+ * #include "isn_msg.c"
+ * ~~~
+ * and the layers are initialized as usual, the run-time wired API stays fully
+ * functional, and may be mixed with the static one. It is users responsibility
+ * that the objects passed to the init functions match the static configuration.
+ *
+ * On C++ hosts see the isn_static.hpp templates.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_STATIC_H__
+#define __ISN_STATIC_H__
+
+#include "isn_def.h"
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+/** Run-time wired calls, used by default */
+#define ISN_DYNAMIC_RECV(layer, src, size, caller)          ((isn_receiver_t *)(layer))->recv(layer, src, size, caller)
+#define ISN_DYNAMIC_GETSENDBUF(layer, dest, size, caller)   ((isn_driver_t *)(layer))->getsendbuf(layer, dest, size, caller)
+#define ISN_DYNAMIC_SEND(layer, dest, size)                 ((isn_driver_t *)(layer))->send(layer, dest, size)
+#define ISN_DYNAMIC_FREE(layer, ptr)                        ((isn_driver_t *)(layer))->free(layer, ptr)
+
+/*--------------------------------------------------------------------*/
+/* LAYER METHODS, for single translation unit builds                  */
+/*--------------------------------------------------------------------*/
+
+#ifndef __cplusplus
+
+#define ISN_STATIC_METHOD   static
+
+#ifdef ISN_STATIC_FRAME
+ISN_STATIC_METHOD size_t isn_frame_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_send(isn_layer_t *drv, void *dest, size_t size);
+ISN_STATIC_METHOD void isn_frame_free(isn_layer_t *drv, const void *ptr);
+#endif
+
+#ifdef ISN_STATIC_FRAME_LONG
+ISN_STATIC_METHOD size_t isn_frame_long_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_long_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_long_send(isn_layer_t *drv, void *dest, size_t size);
+ISN_STATIC_METHOD void isn_frame_long_free(isn_layer_t *drv, const void *ptr);
+#endif
+
+#ifdef ISN_STATIC_FRAME_JUMBO
+ISN_STATIC_METHOD size_t isn_frame_jumbo_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_jumbo_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_frame_jumbo_send(isn_layer_t *drv, void *dest, size_t size);
+ISN_STATIC_METHOD void isn_frame_jumbo_free(isn_layer_t *drv, const void *ptr);
+#endif
+
+#ifdef ISN_STATIC_DISPATCH
+ISN_STATIC_METHOD size_t isn_dispatch_recv(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller);
+#endif
+
+#ifdef ISN_STATIC_USER
+ISN_STATIC_METHOD size_t isn_user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_user_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_user_send(isn_layer_t *drv, void *dest, size_t size);
+ISN_STATIC_METHOD void isn_user_free(isn_layer_t *drv, const void *ptr);
+#endif
+
+#ifdef ISN_STATIC_TRANS
+ISN_STATIC_METHOD size_t isn_trans_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_trans_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller);
+ISN_STATIC_METHOD int isn_trans_send(isn_layer_t *drv, void *dest, size_t size);
+ISN_STATIC_METHOD void isn_trans_free(isn_layer_t *drv, const void *ptr);
+#endif
+
+#ifdef ISN_STATIC_REDIRECT
+ISN_STATIC_METHOD size_t isn_redirect_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+#endif
+
+#ifdef ISN_STATIC_DUP
+ISN_STATIC_METHOD size_t isn_dup_recv(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller);
+#endif
+
+#ifdef ISN_STATIC_MSG
+ISN_STATIC_METHOD size_t isn_message_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+/** \file
+ *  \brief ISN Compile-time Composed Protocol Stacks for C++ Hosts
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_static.h
+ */
+/**
+ * \ingroup GR_ISN_Static
+ *
+ * # C++ Templates
+ *
+ * Provides the dispatcher with the bindings given as template arguments, so
+ * the protocol match is resolved by the compiler and the children receive
+ * methods are called directly. The object is layout compatible with the
+ * isn_receiver_t and may be placed anywhere in the run-time wired stack:
+ * ~~~
+ * static size_t userstream_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+ *
+ * isn::Dispatch<
+ *     isn::Bind<ISN_PROTO_USER1, userstream_recv>,
+ *     isn::Bind<ISN_PROTO_USER2, userstream_recv, &stream2>,
+ *     isn::Bind<ISN_PROTO_PING,  ping_recv>
+ * > dispatch;
+ *
+ * isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &dispatch, NULL, phy, ISN_CLOCK_ms(100));
+ * ~~~
+ * Requires C++17.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_STATIC_HPP__
+#define __ISN_STATIC_HPP__
+
+#include "isn_dispatch.h"
+#include "isn_static.h"
+
+namespace isn {
+
+typedef size_t (*recv_fn_t)(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+
+/** Binds the protocol to the receive method and its layer object, or NULL */
+template <int Protocol, recv_fn_t Recv, auto Layer = nullptr>
+struct Bind {
+    static constexpr int protocol = Protocol;
+
+    static size_t recv(const void *src, size_t size, isn_layer_t *caller) {
+        return Recv(Layer, src, size, caller);
+    }
+};
+
+/** Dispatcher with the compile-time bindings, ISN_PROTO_OTHER may be given as the last one */
+template <typename... Bindings>
+struct Dispatch {
+    isn_receiver_t drv = {Dispatch::recv, nullptr};
+
+    static size_t recv(isn_layer_t *, const void *src, size_t size, isn_layer_t *caller) {
+        if (!src || !size) return size;
+        const int protocol = isn_dispatch_protocol(src);
+        size_t retval = size;   // Ack all but account dropped packet
+        (void)((match<Bindings>(protocol, src, size, caller, retval)) || ...);
+        return retval;
+    }
+
+private:
+    template <typename B>
+    static bool match(int protocol, const void *src, size_t size, isn_layer_t *caller, size_t &retval) {
+        if (B::protocol != protocol && B::protocol != ISN_PROTO_OTHER) return false;
+        retval = B::recv(src, size, caller);
+        return true;
+    }
+};
+
+} // namespace isn
+
+#endif
@@ -0,0 +1,148 @@
+/** \file
+ *  \brief ISN Sample Streaming Layer
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_stream.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Stream Sample Streaming Layer
+ *
+ * # Scope
+ *
+ * Streams blocks of samples, i.e. of an ADC or a waveform, typically on top
+ * of the \ref GR_ISN_User. Each block carries a sequence number and a device
+ * timestamp in a 6-byte header, so the receiver detects lost blocks and
+ * aligns them in time, without any per-sample overhead.
+ *
+ * # Concept
+ *
+ * Transmitter owns a number of blocks in the caller provided memory, two for
+ * double or three for triple buffering. Producer, i.e. an ADC interrupt or
+ * DMA completion, obtains the next free block with isn_stream_getblock(),
+ * fills the samples and publishes it with isn_stream_commit(). The main loop
+ * sends the committed blocks with the isn_stream_flush(). When no block is
+ * free the data is lost, but its sequence number is consumed, so the loss is
+ * visible at the receiver:
+ * ~~~
+ * static uint8_t blocks[ISN_STREAM_BUF_SIZE(128, 3)];
+ * isn_user_init(&isn_user, NULL, &isn_frame, ISN_PROTO_USER1);
+ * isn_stream_init(&isn_stream, &isn_user, blocks, 128, 3, NULL);
+ *
+ * void adc_isr(void) {
+ *     uint16_t *samples = isn_stream_getblock(&isn_stream);
+ *     if (samples) {
+ *         read_samples(samples, 64);
+ *         isn_stream_commit(&isn_stream, isn_clock_now());
+ *     }
+ * }
+ *
+ * while (1) isn_stream_flush(&isn_stream);
+ * ~~~
+ *
+ * Receiver writes the samples of each received block directly into the
+ * caller provided \ref GR_ISN_Ring, from which the application consumes
+ * them with isn_ring_peek() and isn_ring_consume(). A block is accepted
+ * completely or not at all, in which case recv() returns 0 to request a
+ * retry. The number of missing blocks is counted in the gaps, and duplicate or
+ * older blocks are dropped, counted in the rx_dropped.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_STREAM_H__
+#define __ISN_STREAM_H__
+
+#include "isn_def.h"
+#include "isn_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+/** Block header, preceding the samples */
+typedef struct {
+    uint16_t seq;           ///< Sequence number, incremented per block
+    uint32_t timestamp;     ///< Device time of the block, i.e. of its first sample
+}
+__attribute__((packed)) isn_stream_header_t;
+
+/** Size of the transmitter's memory for nblocks of block_size bytes of samples */
+#define ISN_STREAM_BUF_SIZE(block_size, nblocks)    ((nblocks) * (sizeof(isn_stream_header_t) + (block_size)))
+
+typedef struct {
+    /* ISN Abstract Class Driver */
+    isn_driver_t drv;
+
+    /* Private data */
+    isn_driver_t* parent;
+
+    uint8_t *blocks;                ///< Transmitter blocks, each with the header followed by samples
+    uint16_t block_size;            ///< Bytes of samples per block
+    uint8_t nblocks;
+    volatile uint8_t wri;           ///< Index of the next block to fill, wraps at 2 * nblocks, owned by the producer
+    volatile uint8_t rdi;           ///< Index of the next block to send, wraps at 2 * nblocks
+    uint16_t tx_seq;
+
+    isn_ring_t *ring;               ///< Receiver's sample buffer
+    uint16_t rx_seq;                ///< Expected sequence number
+    uint8_t rx_synced;              ///< Set after the first block, to which the sequence is synced
+    uint32_t rx_timestamp;          ///< Timestamp of the last received block
+    uint32_t gaps;                  ///< Number of blocks missed by the receiver
+}
+isn_stream_t;
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+isn_stream_t* isn_stream_create();
+
+void isn_stream_drop(isn_stream_t *obj);
+
+/** Streaming Layer
+ *
+ * \param obj
+ * \param parent protocol layer, typically the isn_user_t, may be NULL for receive only
+ * \param blocks transmitter memory of ISN_STREAM_BUF_SIZE(block_size, nblocks) bytes, or NULL for receive only
+ * \param block_size bytes of samples per block
+ * \param nblocks number of blocks, 2 for double and 3 for triple buffering, up to 128
+ * \param ring receiver's sample buffer, or NULL for transmit only
+ */
+void isn_stream_init(isn_stream_t *obj, isn_layer_t* parent, void *blocks, uint16_t block_size, uint8_t nblocks, isn_ring_t *ring);
+
+/** Get the block to be filled, producer side
+ *
+ * Returns the same block until it is committed. If no block is free, the
+ * data of this block period is lost and counted as tx_dropped.
+ *
+ * \returns pointer to block_size bytes of samples, or NULL if all blocks are pending
+ */
+void *isn_stream_getblock(isn_stream_t *obj);
+
+/** Publish the filled block to the isn_stream_flush()
+ *
+ * \param obj
+ * \param timestamp device time of the block
+ */
+void isn_stream_commit(isn_stream_t *obj, uint32_t timestamp);
+
+/** Send committed blocks to the parent
+ *
+ * \returns number of blocks still pending, as parent had no buffer available
+ */
+int isn_stream_flush(isn_stream_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
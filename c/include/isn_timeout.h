@@ -0,0 +1,116 @@
+/** \file
+ *  \brief ISN Adaptive Frame Timeout
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_timeout.c
+ */
+/**
+ * \ingroup GR_ISN
+ * \defgroup GR_ISN_Timeout Adaptive Frame Timeout
+ *
+ * # Scope
+ *
+ * Learns the frame timeout from the gaps within the frames. A fixed timeout
+ * set too long blocks the link after a corrupted partial frame until it
+ * expires. One set too short drops the frames that slow USB-serial adapters
+ * split into several chunks.
+ *
+ * # Concept
+ *
+ * The frame layer samples the time between two successive recv() while
+ * a frame is in progress into a log2 histogram, also when the gap exceeds
+ * the timeout and the frame is dropped, so the timeout rises again when the
+ * link slows down. Gaps above the max are sampled as the max. The timeout is set to twice
+ * the upper bound of the gap at ISN_TIMEOUT_PERCENTILE, so rare stalls, as a
+ * link broken in the middle of a frame, do not raise it. The timeout is
+ * limited by the min and max.
+ *
+ * The min is given by the PHY: a few character times for a UART at the
+ * known baud rate, see ISN_TIMEOUT_UART(), and the 1 ms frame period on USB.
+ * The max is the initial timeout, used until enough gaps are collected.
+ * Older samples are halved periodically, so the timeout follows the link.
+ * ~~~
+ * static isn_timeout_t frame_timeout;
+ * isn_frame_init(&isn_frame, ISN_FRAME_MODE_COMPACT, &isn_dispatch, NULL, &isn_uart, ISN_CLOCK_ms(100));
+ * isn_timeout_init(&frame_timeout, ISN_TIMEOUT_UART(115200), ISN_CLOCK_ms(100));
+ * isn_frame_setadaptive(&isn_frame, &frame_timeout);
+ * ...
+ * printf("learned timeout %lu\n", isn_timeout_get(&frame_timeout));
+ * ~~~
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef __ISN_TIMEOUT_H__
+#define __ISN_TIMEOUT_H__
+
+#include "isn_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*--------------------------------------------------------------------*/
+/* DEFINITIONS                                                        */
+/*--------------------------------------------------------------------*/
+
+#ifndef ISN_TIMEOUT_PERCENTILE
+# define ISN_TIMEOUT_PERCENTILE     99      ///< Percentile of the gaps covered by the timeout
+#endif
+
+#ifndef ISN_TIMEOUT_WARMUP
+# define ISN_TIMEOUT_WARMUP         32      ///< Samples before the timeout is learned
+#endif
+
+#ifndef ISN_TIMEOUT_DECAY
+# define ISN_TIMEOUT_DECAY          1024    ///< Samples after which the histogram is halved
+#endif
+
+#define ISN_TIMEOUT_BUCKETS         32
+
+/** Minimum timeout for a UART of the given baud rate, the time of 8 characters */
+#define ISN_TIMEOUT_UART(baud)      (ISN_CLOCK_us(8 * 10 * 1000000L / (baud)) + 1)
+
+/** Minimum timeout for USB PHYs, which pass the data in 1 ms frames */
+#define ISN_TIMEOUT_USB             ISN_CLOCK_ms(2)
+
+typedef struct {
+    uint16_t hist[ISN_TIMEOUT_BUCKETS];     ///< Count of gaps in [2^(i-1), 2^i) ticks
+    uint16_t total;
+    isn_clock_counter_t min;
+    isn_clock_counter_t max;
+    isn_clock_counter_t timeout;            ///< Learned timeout
+    uint32_t samples;                       ///< All samples, also of the decayed ones
+}
+isn_timeout_t;
+
+/*----------------------------------------------------------------------*/
+/* Public functions                                                     */
+/*----------------------------------------------------------------------*/
+
+/** Adaptive timeout
+ *
+ * \param obj
+ * \param min timeout, as given by the PHY, i.e. ISN_TIMEOUT_UART() or ISN_TIMEOUT_USB
+ * \param max timeout, which is also used until ISN_TIMEOUT_WARMUP gaps are sampled
+ */
+void isn_timeout_init(isn_timeout_t *obj, isn_clock_counter_t min, isn_clock_counter_t max);
+
+/** Add the gap within a frame, limited to the max
+ *
+ * \returns the updated timeout
+ */
+isn_clock_counter_t isn_timeout_sample(isn_timeout_t *obj, isn_clock_counter_t gap);
+
+/** \returns the learned timeout */
+static inline isn_clock_counter_t isn_timeout_get(const isn_timeout_t *obj) { return obj->timeout; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+/** \file
+ *  \brief ISN Traffic Capture and Replay
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_capture.c
+ */
+/**
+ * \ingroup GR_ISN_POSIX
+ * \defgroup GR_ISN_CAPTURE ISN POSIX Traffic Capture and Replay
+ *
+ * # Scope
+ *
+ * Records the traffic passing any point of a stack into a pcap file, and
+ * feeds it back into a stack, so the field traffic may be reproduced
+ * offline, as a benchmark or as a regression test.
+ *
+ * # Concept
+ *
+ * The capture layer is transparent and is inserted between any two layers.
+ * Each accepted recv() and each send() payload is written as one pcap record
+ * with a nanosecond timestamp, of the link type LINKTYPE_USER0, prefixed by
+ * a direction byte, ISN_CAPTURE_RX or ISN_CAPTURE_TX:
+ * ~~~
+ * isn_capture_t *cap = isn_capture_create("field.pcap", &isn_frame, NULL);
+ * isn_serial_driver_t *serial = isn_serial_driver_create(port, NULL, cap);
+ * isn_capture_setparent(cap, serial);
+ * isn_frame_init(&isn_frame, ISN_FRAME_MODE_COMPACT, &isn_msg, NULL, cap, ISN_CLOCK_ms(100));
+ * ~~~
+ *
+ * The replay PHY takes the place of the parent layer of the capture point.
+ * It delivers the received records to its child, at the original pace, at
+ * N times the speed, or as fast as possible, and compares what the stack
+ * sends back with the transmitted records:
+ * ~~~
+ * isn_replay_t *rep = isn_replay_create("field.pcap", &isn_frame);
+ * isn_frame_init(&isn_frame, ISN_FRAME_MODE_COMPACT, &isn_msg, NULL, rep, ISN_CLOCK_ms(100));
+ * isn_replay_setspeed(rep, 0);
+ * while (isn_replay_poll(rep) > 0) isn_msg_sched(&isn_msg);
+ * printf("%u mismatches\n", isn_replay_mismatches(rep));
+ * ~~~
+ * The files may also be inspected with Wireshark or tcpdump.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef ISN_CAPTURE_H
+#define ISN_CAPTURE_H
+
+#include "isn_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ISN_CAPTURE_RX          0       ///< Direction of a record received by the capture point
+#define ISN_CAPTURE_TX          1       ///< Direction of a record sent by the capture point
+#define ISN_CAPTURE_LINKTYPE    147     ///< LINKTYPE_USER0
+#define ISN_CAPTURE_SNAPLEN     65536
+
+typedef struct isn_capture_s isn_capture_t;
+typedef struct isn_replay_s isn_replay_t;
+
+/** Create a capture layer and the file
+ *
+ * \param filename of the pcap file, truncated if exists
+ * \param child layer, which receives from the capture point
+ * \param parent layer, to which the capture point sends, may be set later with isn_capture_setparent()
+ * \returns capture layer or NULL if file cannot be created
+ */
+isn_capture_t *isn_capture_create(const char *filename, isn_layer_t *child, isn_layer_t *parent);
+
+/** Set the parent, i.e. a PHY, which requires the capture layer as its child when created */
+void isn_capture_setparent(isn_capture_t *obj, isn_layer_t *parent);
+
+/** Flush and close the file */
+void isn_capture_drop(isn_capture_t *obj);
+
+/** Flush the records written so far to the file */
+void isn_capture_flush(isn_capture_t *obj);
+
+/** \returns number of records written */
+uint32_t isn_capture_records(const isn_capture_t *obj);
+
+/** Load a capture and create the replay PHY
+ *
+ * \param filename of the pcap file written by the capture layer
+ * \param child layer, receiving the RX records
+ * \returns replay PHY or NULL if file cannot be read or is not an ISN capture
+ */
+isn_replay_t *isn_replay_create(const char *filename, isn_layer_t *child);
+
+void isn_replay_drop(isn_replay_t *obj);
+
+/** Set the pace
+ *
+ * \param obj
+ * \param speed 1.0 for the original pace, N for N times faster, 0 as fast as possible (default)
+ */
+void isn_replay_setspeed(isn_replay_t *obj, double speed);
+
+/** Deliver the RX records, which are due
+ *
+ * With the speed 0 it delivers the next record, otherwise it sleeps until
+ * the next record is due. A record, which the child did not accept, is
+ * retried on the next call.
+ *
+ * \returns number of records still to be delivered, 0 at the end
+ */
+int isn_replay_poll(isn_replay_t *obj);
+
+/** Start from the beginning and reset the statistics */
+void isn_replay_rewind(isn_replay_t *obj);
+
+/** \returns number of sent packets that differ from the TX records, or are not recorded at all */
+uint32_t isn_replay_mismatches(const isn_replay_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
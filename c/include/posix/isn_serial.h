@@ -103,6 +103,11 @@ void isn_serial_driver_setlogging(isn_logger_level_t level);
 
 isn_driver_stats_t* isn_serial_driver_get_stats(isn_serial_driver_t* driver);
 
+#ifndef _WIN32
+/** \returns file descriptor of the port, to wait for input in an event loop and then call isn_serial_driver_poll() with timeout 0 */
+int isn_serial_driver_getfd(isn_serial_driver_t* driver);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
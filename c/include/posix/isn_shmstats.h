@@ -0,0 +1,129 @@
+/** \file
+ *  \brief ISN Shared Memory Statistics Page
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_shmstats.c
+ */
+/**
+ * \ingroup GR_ISN_POSIX
+ * \defgroup GR_ISN_SHMSTATS ISN POSIX Shared Memory Statistics
+ *
+ * # Scope
+ *
+ * Publishes statistics of all registered layers, together with their names
+ * and topology, in a versioned POSIX shared memory region, so the external
+ * monitoring agents may sample them at high rate without any system call
+ * and without disturbing the protocol threads.
+ *
+ * # Concept
+ *
+ * The process owning the stack creates the page, registers the layers and
+ * periodically calls isn_shmstats_update(), i.e. from its main loop:
+ * ~~~
+ * isn_shmstats_t *shm = isn_shmstats_create("/isn_gateway", 16);
+ * int phy = isn_shmstats_add(shm, "serial", serial, -1);
+ * isn_shmstats_add(shm, "frame", &isn_frame, phy);
+ * ...
+ * isn_shmstats_update(shm);
+ * ~~~
+ * Updates are protected by a sequence lock; readers map the same region
+ * read-only and retry when the sequence number was odd or has changed
+ * meanwhile, see isn_shmstats_snapshot() and the `isn_shmstat` tool.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#ifndef ISN_SHMSTATS_H
+#define ISN_SHMSTATS_H
+
+#include "isn_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ISN_SHMSTATS_MAGIC      0x534E5349  ///< "ISNS"
+#define ISN_SHMSTATS_VERSION    1           ///< Incremented on any change of the page layout
+#define ISN_SHMSTATS_NAME_SIZE  24
+
+/** Statistics of a single layer */
+typedef struct {
+    char name[ISN_SHMSTATS_NAME_SIZE];
+    int32_t parent;                 ///< index of the parent layer, or -1
+    uint32_t reserved;
+    isn_driver_stats_t stats;
+} isn_shmstats_entry_t;
+
+/** Layout of the shared memory region */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;                   ///< sequence lock, odd while being updated
+    uint32_t capacity;              ///< max number of entries
+    uint32_t count;                 ///< number of valid entries
+    uint32_t entry_size;            ///< sizeof(isn_shmstats_entry_t) for forward compatibility
+    uint64_t updates;               ///< number of updates
+    isn_shmstats_entry_t entries[];
+} isn_shmstats_page_t;
+
+typedef struct isn_shmstats_s isn_shmstats_t;
+
+/** Size of the page for a given number of entries */
+static inline size_t isn_shmstats_pagesize(uint32_t capacity) {
+    return sizeof(isn_shmstats_page_t) + capacity * sizeof(isn_shmstats_entry_t);
+}
+
+/**
+ * Create and map the shared memory page
+ *
+ * \param name of the shared memory object, starting with a slash
+ * \param capacity max number of layers
+ * \returns instance or NULL on error
+ */
+isn_shmstats_t *isn_shmstats_create(const char *name, uint32_t capacity);
+
+/**
+ * Unmap and remove the shared memory page
+ */
+void isn_shmstats_drop(isn_shmstats_t *obj);
+
+/**
+ * Register statistics
+ *
+ * \param obj
+ * \param name of the layer
+ * \param stats counters which are copied to the page by the isn_shmstats_update()
+ * \param parent index of the parent layer or -1
+ * \returns index of the entry or -1 if page is full
+ */
+int isn_shmstats_add_stats(isn_shmstats_t *obj, const char *name, const isn_driver_stats_t *stats, int parent);
+
+/** Register a protocol layer, which must be of isn_driver_t type */
+static inline int isn_shmstats_add(isn_shmstats_t *obj, const char *name, isn_layer_t *layer, int parent) {
+    return isn_shmstats_add_stats(obj, name, &((isn_driver_t *)layer)->stats, parent);
+}
+
+/**
+ * Copy all registered statistics to the page, to be called from the thread running the stack
+ */
+void isn_shmstats_update(isn_shmstats_t *obj);
+
+/**
+ * Consistent copy of the page, as seen by the readers
+ *
+ * \param page mapped shared memory
+ * \param copy destination of at least isn_shmstats_pagesize(page->capacity) bytes
+ * \param retries max number of attempts
+ * \returns 0 on success, -1 on invalid page, -2 if the writer kept updating it
+ */
+int isn_shmstats_snapshot(const isn_shmstats_page_t *page, isn_shmstats_page_t *copy, int retries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ISN_SHMSTATS_H
@@ -80,6 +80,13 @@ int isn_udp_driver_poll(isn_udp_driver_t *driver, time_ms_t timeout);
  */
 void isn_udp_driver_setlogging(isn_logger_level_t level);
 
+isn_driver_stats_t* isn_udp_driver_get_stats(isn_udp_driver_t* driver);
+
+#ifndef _WIN32
+/** \returns socket of the driver, to wait for input in an event loop and then call isn_udp_driver_poll() with timeout 0 */
+int isn_udp_driver_getfd(isn_udp_driver_t* driver);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
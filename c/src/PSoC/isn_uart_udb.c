@@ -29,12 +29,12 @@
  * Receiver buffer spawns an event whenever number of bytes received
  * is above the threshold, and on timeout since the last byte received.
  *
- * Size 256 was chosen to simplify circular buffers. Increasing the
- * size requires code modifications.
+ * Buffers are implemented by the \ref GR_ISN_Ring, and their size may
+ * be changed by the RX_FIFO_SIZE and TX_FIFO_SIZE.
  *
  * The transmit buffer will under all conditions always, when data
- * are sent, provide a buffer of at least 128 B, an important condition
- * which eliminates the need for fragmentation.
+ * are sent, provide a buffer of about half of its size, an important
+ * condition which eliminates the need for fragmentation.
  *
  * \section Support for fixed configuration 8E1 UDB implementation
  *
@@ -56,23 +56,24 @@
 #include <project.h>
 #include <string.h>
 #include "isn_reactor.h"
+#include "isn_ring.h"
 #include "PSoC/isn_uart.h"
 
-#define RX_FIFO_SIZE    256             ///< Interrupt and Zero-Copy Receive Buffer, this size of 256 simplifes circular buffers with 8-bit integers
-#define TX_FIFO_SIZE    256             ///< Interrupt and Zero-Copy Transmit Buffer, this size of 256 simplifes circular buffers with 8-bit integers
+#ifndef RX_FIFO_SIZE
+# define RX_FIFO_SIZE   256             ///< Interrupt and Zero-Copy Receive Buffer
+#endif
+#ifndef TX_FIFO_SIZE
+# define TX_FIFO_SIZE   256             ///< Interrupt and Zero-Copy Transmit Buffer
+#endif
 
 static uint8_t rx_buf[RX_FIFO_SIZE];
-static volatile uint8_t rxb_wri = 0;    ///< Write index, followed by rxb_rdi, wri must never be incremented over rdi, effective buffer size is thus -1
-static volatile uint8_t rxb_rdi = 0;    ///< when rxb_rdi == rxb_wri, buffer is empty
+static isn_ring_t rxb;                  ///< Written by the rx isr, and read by the collect
 static volatile uint32_t rxb_err = 0;   ///< Counts number of errorneous uart bytes
 static volatile uint32_t rxb_dropped =0;///< Counts number of dropped uart bytes
 static volatile isn_clock_counter_t ts = 0;
 
 static uint8_t tx_buf[TX_FIFO_SIZE];
-static volatile uint8_t txb_wri = 0;    ///< Write index, followed by txb_rdi, wri must never be incremented over rdi, effective buffer size is thus -1
-static volatile uint8_t txb_rdi = 0;    ///< when txb_rdi == txb_wri, buffer is empty
-static volatile uint8_t txb_wrw = 255;  ///< Dynamic Wrap point to simulate linear buffers, at which point rd/wr index wrap
-static uint8_t txb_alloc_wrw = 255, txb_alloc_wri = 255, txb_alloc_size = 0;    // invalidate, so free cannot work
+static isn_ring_t txb;                  ///< Reserved by the getsendbuf(), and read by the tx isr
 
 static volatile isn_reactor_queue_t queue;
 static volatile int uart_imm_trigger = ISN_REACTOR_TASKLET_INVALID, uart_timeout_trigger = ISN_REACTOR_TASKLET_INVALID;
@@ -170,13 +171,7 @@ static void rx_isr__() {
         while (uart_rx8e1_count != (UART_RX8E1_COUNT_COUNT_REG & UART_RX8E1_COUNT_MASK)) {
             uart_rx8e1_count = (uart_rx8e1_count-1) & UART_RX8E1_COUNT_MASK;
 #endif
-            uint8_t b = UART_RXDATA_REG;
-            uint8_t wri_next = rxb_wri + 1; // & RX_FIFO_MASK, but not needed as it is 8-bit
-            if (wri_next != rxb_rdi) {
-                __atomic_store_n(&rx_buf[rxb_wri], b, __ATOMIC_SEQ_CST);
-                __atomic_store_n(&rxb_wri, wri_next,  __ATOMIC_SEQ_CST);
-            }
-            else {
+            if (isn_ring_putbyte(&rxb, UART_RXDATA_REG) < 0) {
                 rxb_dropped++;
             }
         }
@@ -187,18 +182,17 @@ static void rx_isr__() {
     ts = isn_clock_now();
     if (queue) {
         // Trigger immediate event if threshold is reached and postpone timeout event
-        if ((uint8_t)(rxb_wri - rxb_rdi) > recv_thr && !isn_reactor_isvalid(uart_imm_trigger, rx_imm_event, NULL)) {
+        if (isn_ring_used(&rxb) > recv_thr && !isn_reactor_valid(uart_imm_trigger)) {
             uart_imm_trigger = queue(rx_imm_event, NULL, isn_clock_now(), hmutex);
         }
         // Spawn a timeout event to flush, if it exists, prolong the timeout
-        if (!isn_reactor_isvalid(uart_timeout_trigger, rx_timeout_event, NULL)) {
+        if (!isn_reactor_retime(uart_timeout_trigger, ISN_REACTOR_DELAY_ticks(delay))) {
             uart_timeout_trigger = queue(rx_timeout_event, NULL, ISN_REACTOR_DELAY_ticks(delay), hmutex);
         }
-        else isn_reactor_change_timed(uart_timeout_trigger, rx_timeout_event, NULL, ISN_REACTOR_DELAY_ticks(delay));
     }
 }
 
-/** Copy from FIFO to TX, and wrap at txb_wrw position */
+/** Copy from FIFO to TX, ring wraps at its dynamic wrap point */
 #if (CYDEV_CHIP_FAMILY_USED == CYDEV_CHIP_FAMILY_PSOC5)
 CY_ISR_PROTO(tx_isr__);
 CY_ISR(tx_isr__) {
@@ -217,12 +211,12 @@ static void tx_isr__() {
     uint8_t uart_tx8e1_count_limit = ((UART_TX8E1_COUNT_COUNT_REG & UART_TX8E1_COUNT_MASK) - 4) & UART_TX8E1_COUNT_MASK;
     while (uart_tx8e1_count != uart_tx8e1_count_limit) {
 #endif
-        if (txb_rdi != txb_wri) {
-            if (txb_rdi == txb_wrw) txb_rdi = 0;
+        int b = isn_ring_getbyte(&txb);
+        if (b >= 0) {
 #if defined(UART_TX8E1_SERIALIZER_F0_REG)
             uart_tx8e1_count = (uart_tx8e1_count-1) & UART_TX8E1_COUNT_MASK;
 #endif
-            UART_TXDATA_REG = tx_buf[txb_rdi++];
+            UART_TXDATA_REG = (uint8_t)b;
         }
         else {
 #if defined(UART_TX8E1_SERIALIZER_F0_REG)
@@ -247,39 +241,10 @@ static int isn_uart_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const
     isn_uart_t *obj = (isn_uart_t *)drv;
 
     if (!obj->buf_locked) {
-        txb_alloc_wrw = txb_wrw;    // restore settings from last actual transmission as there is
-        txb_alloc_wri = txb_wri;    // a possibilty that there were several getsendbuf() attempts meanwhile
-        uint8_t txb_cur_rdi = txb_rdi;  // take snap shot, as it may change during irq
-
-        if (txb_cur_rdi > txb_wri) {
-            size_t free = (size_t)(txb_cur_rdi) - (size_t)(txb_wri) - 1;          // [ .. wri <-> rdi ..]
-            if (size > free) size = free;
-        }
-        else {
-            size_t free_start = txb_cur_rdi;                            // [ <-> rdi .. wri .. ], actual size is -1
-            size_t free_end = (TX_FIFO_SIZE-1) - (size_t)txb_wri;   // [ .. rdi .. wri <-> ]
-
-            if (size < free_end || free_end >= free_start) {        // prefered place to stretch fifo to max
-                if (size > free_end) size = free_end;
-                txb_alloc_wrw = txb_wri + size;                     // move wrap index to the end
-            }
-            else if (free_start > 0) {
-                free_start--;
-                if (size > free_start) size = free_start;
-                txb_alloc_wrw = txb_wri;
-                txb_alloc_wri = 0;
-            }
-            else {
-                size = 0;
-            }
-        }
+        size = isn_ring_reserve(&txb, dest, size);
         if (size > 0) {
-            if (dest) {
-                ASSERT(((size_t)txb_alloc_wri + size) < TX_FIFO_SIZE);
-                obj->buf_locked = 1;
-                *dest = &tx_buf[txb_alloc_wri];
-            }
-            return txb_alloc_size = (uint8_t)size;
+            if (dest) obj->buf_locked = 1;
+            return size;
         }
     }
     if (dest) {
@@ -291,17 +256,15 @@ static int isn_uart_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const
 
 static void isn_uart_free(isn_layer_t *drv, const void *ptr) {
     isn_uart_t *obj = (isn_uart_t *)drv;
-    if (ptr == &tx_buf[txb_alloc_wri]) {
+    if (ptr == &tx_buf[txb.alloc_wri]) {
         obj->buf_locked = 0;                // we only support one buffer so we may free
     }
 }
 
 static int isn_uart_send(isn_layer_t *drv, void *dest, size_t size) {
     isn_uart_t *obj = (isn_uart_t *)drv;
-    assert(size <= txb_alloc_size);
     if (size) {
-        __atomic_store_n(&txb_wrw, txb_alloc_wrw, __ATOMIC_SEQ_CST);
-        __atomic_store_n(&txb_wri, txb_alloc_wri + size, __ATOMIC_SEQ_CST);
+        isn_ring_commit(&txb, size);
         obj->drv.stats.tx_counter += size;
         obj->drv.stats.tx_packets++;
         __atomic_memsync();
@@ -327,16 +290,17 @@ static int isn_uart_send(isn_layer_t *drv, void *dest, size_t size) {
  * Overflown buffers are split into linear sections, and multiple calls.
  */
 int isn_uart_collect(isn_uart_t *obj, size_t maxsize, uint32_t timeout) {
-    size_t size = (uint8_t)(rxb_wri - rxb_rdi);
+    size_t size = isn_ring_used(&rxb);
 
     if (size >= maxsize || (isn_clock_elapsed(ts) > timeout && size > 0)) {
         if (size > maxsize) size = maxsize;
         do {
-            size_t linsize = size;
-            if (((size_t)rxb_rdi + linsize) >= RX_FIFO_SIZE) linsize = RX_FIFO_SIZE - rxb_rdi;
-            size_t fw_size = obj->child_driver->recv(obj->child_driver, &rx_buf[rxb_rdi], linsize, obj);
+            const void *src;
+            size_t linsize = isn_ring_peek(&rxb, &src);
+            if (linsize > size) linsize = size;
+            size_t fw_size = obj->child_driver->recv(obj->child_driver, src, linsize, obj);
             if (fw_size) obj->drv.stats.rx_packets++;
-            rxb_rdi += fw_size;
+            isn_ring_consume(&rxb, fw_size);
             obj->drv.stats.rx_counter += fw_size;
             if (fw_size != linsize) {
                 obj->drv.stats.rx_retries++;    // Packet could not be fully accepted, retry next time
@@ -349,19 +313,17 @@ int isn_uart_collect(isn_uart_t *obj, size_t maxsize, uint32_t timeout) {
 
     obj->drv.stats.rx_errors  = rxb_err;
     obj->drv.stats.rx_dropped = rxb_dropped;
-    return (uint8_t)(rxb_wri - rxb_rdi);    // return remaining bytes that could not be sent and recalling of this func should be asap
+    return isn_ring_used(&rxb);             // return remaining bytes that could not be sent and recalling of this func should be asap
 }
 
 size_t isn_uart_getrecvsize() {
-    return (uint8_t)(rxb_wri - rxb_rdi);
+    return isn_ring_used(&rxb);
 }
 
 int isn_uart_getrecvbyte() {
-    if (rxb_wri != rxb_rdi) {
-        this->drv.stats.rx_counter++;
-        return rx_buf[rxb_rdi++];
-    }
-    return -1;
+    int b = isn_ring_getbyte(&rxb);
+    if (b >= 0) this->drv.stats.rx_counter++;
+    return b;
 }
 
 void isn_uart_radiate(isn_uart_t *obj, size_t receive_threshold, isn_clock_counter_t timeout, isn_reactor_queue_t priority_queue,
@@ -391,6 +353,8 @@ void isn_uart_init(isn_uart_t *obj, isn_layer_t* child) {
     obj->drv.free = isn_uart_free;
     obj->child_driver = child;
     obj->buf_locked = 0;
+    isn_ring_init(&rxb, rx_buf, sizeof(rx_buf));
+    isn_ring_init(&txb, tx_buf, sizeof(tx_buf));
     UART_Start();
 
 #if (CYDEV_CHIP_FAMILY_USED == CYDEV_CHIP_FAMILY_PSOC5)
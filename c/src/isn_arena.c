@@ -0,0 +1,61 @@
+/** \file
+ *  \brief ISN Object Arena Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_arena.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_Arena
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "isn_arena.h"
+
+/**\{ */
+
+#define ALIGN_UP(x)     (((x) + CONFIG_ISN_ARENA_ALIGN - 1) & ~((size_t)CONFIG_ISN_ARENA_ALIGN - 1))
+
+void isn_arena_init(isn_arena_t *obj, void *mem, size_t size) {
+    ASSERT(obj);
+    ASSERT(mem);
+    size_t skip = ALIGN_UP((uintptr_t)mem) - (uintptr_t)mem;
+    obj->base = (uint8_t *)mem + skip;
+    obj->size = (size > skip) ? size - skip : 0;
+    obj->used = 0;
+    obj->high = 0;
+}
+
+void *isn_arena_alloc(isn_arena_t *obj, size_t size) {
+    size_t start = ALIGN_UP(obj->used);
+    if (start > obj->size || size > obj->size - start) return NULL;
+    obj->used = start + size;
+    if (obj->used > obj->high) obj->high = obj->used;
+    memset(obj->base + start, 0, size);
+    return obj->base + start;
+}
+
+void isn_arena_reset(isn_arena_t *obj) {
+    obj->used = 0;
+}
+
+isn_arena_t* isn_arena_create(size_t size) {
+    size_t hdr = ALIGN_UP(sizeof(isn_arena_t));
+    isn_arena_t* obj = malloc(hdr + size + CONFIG_ISN_ARENA_ALIGN - 1);
+    if (obj) isn_arena_init(obj, (uint8_t *)obj + hdr, size + CONFIG_ISN_ARENA_ALIGN - 1);
+    return obj;
+}
+
+void isn_arena_drop(isn_arena_t *obj) {
+    free(obj);
+}
+
+/** \} \endcond */
@@ -0,0 +1,91 @@
+/** \file
+ *  \brief ISN Tasklet Argument Pool Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_argpool.h
+ */
+/**
+ * \ingroup GR_ISN_Reactor
+ * \cond Implementation
+ * \addtogroup GR_ISN_ArgPool
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "isn_argpool.h"
+
+/**\{ */
+
+#define HEADER_SIZE     sizeof(isn_argpool_t *)
+#define BITMAP_SIZE(n)  (((n) + 63) / 64 * 8)
+
+void isn_argpool_init(isn_argpool_t *obj, void *mem, size_t payload_size, uint16_t nslots) {
+    ASSERT(obj);
+    ASSERT(mem);
+    memset(obj, 0, sizeof(isn_argpool_t));
+    memset(mem, 0, BITMAP_SIZE(nslots));
+    obj->bitmap       = mem;
+    obj->slots        = (uint8_t *)mem + BITMAP_SIZE(nslots);
+    obj->slot_size    = ISN_ARGPOOL_SLOT_SIZE(payload_size);
+    obj->payload_size = payload_size;
+    obj->nslots       = nslots;
+}
+
+void *isn_argpool_alloc(isn_argpool_t *obj, size_t size) {
+    if (size > obj->payload_size) return NULL;
+
+    for (uint16_t w = 0; w < (obj->nslots + 31) / 32; w++) {
+        uint32_t bits = __atomic_load_n(&obj->bitmap[w], __ATOMIC_RELAXED);
+        while (~bits) {
+            int b = __builtin_ctz(~bits);
+            uint16_t slot = w * 32 + b;
+            if (slot >= obj->nslots) break;
+            if (__atomic_compare_exchange_n(&obj->bitmap[w], &bits, bits | (1UL << b), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                uint16_t used = __atomic_add_fetch(&obj->used, 1, __ATOMIC_RELAXED);
+                if (used > obj->high) obj->high = used;
+
+                uint8_t *p = obj->slots + (size_t)slot * obj->slot_size;
+                *(isn_argpool_t **)p = obj;
+                return p + HEADER_SIZE;
+            }
+        }
+    }
+    __atomic_add_fetch(&obj->failed, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+void *isn_argpool_copy(isn_argpool_t *obj, const void *data, size_t size) {
+    void *p = isn_argpool_alloc(obj, size);
+    if (p && size) memcpy(p, data, size);
+    return p;
+}
+
+void isn_argpool_free(void *ptr) {
+    if (!ptr) return;
+    uint8_t *p = (uint8_t *)ptr - HEADER_SIZE;
+    isn_argpool_t *obj = *(isn_argpool_t **)p;
+    size_t slot = (size_t)(p - obj->slots) / obj->slot_size;
+    ASSERT(slot < obj->nslots);
+
+    __atomic_sub_fetch(&obj->used, 1, __ATOMIC_RELAXED);
+    __atomic_and_fetch(&obj->bitmap[slot / 32], ~(1UL << (slot % 32)), __ATOMIC_RELEASE);
+}
+
+isn_argpool_t* isn_argpool_create(size_t payload_size, uint16_t nslots) {
+    size_t hdr = (sizeof(isn_argpool_t) + 7) & ~(size_t)7;
+    isn_argpool_t* obj = malloc(hdr + ISN_ARGPOOL_SIZE(payload_size, nslots));
+    if (obj) isn_argpool_init(obj, (uint8_t *)obj + hdr, payload_size, nslots);
+    return obj;
+}
+
+void isn_argpool_drop(isn_argpool_t *obj) {
+    free(obj);
+}
+
+/** \} \endcond */
@@ -21,41 +21,73 @@
 
 /**\{ */
 
-static size_t isn_dispatch_recv(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller) {
-    isn_dispatch_t *obj = (isn_dispatch_t *)drv;
+/** Returns the receiver of the packet or NULL */
+static isn_driver_t *isn_dispatch_lookup(isn_dispatch_t *obj, const void *buf, size_t size) {
     isn_bindings_t *child = obj->childs;
-    int protocol = *(const uint8_t *)buf;
 
-    // exceptions are frame protocols
-    if ((protocol & ISN_PROTO_FRAME_MASK) == ISN_PROTO_FRAME) protocol = ISN_PROTO_FRAME;
-    else if ((protocol & ISN_PROTO_FRAME_LONG_MASK) == ISN_PROTO_FRAME_LONG) protocol = ISN_PROTO_FRAME_LONG;
-    else if ((protocol & ISN_PROTO_FRAME_JUMBO_MASK) == ISN_PROTO_FRAME_JUMBO) protocol = ISN_PROTO_FRAME_JUMBO;
+    if (!buf || !size) return NULL;
 
-    if (!buf || !size) return size;
+    int protocol = isn_dispatch_protocol(buf);
 
     child--;
     do {
         child++;
         if (child->protocol == protocol || child->protocol == ISN_PROTO_OTHER) {
             isn_driver_t *driver = (isn_driver_t *)child->driver;
-            if (driver->recv) {
-                return driver->recv(driver, buf, size, caller);
-            }
+            if (driver->recv) return driver;
         }
     }
     while (child->protocol >= 0);
+    return NULL;
+}
+
+static size_t isn_dispatch_recv(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller) {
+#ifdef ISN_DISPATCH_STATIC_BINDINGS
+# define ISN_DISPATCH_CASE(protocol, recv, layer)   case protocol: return recv(layer, buf, size, caller);
+    if (buf && size) {
+        switch (isn_dispatch_protocol(buf)) {
+            ISN_DISPATCH_STATIC_BINDINGS(ISN_DISPATCH_CASE)
+            default: break;
+        }
+    }
+#endif
+    isn_driver_t *driver = isn_dispatch_lookup((isn_dispatch_t *)drv, buf, size);
+    if (driver) return driver->recv(driver, buf, size, caller);
     return size;   // Ack all but account dropped packet
 }
 
+/** Partitions the batch into runs of packets of the same receiver, and passes each run at once */
+static size_t isn_dispatch_recv_batch(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller) {
+    isn_dispatch_t *obj = (isn_dispatch_t *)drv;
+    if (!count) return 0;
+
+    isn_driver_t *driver = isn_dispatch_lookup(obj, pkts[0].src, pkts[0].size);
+    size_t start = 0;
+
+    for (size_t i=1; i<=count; i++) {
+        isn_driver_t *next = (i < count) ? isn_dispatch_lookup(obj, pkts[i].src, pkts[i].size) : NULL;
+        if (i == count || next != driver) {
+            if (driver) {
+                size_t done = isn_recv_batch(driver, &pkts[start], i - start, caller);
+                if (done < i - start) return start + done;
+            }
+            start  = i;
+            driver = next;
+        }
+    }
+    return count;
+}
+
 void isn_dispatch_init(isn_dispatch_t *obj, isn_bindings_t* childs) {
     ASSERT(obj);
     ASSERT(childs);
     obj->drv.recv = isn_dispatch_recv;
+    obj->drv.recv_batch = isn_dispatch_recv_batch;
     obj->childs   = childs;
 }
 
 isn_dispatch_t* isn_dispatch_create() {
-    isn_dispatch_t* obj = malloc(sizeof(isn_dispatch_t));
+    isn_dispatch_t* obj = calloc(1, sizeof(isn_dispatch_t));
     return obj;
 }
 
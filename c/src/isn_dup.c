@@ -30,13 +30,18 @@
 
 #include <stdlib.h>
 #include "isn_dup.h"
+#include "isn_static.h"
+
+#ifndef ISN_DUP_CHILD_RECV
+# define ISN_DUP_CHILD_RECV ISN_DYNAMIC_RECV
+#endif
 
 /**\{ */
 
 static size_t isn_dup_recv(isn_layer_t *drv, const void *buf, size_t size, isn_layer_t *caller) {
     isn_dup_t *obj = (isn_dup_t *)drv;
-    size_t recv1 = obj->childs[0]->recv(obj->childs[0], buf, size, caller);
-    size_t recv2 = obj->childs[1]->recv(obj->childs[1], buf, size, caller);
+    size_t recv1 = ISN_DUP_CHILD_RECV(obj->childs[0], buf, size, caller);
+    size_t recv2 = ISN_DUP_CHILD_RECV(obj->childs[1], buf, size, caller);
     if (recv1 != recv2) obj->dup_errors++;
     return (recv1 > recv2) ? recv1 : recv2;
 }
@@ -46,13 +51,14 @@ void isn_dup_init(isn_dup_t *obj, isn_layer_t *child1, isn_layer_t *child2) {
     ASSERT(child1);
     ASSERT(child2);
     obj->drv.recv  = isn_dup_recv;
+    obj->drv.recv_batch = NULL;
     obj->childs[0] = (isn_receiver_t *)child1;
     obj->childs[1] = (isn_receiver_t *)child2;
     obj->dup_errors = 0;
 }
 
 isn_dup_t* isn_dup_create() {
-    isn_dup_t* obj = malloc(sizeof(isn_dup_t));
+    isn_dup_t* obj = calloc(1, sizeof(isn_dup_t));
     return obj;
 }
 
@@ -20,6 +20,24 @@
 #include <stdlib.h>
 #include "isn_clock.h"
 #include "isn_frame.h"
+#include "isn_scan.h"
+#include "isn_static.h"
+
+#ifndef ISN_FRAME_CHILD_RECV
+# define ISN_FRAME_CHILD_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_FRAME_OTHER_RECV
+# define ISN_FRAME_OTHER_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_FRAME_PARENT_GETSENDBUF
+# define ISN_FRAME_PARENT_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_FRAME_PARENT_SEND
+# define ISN_FRAME_PARENT_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_FRAME_PARENT_FREE
+# define ISN_FRAME_PARENT_FREE ISN_DYNAMIC_FREE
+#endif
 
 /**\{ */
 
@@ -69,7 +87,7 @@ static int isn_frame_getsendbuf(isn_layer_t *drv, void **dest, size_t size, cons
     isn_frame_t *obj = (isn_frame_t *)drv;
     if (size > ISN_FRAME_MAXSIZE) size = ISN_FRAME_MAXSIZE; // limited by the frame protocol
     int xs = 1 + (int)obj->crc_enabled;
-    xs = obj->parent->getsendbuf(obj->parent, dest, size + xs, caller) - xs;
+    xs = ISN_FRAME_PARENT_GETSENDBUF(obj->parent, dest, size + xs, caller) - xs;
     uint8_t **buf = (uint8_t **)dest;
     if (buf) {
         if (*buf) (*buf)++;
@@ -81,16 +99,13 @@ static int isn_frame_getsendbuf(isn_layer_t *drv, void **dest, size_t size, cons
 static void isn_frame_free(isn_layer_t *drv, const void *ptr) {
     isn_frame_t *obj = (isn_frame_t *)drv;
     const uint8_t *buf = ptr;
-    if (buf) obj->parent->free(obj->parent, buf - 1);
+    if (buf) ISN_FRAME_PARENT_FREE(obj->parent, buf - 1);
 }
 
-static int isn_frame_send(isn_layer_t *drv, void *dest, size_t size) {
-    isn_frame_t *obj = (isn_frame_t *)drv;
-    uint8_t *buf = dest;
-    uint8_t *start = --buf;
+size_t isn_frame_encode(const isn_layer_t *drv, uint8_t *frame, size_t size) {
+    const isn_frame_t *obj = (const isn_frame_t *)drv;
+    uint8_t *buf = frame;
     assert(size <= ISN_FRAME_MAXSIZE);
-    obj->drv.stats.tx_packets++;
-    obj->drv.stats.tx_counter += size;
     *buf = 0xC0 - 1 + size;             // Header, assuming short frame
     size_t frame_size = size + 1;       // Add header to the payload size
     if (obj->crc_enabled) {
@@ -100,7 +115,17 @@ static int isn_frame_send(isn_layer_t *drv, void *dest, size_t size) {
         *buf = crc;
         frame_size++;                   // Add CRC size
     }
-    obj->parent->send(obj->parent, start, frame_size);
+    return frame_size;
+}
+
+const isn_encoder_t isn_frame_encoder = {1, 2, ISN_FRAME_MAXSIZE, isn_frame_encode};
+
+static int isn_frame_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_frame_t *obj = (isn_frame_t *)drv;
+    uint8_t *start = (uint8_t *)dest - 1;
+    obj->drv.stats.tx_packets++;
+    obj->drv.stats.tx_counter += size;
+    ISN_FRAME_PARENT_SEND(obj->parent, start, isn_frame_encode(obj, start, size));
     return size;
 }
 
@@ -108,41 +133,44 @@ static int isn_frame_send(isn_layer_t *drv, void *dest, size_t size) {
 #define IS_IN_MESSAGE   1
 #define IS_FW_MESSAGE   2
 
-static size_t isn_frame_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
-    isn_frame_t *obj = (isn_frame_t *)drv;
-    const volatile uint8_t *buf = src;
-
-    if (obj->state == IS_IN_MESSAGE && isn_clock_elapsed(obj->last_ts) > obj->frame_timeout) {
-        obj->state = IS_NONE;
-        if (obj->recv_len) {
-            obj->drv.stats.rx_dropped++;
+/** Drops incomplete frame on timeout, learns the timeout from the gaps within frames, and marks the time of reception */
+static void isn_frame_timeout(isn_frame_t *obj) {
+    if (obj->state == IS_IN_MESSAGE) {
+        int32_t gap = isn_clock_elapsed(obj->last_ts);
+        if (gap > (int32_t)obj->frame_timeout) {
+            obj->state = IS_NONE;
+            if (obj->recv_len) {
+                obj->drv.stats.rx_dropped++;
+            }
+            obj->recv_size = obj->recv_len = 0;
         }
-        obj->recv_size = obj->recv_len = 0;
+        if (obj->adaptive) obj->frame_timeout = isn_timeout_sample(obj->adaptive, gap);     // also beyond the timeout, so it may rise
     }
     obj->last_ts = isn_clock_now();
+}
+
+static size_t isn_frame_decode(isn_frame_t *obj, const void *src, size_t size, isn_layer_t *caller) {
+    const volatile uint8_t *buf = src;
 
     if (!src || !size) {
         obj->drv.stats.rx_dropped++;
         return size;
     }
 
-    for (uint8_t i=0; i<size;) {
+    for (size_t i=0; i<size;) {
         switch (obj->state) {
             case IS_NONE: {
-                if (*buf > 0x80) {
-                    if (obj->recv_size) {
-                        if (obj->other) obj->other->recv(obj->other, obj->recv_buf, obj->recv_size, caller);
-                        obj->recv_size = obj->recv_len = 0;
-                    }
-                    obj->state = IS_IN_MESSAGE;
-                    if (obj->crc_enabled) {
-                        obj->crc  = crc8(*buf);
-                    }
-                    obj->recv_len = (*buf & 0x3F) + 1;
+                size_t other_size = isn_scan_frame((const uint8_t *)buf, size - i);
+                if (other_size) {       // pass the run of other data to OTHER at once
+                    if (obj->other) ISN_FRAME_OTHER_RECV(obj->other, (const void *)buf, other_size, caller);
+                    i += other_size; buf += other_size;
+                    break;
                 }
-                else {
-                    obj->recv_buf[obj->recv_size++] = *buf;   // collect other data to be passed to OTHER ..
+                obj->state = IS_IN_MESSAGE;
+                if (obj->crc_enabled) {
+                    obj->crc  = crc8(*buf);
                 }
+                obj->recv_len = (*buf & 0x3F) + 1;
                 i++; buf++;
                 break;
             }
@@ -180,7 +208,7 @@ static size_t isn_frame_recv(isn_layer_t *drv, const void *src, size_t size, isn
         }
 
         if (obj->state == IS_FW_MESSAGE) {
-            size_t forwarded_bytes = obj->child->recv(obj->child, &obj->recv_buf[obj->recv_fwed], obj->recv_size, obj);
+            size_t forwarded_bytes = ISN_FRAME_CHILD_RECV(obj->child, &obj->recv_buf[obj->recv_fwed], obj->recv_size, obj);
             if (forwarded_bytes < obj->recv_size) {
                 obj->recv_fwed += forwarded_bytes;
                 obj->recv_size -= forwarded_bytes;
@@ -192,14 +220,25 @@ static size_t isn_frame_recv(isn_layer_t *drv, const void *src, size_t size, isn
         }
     }
 
-    // flush non-framed (packed) data immediately
-    if (obj->recv_size && obj->recv_len == 0) {
-        if (obj->other) obj->other->recv(obj->other, obj->recv_buf, obj->recv_size, caller);
-        obj->recv_size = 0;
-    }
     return size;
 }
 
+static size_t isn_frame_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    isn_frame_t *obj = (isn_frame_t *)drv;
+    isn_frame_timeout(obj);
+    return isn_frame_decode(obj, src, size, caller);
+}
+
+/** Packets of a batch are received at once, so the timeout is checked only once */
+static size_t isn_frame_recv_batch(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller) {
+    isn_frame_t *obj = (isn_frame_t *)drv;
+    isn_frame_timeout(obj);
+    for (size_t i=0; i<count; i++) {
+        if (isn_frame_decode(obj, pkts[i].src, pkts[i].size, caller) < pkts[i].size) return i;
+    }
+    return count;
+}
+
 void isn_frame_init(isn_frame_t *obj, isn_frame_mode_t mode, isn_layer_t* child, isn_layer_t* other, isn_layer_t* parent, uint32_t timeout) {
     ASSERT(obj);
     ASSERT(parent);
@@ -209,13 +248,16 @@ void isn_frame_init(isn_frame_t *obj, isn_frame_mode_t mode, isn_layer_t* child,
     obj->drv.getsendbuf   = isn_frame_getsendbuf;
     obj->drv.send         = isn_frame_send;
     obj->drv.recv         = isn_frame_recv;
+    obj->drv.recv_batch   = isn_frame_recv_batch;
     obj->drv.free         = isn_frame_free;
 
     obj->parent           = parent;
+    obj->drv.memclass     = ((isn_driver_t *)parent)->memclass;    // passes the buffers of the parent through
     obj->crc_enabled      = mode;
     obj->child            = child;
     obj->other            = other;
     obj->frame_timeout    = timeout;
+    obj->adaptive         = NULL;
 
     obj->state            = IS_NONE;
     obj->recv_size        = 0;
@@ -223,8 +265,13 @@ void isn_frame_init(isn_frame_t *obj, isn_frame_mode_t mode, isn_layer_t* child,
     obj->last_ts          = 0;
 }
 
+void isn_frame_setadaptive(isn_frame_t *obj, isn_timeout_t *adaptive) {
+    obj->adaptive = adaptive;
+    if (adaptive) obj->frame_timeout = isn_timeout_get(adaptive);
+}
+
 isn_frame_t* isn_frame_create() {
-    isn_frame_t* obj = malloc(sizeof(isn_frame_t));
+    isn_frame_t* obj = calloc(1, sizeof(isn_frame_t));
     return obj;
 }
 
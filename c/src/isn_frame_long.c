@@ -20,6 +20,24 @@
 #include <stdlib.h>
 #include "isn_clock.h"
 #include "isn_frame_long.h"
+#include "isn_scan.h"
+#include "isn_static.h"
+
+#ifndef ISN_FRAME_LONG_CHILD_RECV
+# define ISN_FRAME_LONG_CHILD_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_FRAME_LONG_OTHER_RECV
+# define ISN_FRAME_LONG_OTHER_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_FRAME_LONG_PARENT_GETSENDBUF
+# define ISN_FRAME_LONG_PARENT_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_FRAME_LONG_PARENT_SEND
+# define ISN_FRAME_LONG_PARENT_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_FRAME_LONG_PARENT_FREE
+# define ISN_FRAME_LONG_PARENT_FREE ISN_DYNAMIC_FREE
+#endif
 
 /**\{ */
 
@@ -89,7 +107,7 @@ static inline __attribute__((always_inline)) uint16_t crc16_ccitt(uint16_t crc,
 static int isn_frame_long_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
     isn_frame_long_t *obj = (isn_frame_long_t *)drv;
     if (size > ISN_FRAME_LONG_MAXSIZE) size = ISN_FRAME_LONG_MAXSIZE; // limited by the frame protocol
-    int xs = obj->parent->getsendbuf(obj->parent, dest, size + ISN_FRAME_LONG_OVERHEAD, caller) - ISN_FRAME_LONG_OVERHEAD;
+    int xs = ISN_FRAME_LONG_PARENT_GETSENDBUF(obj->parent, dest, size + ISN_FRAME_LONG_OVERHEAD, caller) - ISN_FRAME_LONG_OVERHEAD;
     uint8_t **buf = (uint8_t **)dest;
     if (buf) {
         if (*buf) (*buf)+=ISN_FRAME_LONG_HEADER;
@@ -101,18 +119,14 @@ static int isn_frame_long_getsendbuf(isn_layer_t *drv, void **dest, size_t size,
 static void isn_frame_long_free(isn_layer_t *drv, const void *ptr) {
     isn_frame_long_t *obj = (isn_frame_long_t *)drv;
     const uint8_t *buf = ptr;
-    if (buf) obj->parent->free(obj->parent, buf - ISN_FRAME_LONG_HEADER);
+    if (buf) ISN_FRAME_LONG_PARENT_FREE(obj->parent, buf - ISN_FRAME_LONG_HEADER);
 }
 
-static int isn_frame_long_send(isn_layer_t *drv, void *dest, size_t size) {
-    isn_frame_long_t *obj = (isn_frame_long_t *)drv;
-    uint8_t *buf = &((uint8_t *)dest)[-ISN_FRAME_LONG_HEADER];
+size_t isn_frame_long_encode(const isn_layer_t *drv, uint8_t *frame, size_t size) {
+    uint8_t *buf = frame;
     uint8_t *start = buf;
 
     assert(size <= ISN_FRAME_LONG_MAXSIZE);
-    obj->drv.stats.tx_counter += size;
-    obj->drv.stats.tx_packets++;
-
     *buf++ = ISN_PROTO_FRAME_LONG | ((size - 1) >> 8);
     *buf++ = (size - 1) & 0xFF;
 
@@ -122,7 +136,18 @@ static int isn_frame_long_send(isn_layer_t *drv, void *dest, size_t size) {
     *buf++ = crc >> 8;
     *buf   = crc & 0xFF;
 
-    obj->parent->send(obj->parent, start, size + ISN_FRAME_LONG_OVERHEAD);
+    return size + ISN_FRAME_LONG_OVERHEAD;
+}
+
+const isn_encoder_t isn_frame_long_encoder = {ISN_FRAME_LONG_HEADER, ISN_FRAME_LONG_OVERHEAD, ISN_FRAME_LONG_MAXSIZE, isn_frame_long_encode};
+
+static int isn_frame_long_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_frame_long_t *obj = (isn_frame_long_t *)drv;
+    uint8_t *start = &((uint8_t *)dest)[-ISN_FRAME_LONG_HEADER];
+
+    obj->drv.stats.tx_counter += size;
+    obj->drv.stats.tx_packets++;
+    ISN_FRAME_LONG_PARENT_SEND(obj->parent, start, isn_frame_long_encode(obj, start, size));
     return size;
 }
 
@@ -136,11 +161,14 @@ static size_t isn_frame_long_recv(isn_layer_t *drv, const void *src, size_t size
     isn_frame_long_t *obj = (isn_frame_long_t *)drv;
     const volatile uint8_t *buf = src;
 
-    if (obj->state != IS_FW_MESSAGE && isn_clock_elapsed(obj->last_ts) > obj->frame_timeout) {
+    int32_t gap = isn_clock_elapsed(obj->last_ts);
+    int in_frame = (obj->state != IS_NONE && obj->state != IS_FW_MESSAGE);
+    if (obj->state != IS_FW_MESSAGE && gap > (int32_t)obj->frame_timeout) {
         obj->state = IS_NONE;
         if (obj->recv_len) obj->drv.stats.rx_dropped++;
         obj->recv_size = obj->recv_len = 0;
     }
+    if (in_frame && obj->adaptive) obj->frame_timeout = isn_timeout_sample(obj->adaptive, gap);  // learn from the gaps within frames
     obj->last_ts = isn_clock_now();
 
     if (!src || !size) {
@@ -148,21 +176,18 @@ static size_t isn_frame_long_recv(isn_layer_t *drv, const void *src, size_t size
         return size;
     }
 
-    for (uint8_t i=0; i<size;) {
+    for (size_t i=0; i<size;) {
         switch (obj->state) {
             case IS_NONE: {
-                if ( (*buf & ISN_PROTO_FRAME_LONG_MASK) == ISN_PROTO_FRAME_LONG) {
-                    if (obj->recv_size) {
-                        if (obj->other) obj->other->recv(obj->other, obj->recv_buf, obj->recv_size, caller);
-                        obj->recv_size = obj->recv_len = 0;
-                    }
-                    obj->state    = IS_IN_PROTOCOL;
-                    obj->crc      = crc16_ccitt(CRC16_CCITT_INITVALUE, *buf);
-                    obj->recv_len = ((uint16_t)(*buf & ~ISN_PROTO_FRAME_LONG_MASK)) << 8;
-                }
-                else {
-                    obj->recv_buf[obj->recv_size++] = *buf;   // collect other data to be passed to OTHER ..
+                size_t other_size = isn_scan_masked((const uint8_t *)buf, size - i, ISN_PROTO_FRAME_LONG_MASK, ISN_PROTO_FRAME_LONG);
+                if (other_size) {       // pass the run of other data to OTHER at once
+                    if (obj->other) ISN_FRAME_LONG_OTHER_RECV(obj->other, (const void *)buf, other_size, caller);
+                    i += other_size; buf += other_size;
+                    break;
                 }
+                obj->state    = IS_IN_PROTOCOL;
+                obj->crc      = crc16_ccitt(CRC16_CCITT_INITVALUE, *buf);
+                obj->recv_len = ((uint16_t)(*buf & ~ISN_PROTO_FRAME_LONG_MASK)) << 8;
                 i++; buf++;
                 break;
             }
@@ -206,7 +231,7 @@ static size_t isn_frame_long_recv(isn_layer_t *drv, const void *src, size_t size
         }
 
         if (obj->state == IS_FW_MESSAGE) {
-            size_t forwarded_bytes = obj->child->recv(obj->child, &obj->recv_buf[obj->recv_fwed], obj->recv_size, obj);
+            size_t forwarded_bytes = ISN_FRAME_LONG_CHILD_RECV(obj->child, &obj->recv_buf[obj->recv_fwed], obj->recv_size, obj);
             if (forwarded_bytes < obj->recv_size) {
                 obj->recv_fwed += forwarded_bytes;
                 obj->recv_size -= forwarded_bytes;
@@ -218,11 +243,6 @@ static size_t isn_frame_long_recv(isn_layer_t *drv, const void *src, size_t size
         }
     }
 
-    // flush non-framed (packed) data immediately
-    if (obj->recv_size && obj->recv_len == 0) {
-        if (obj->other) obj->other->recv(obj->other, obj->recv_buf, obj->recv_size, caller);
-        obj->recv_size = 0;
-    }
     return size;
 }
 
@@ -238,9 +258,11 @@ void isn_frame_long_init(isn_frame_long_t *obj, isn_layer_t* child, isn_layer_t*
     obj->drv.free         = isn_frame_long_free;
 
     obj->parent           = parent;
+    obj->drv.memclass     = ((isn_driver_t *)parent)->memclass;    // passes the buffers of the parent through
     obj->child            = child;
     obj->other            = other;
     obj->frame_timeout    = timeout;
+    obj->adaptive         = NULL;
 
     obj->state            = IS_NONE;
     obj->recv_size        = 0;
@@ -248,8 +270,13 @@ void isn_frame_long_init(isn_frame_long_t *obj, isn_layer_t* child, isn_layer_t*
     obj->last_ts          = 0;
 }
 
+void isn_frame_long_setadaptive(isn_frame_long_t *obj, isn_timeout_t *adaptive) {
+    obj->adaptive = adaptive;
+    if (adaptive) obj->frame_timeout = isn_timeout_get(adaptive);
+}
+
 isn_frame_long_t* isn_frame_long_create() {
-    isn_frame_long_t* obj = malloc(sizeof(isn_frame_long_t));
+    isn_frame_long_t* obj = calloc(1, sizeof(isn_frame_long_t));
     return obj;
 }
 
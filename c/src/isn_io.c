@@ -29,7 +29,7 @@ int isn_write_atleast(isn_layer_t *layer, const void *src, size_t size, size_t m
     int avail = drv->getsendbuf(drv, &buf, size, drv);
     if (buf) {
         if (avail >= (int)minsize) {
-            isn_memcpy(buf, src, avail);
+            isn_memcpy_class(isn_memclass(drv), buf, src, avail);
             return drv->send(drv, buf, avail);
         }
         drv->free(drv, buf);
@@ -0,0 +1,169 @@
+/** \file
+ *  \brief ISN Metrics Registry Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_metrics.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_Metrics
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "isn_metrics.h"
+
+/**\{ */
+
+#define STATS_ENTRIES   3   ///< see ISN_DRIVER_STATS_DESC
+
+static isn_metrics_t *registries;
+
+static uint8_t metric_entries(const isn_metric_t *m) {
+    return m->entries ? m->count : STATS_ENTRIES;
+}
+
+/** Maps the message number back to the metric, as handlers are only given the message layer,
+ *  which may also be initialized with the generated table as descriptors, see isn_msg_init_desc() */
+static isn_metric_t *find_metric(const isn_message_t *msg, int32_t msgnum) {
+    for (isn_metrics_t *obj = registries; obj; obj = obj->next) {
+        if ((const isn_msg_desc_t *)obj->table != msg->isn_msg_desc || msgnum < obj->first || msgnum >= obj->last) continue;
+        uint8_t pos = obj->first;
+        for (uint8_t i=0; i<obj->count; i++) {
+            if (msgnum == pos) return &obj->metrics[i];
+            pos += metric_entries(&obj->metrics[i]);
+        }
+    }
+    return NULL;
+}
+
+/** Common handler of all driver statistics */
+static void *stats_cb(const void *arg) {
+    isn_metric_t *m = find_metric(isn_msg_self, isn_msg_self->handler_msgnum);
+    if (!m) return NULL;
+    if (arg) isn_memcpy(m->stats, arg, sizeof(isn_driver_stats_t));     // host may reset counters
+    return m->stats;
+}
+
+void isn_metrics_init(isn_metrics_t *obj, isn_metric_t *metrics, uint8_t size) {
+    ASSERT(obj);
+    ASSERT(metrics);
+    obj->metrics = metrics;
+    obj->size    = size;
+    obj->count   = 0;
+    obj->table   = NULL;
+    obj->first   = obj->last = 0;
+    obj->msg     = NULL;
+    obj->period  = 0;
+    obj->last_ts = 0;
+    obj->queued  = 0;
+}
+
+int isn_metrics_add_stats(isn_metrics_t *obj, const char *label, isn_driver_stats_t *stats) {
+    ASSERT(stats);
+    if (obj->count >= obj->size) return -1;
+    isn_metric_t *m = &obj->metrics[obj->count++];
+    m->entries = NULL;
+    m->count   = STATS_ENTRIES;
+    m->stats   = stats;
+    snprintf(m->desc, sizeof(m->desc), "%s%s", label ? label : "", ISN_DRIVER_STATS_DESC_RX);
+    return 0;
+}
+
+int isn_metrics_add(isn_metrics_t *obj, const isn_msg_table_t *entries, uint8_t count) {
+    ASSERT(entries);
+    if (obj->count >= obj->size) return -1;
+    isn_metric_t *m = &obj->metrics[obj->count++];
+    m->entries = entries;
+    m->count   = count;
+    m->stats   = NULL;
+    m->desc[0] = 0;
+    return 0;
+}
+
+uint8_t isn_metrics_entries(const isn_metrics_t *obj) {
+    uint8_t n = 0;
+    for (uint8_t i=0; i<obj->count; i++) n += metric_entries(&obj->metrics[i]);
+    return n;
+}
+
+uint8_t isn_metrics_generate(isn_metrics_t *obj, isn_msg_table_t *table, uint8_t first, uint8_t size) {
+    ASSERT(table);
+    int end = first + isn_metrics_entries(obj);
+    if (end >= size || end > ISN_MSG_NUM_LAST) return 0;
+
+    uint8_t pos = first;
+    for (uint8_t i=0; i<obj->count; i++) {
+        isn_metric_t *m = &obj->metrics[i];
+        if (m->entries) {
+            for (uint8_t j=0; j<m->count; j++) table[pos++] = m->entries[j];
+        }
+        else {
+            table[pos++] = (isn_msg_table_t){0, sizeof(isn_driver_stats_t), stats_cb, m->desc};
+            table[pos++] = (isn_msg_table_t){0, 0, NULL, ISN_DRIVER_STATS_DESC_RXTX, ISN_MSG_DESC_LEN(ISN_DRIVER_STATS_DESC_RXTX)};
+            table[pos++] = (isn_msg_table_t){0, 0, NULL, ISN_DRIVER_STATS_DESC_TX, ISN_MSG_DESC_LEN(ISN_DRIVER_STATS_DESC_TX)};
+        }
+    }
+    table[pos++] = (isn_msg_table_t)ISN_MSG_DESC_END(0);
+
+    obj->table = table;
+    obj->first = first;
+    obj->last  = end;
+
+    isn_metrics_t **r = &registries;
+    while (*r && *r != obj) r = &(*r)->next;
+    if (!*r) {
+        obj->next = NULL;
+        *r = obj;
+    }
+    return pos;
+}
+
+void isn_metrics_post(isn_metrics_t *obj) {
+    if (!obj->msg) return;
+    for (uint8_t msgnum = obj->first; msgnum < obj->last; msgnum++) {
+        if (obj->table[msgnum].size) isn_msg_post(obj->msg, msgnum, ISN_MSG_PRI_LOW);
+    }
+}
+
+/** Reactor tasklet, re-queues itself with the fixed period to avoid drift */
+static void *stream_event(void *arg) {
+    isn_metrics_t *obj = (isn_metrics_t *)arg;
+    if (obj->period && obj->msg && obj->msg->queue) {
+        isn_metrics_post(obj);
+        obj->last_ts += obj->period;
+        obj->queued = obj->msg->queue(stream_event, obj, obj->last_ts + obj->period, 0) >= 0;
+    }
+    else obj->queued = 0;
+    return NULL;
+}
+
+void isn_metrics_stream(isn_metrics_t *obj, isn_message_t *msg, isn_clock_counter_t period) {
+    ASSERT(msg);
+    ASSERT(msg->isn_msg_desc == (const isn_msg_desc_t *)obj->table);
+    obj->msg     = msg;
+    obj->period  = period;
+    obj->last_ts = isn_clock_now();
+    if (period && !obj->queued && msg->queue) {    // one pending is kept when stopped, and continues on restart
+        obj->queued = msg->queue(stream_event, obj, obj->last_ts + period, 0) >= 0;
+    }
+}
+
+int isn_metrics_sched(isn_metrics_t *obj) {
+    if (obj->period && isn_clock_elapsed(obj->last_ts) >= (int32_t)obj->period) {
+        obj->last_ts += obj->period;
+        if (isn_clock_elapsed(obj->last_ts) >= (int32_t)obj->period) obj->last_ts = isn_clock_now();   // missed periods are not repeated
+        isn_metrics_post(obj);
+        return 1;
+    }
+    return 0;
+}
+
+/** \} \endcond */
@@ -19,6 +19,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include "isn_msg.h"
+#include "isn_static.h"
+
+#ifndef ISN_MSG_PARENT_GETSENDBUF
+# define ISN_MSG_PARENT_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_MSG_PARENT_SEND
+# define ISN_MSG_PARENT_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_MSG_PARENT_FREE
+# define ISN_MSG_PARENT_FREE ISN_DYNAMIC_FREE
+#endif
 
 isn_message_t *isn_msg_self;
 
@@ -31,47 +42,128 @@ int isn_reactor_mutex_unlock(isn_reactor_mutex_t mutex_bits) __attribute__ ((wea
 
 /**\{ */
 
+/** Complete and send the reserved buffer, data may already be in place */
+static int send_buf(isn_message_t *obj, uint8_t *buf, uint8_t msgflags, const void* data, isn_msg_size_t size) {
+    *buf     = ISN_PROTO_MSG;
+    *(buf+1) = msgflags;
+    if (data != buf+2) isn_memcpy_class(isn_memclass(obj->parent_driver), buf+2, data, size);
+    ISN_MSG_PARENT_SEND(obj->parent_driver, buf, size + 2);
+    obj->drv.stats.tx_packets++;
+    obj->drv.stats.tx_counter+=size;
+    return size;
+}
+
 static int send_packet(isn_message_t *obj, uint8_t msgflags, const void* data, isn_msg_size_t size) {
     void *dest = NULL;
     int xsize = size + 2;
 
-    if (obj->parent_driver->getsendbuf(obj->parent_driver, &dest, xsize, (isn_layer_t *)obj) == xsize) {
-        uint8_t *buf = dest;
-        *buf     = ISN_PROTO_MSG;
-        *(buf+1) = msgflags;
-        isn_memcpy(buf+2, data, size);
-        obj->parent_driver->send(obj->parent_driver, buf, xsize);
-        obj->drv.stats.tx_packets++;
-        obj->drv.stats.tx_counter+=size;
-        return size;
+    if (ISN_MSG_PARENT_GETSENDBUF(obj->parent_driver, &dest, xsize, (isn_layer_t *)obj) == xsize) {
+        return send_buf(obj, dest, msgflags, data, size);
     }
     else if (dest) {
-        obj->parent_driver->free(obj->parent_driver, dest);
+        ISN_MSG_PARENT_FREE(obj->parent_driver, dest);
     }
     obj->drv.stats.tx_dropped++;
     return 0;
 }
 
-/** Send next message in a round-robin way */
+/** Encode the descriptor into the cache \returns the entry or NULL if it does not fit the cache or a frame */
+static const isn_msg_cache_entry_t *cache_get(isn_message_t *obj, uint8_t msgnum) {
+    isn_msg_cache_t *c = obj->cache;
+    if (msgnum >= c->count) return NULL;
+    isn_msg_cache_entry_t *e = &c->entries[msgnum];
+    if (!e->size) {
+        const isn_msg_desc_t *d = &obj->isn_msg_desc[msgnum];
+        size_t len = d->desc_len ? d->desc_len : strlen(d->desc);
+        if (len + 2 > c->encoder->max_payload) return NULL;
+        if ((size_t)c->used + c->encoder->overhead + len + 2 > c->size) return NULL;
+
+        uint8_t *frame = &c->buf[c->used];
+        uint8_t *payload = frame + c->encoder->header;
+        payload[0] = ISN_PROTO_MSG;
+        payload[1] = 0x80 | msgnum;
+        memcpy(payload + 2, d->desc, len);
+        e->offset  = c->used;
+        e->payload = len + 2;
+        e->size    = c->encoder->encode(c->frame, frame, len + 2);
+        c->used += e->size;
+    }
+    return e;
+}
+
+/** Hand over the encoded descriptor to the parent of the frame layer \returns 0 if not in the cache or not sent */
+static int send_cached(isn_message_t *obj, uint8_t msgnum) {
+    isn_msg_cache_t *c = obj->cache;
+    const isn_msg_cache_entry_t *e = cache_get(obj, msgnum);
+    if (!e) return 0;
+
+    void *dest = NULL;
+    if (ISN_DYNAMIC_GETSENDBUF(c->phy, &dest, e->size, (isn_layer_t *)obj) == e->size) {
+        isn_memcpy_class(isn_memclass(c->phy), dest, &c->buf[e->offset], e->size);
+        ISN_DYNAMIC_SEND(c->phy, dest, e->size);
+        isn_driver_t *frame = (isn_driver_t *)c->frame;     // account as if frame layer sent it
+        frame->stats.tx_packets++;
+        frame->stats.tx_counter += e->payload;
+        obj->drv.stats.tx_packets++;
+        obj->drv.stats.tx_counter += e->payload - 2;
+        return 1;
+    }
+    else if (dest) {
+        ISN_DYNAMIC_FREE(c->phy, dest);
+    }
+    return 0;   // sent as usual, or dropped there
+}
+
+/** Order of the sendable messages in the deadline mode: requested descriptors, the earliest deadline, the rest */
+static int deadline_before(isn_message_t *obj, uint8_t a, uint8_t b) {
+    int desc_a = ISN_MSG_PRIORITY(obj, a) == ISN_MSG_PRI_DESCRIPTION;
+    int desc_b = ISN_MSG_PRIORITY(obj, b) == ISN_MSG_PRI_DESCRIPTION;
+    if (desc_a != desc_b) return desc_a;
+    if (!obj->deadlines[a]) return 0;
+    if (!obj->deadlines[b]) return 1;
+    return isn_clock_diff(obj->deadlines[a], obj->deadlines[b]) < 0;
+}
+
+/** Account the message as sent, in time or late */
+static void deadline_done(isn_message_t *obj, uint8_t msgnum) {
+    if (obj->deadlines && obj->deadlines[msgnum]) {
+        if (isn_clock_remains(obj->deadlines[msgnum]) < 0) obj->deadlines_missed++;
+        else obj->deadlines_met++;
+        obj->deadlines[msgnum] = 0;
+    }
+}
+
+/** Send next message in a round-robin way, or the earliest deadline first */
 static int isn_msg_sendnext(isn_message_t *obj) {
-    isn_msg_table_t* picked = NULL;
+    const isn_msg_desc_t* picked = NULL;
+    volatile uint8_t* priority = NULL;
     uint8_t* data = NULL;
+    uint8_t best = 0xFF;
     obj->active = 0;
 
 	for (uint8_t i = 0; i < obj->isn_msg_table_size; obj->msgnum++, i++) {
 		if (obj->msgnum >= obj->isn_msg_table_size) obj->msgnum = 0;
-		if (obj->isn_msg_table[obj->msgnum].priority > 0) {
+		if (ISN_MSG_PRIORITY(obj, obj->msgnum) > 0) {
             obj->active++;
 
             // If it is locked in a query wait state then we want to unlock it (proceed) only if data is provided
             // Even if locked, keep through other messages to free input receive buffer
-            if ( (obj->isn_msg_table[obj->msgnum].priority != __ISN_MSG_PRI_QUERY_WAIT && !obj->lock) ||
+            if ( (ISN_MSG_PRIORITY(obj, obj->msgnum) != __ISN_MSG_PRI_QUERY_WAIT && !obj->lock) ||
                      obj->msgnum == obj->isn_msg_received_msgnum) {
-                picked = &obj->isn_msg_table[obj->msgnum];
-                break;
+                // Received input is served first to free the receive buffer
+                if (!obj->deadlines || obj->msgnum == obj->isn_msg_received_msgnum) {
+                    best = obj->msgnum;
+                    break;
+                }
+                if (best == 0xFF || deadline_before(obj, obj->msgnum, best)) best = obj->msgnum;
             }
 		}
 	}
+    if (best != 0xFF) {
+        obj->msgnum = best;
+        picked = &obj->isn_msg_desc[best];
+        priority = &ISN_MSG_PRIORITY(obj, best);
+    }
     // Reset availability of tx buffer for given argument size, indeed we should also test
     // for desc loading, however this goes typically one after another
     if (picked) {
@@ -81,46 +173,50 @@ static int isn_msg_sendnext(isn_message_t *obj) {
          * The extra 2 is for the protocol, see send_packet()
          */
         size_t required_size;
-             if (picked->priority >= ISN_MSG_PRI_DESCRIPTIONLOW) required_size = strlen(picked->desc) + 2;
-        else if (picked->priority == ISN_MSG_PRI_QUERY_ARGS)     required_size = 2;
+             if (*priority >= ISN_MSG_PRI_DESCRIPTIONLOW) required_size = (picked->desc_len ? picked->desc_len : strlen(picked->desc)) + 2;
+        else if (*priority == ISN_MSG_PRI_QUERY_ARGS)     required_size = 2;
         else                                                     required_size = picked->size + 2;
 
-        if (obj->parent_driver->getsendbuf(obj->parent_driver, NULL, required_size, (isn_layer_t *)obj) == required_size) {
+        if (ISN_MSG_PARENT_GETSENDBUF(obj->parent_driver, NULL, required_size, (isn_layer_t *)obj) == required_size) {
             isn_msg_self = obj;
 
             // Set and release locks
             if (obj->isn_msg_received_msgnum == obj->lock) obj->lock = 0;
-            else if (picked->priority == ISN_MGG_PRI_UPDATE_ARGS
+            else if (*priority == ISN_MGG_PRI_UPDATE_ARGS
 #if CONFIG_ISN_MSG_SINGLE_QUERY > 0
-                  || picked->priority == ISN_MSG_PRI_QUERY_ARGS
+                  || *priority == ISN_MSG_PRI_QUERY_ARGS
 #endif
                                                                  ) {
                 obj->lock = obj->msgnum;
-                obj->lock_priority = picked->priority;
+                obj->lock_priority = *priority;
                 obj->resend_timer = 0;
             }
 
-            if (picked->priority >= ISN_MSG_PRI_DESCRIPTIONLOW) {
-                send_packet(obj, (uint8_t)0x80 | obj->msgnum, picked->desc, required_size - 2 /*header*/);
-                picked->priority = (obj->msgnum == obj->isn_msg_received_msgnum) ? ISN_MSG_PRI_HIGHEST : ISN_MSG_PRI_LOW;
+            if (*priority >= ISN_MSG_PRI_DESCRIPTIONLOW) {
+                if (!obj->cache || !send_cached(obj, obj->msgnum)) {
+                    send_packet(obj, (uint8_t)0x80 | obj->msgnum, picked->desc, required_size - 2 /*header*/);
+                }
+                *priority = (obj->msgnum == obj->isn_msg_received_msgnum) ? ISN_MSG_PRI_HIGHEST : ISN_MSG_PRI_LOW;
             }
     #ifdef TODO_CLARIFY_WITH_IDM
             // a message without args cannot be sent as args, but only desc (first if)
             else if (picked->size == 0) {
-                picked->priority = ISN_MSG_PRI_CLEAR;
+                *priority = ISN_MSG_PRI_CLEAR;
                 obj->drv.stats.tx_dropped++;
             }
     #endif
             // Note that the message we're asking for is just arriving, and for messages without
             // any handler, we reply back with query, but we do not block the message.
-            else if (picked->handler == NULL || (picked->priority == ISN_MSG_PRI_QUERY_ARGS && obj->msgnum != obj->isn_msg_received_msgnum)) {
+            else if (picked->handler == NULL || (*priority == ISN_MSG_PRI_QUERY_ARGS && obj->msgnum != obj->isn_msg_received_msgnum)) {
                 send_packet(obj, obj->msgnum, NULL, 0);
-                picked->priority = picked->handler ? __ISN_MSG_PRI_QUERY_WAIT : ISN_MSG_PRI_CLEAR;
-                if (picked->priority == __ISN_MSG_PRI_QUERY_WAIT) obj->resend_timer = 0;
+                *priority = picked->handler ? __ISN_MSG_PRI_QUERY_WAIT : ISN_MSG_PRI_CLEAR;
+                if (*priority == __ISN_MSG_PRI_QUERY_WAIT) obj->resend_timer = 0;
+                deadline_done(obj, obj->msgnum);
             }
             else {
-                obj->handler_priority = picked->priority;
-                picked->priority = ISN_MSG_PRI_CLEAR;
+                obj->handler_priority = *priority;
+                *priority = ISN_MSG_PRI_CLEAR;
+                deadline_done(obj, obj->msgnum);
                 if (picked->handler) {
                     obj->handler_msgnum = obj->msgnum;
                     if (obj->msgnum == obj->isn_msg_received_msgnum) {
@@ -134,12 +230,17 @@ static int isn_msg_sendnext(isn_message_t *obj) {
                         data = (uint8_t *)picked->handler(NULL);
                     }
                     obj->handler_msgnum = -1;
-                    if (data == NULL) {
-                        return 1;
-                    }
+                    uint8_t *out = obj->handler_output;             // reserved by the isn_msg_getoutbuf()
+                    obj->handler_output = NULL;
                     // Do not reply back if request for data was done from our side, to avoid ping-ponging
                     // Handle also the case of just-arriving QUERY_ARGS message whch is not yet in _WAIT state.
-                    if (obj->handler_priority != __ISN_MSG_PRI_QUERY_WAIT && obj->handler_priority != ISN_MSG_PRI_QUERY_ARGS) {
+                    if (data == NULL || obj->handler_priority == __ISN_MSG_PRI_QUERY_WAIT || obj->handler_priority == ISN_MSG_PRI_QUERY_ARGS) {
+                        if (out) ISN_MSG_PARENT_FREE(obj->parent_driver, out - 2);
+                    }
+                    else if (out) {
+                        send_buf(obj, out - 2, obj->msgnum, data, picked->size);
+                    }
+                    else {
                         send_packet(obj, obj->msgnum, data, picked->size);
                     }
                 }
@@ -150,6 +251,26 @@ static int isn_msg_sendnext(isn_message_t *obj) {
     return 0;
 }
 
+void *isn_msg_getoutbuf(isn_message_t *obj) {
+    if (obj->handler_msgnum < 0 || obj->handler_priority == __ISN_MSG_PRI_QUERY_WAIT || obj->handler_priority == ISN_MSG_PRI_QUERY_ARGS) {
+        return NULL;    // outside of handler, or no reply will be sent
+    }
+    if (obj->txn && obj->txn->calling) {
+        return NULL;    // within a transaction, replied as one
+    }
+    if (!obj->handler_output) {
+        void *dest = NULL;
+        int xsize = obj->isn_msg_desc[obj->handler_msgnum].size + 2;
+        if (ISN_MSG_PARENT_GETSENDBUF(obj->parent_driver, &dest, xsize, (isn_layer_t *)obj) == xsize) {
+            obj->handler_output = (uint8_t *)dest + 2;
+        }
+        else if (dest) {
+            ISN_MSG_PARENT_FREE(obj->parent_driver, dest);
+        }
+    }
+    return obj->handler_output;
+}
+
 int isn_msg_isinput_valid(isn_message_t *obj, const void *arg) {
     return (arg == obj->handler_input) && arg;
 }
@@ -169,36 +290,63 @@ static void emit(isn_message_t *obj) {
     }
 }
 
-void isn_msg_post(isn_message_t *obj, uint8_t message_id, uint8_t priority) {
+/** Post with the deadline, or 0 if none; the earlier deadline is kept */
+static void post(isn_message_t *obj, uint8_t message_id, uint8_t priority, isn_clock_counter_t deadline) {
     // Ignore out-of-table requests; \todo we need to add query for LAST
     if (message_id >= obj->isn_msg_table_size) return;
 
-    uint8_t priority_old = obj->isn_msg_table[message_id].priority;
+    uint8_t priority_old = ISN_MSG_PRIORITY(obj, message_id);
     uint8_t s = CyEnterCriticalSection();
     if (priority == ISN_MSG_PRI_CLEAR) {
-        obj->isn_msg_table[message_id].priority = priority;
+        ISN_MSG_PRIORITY(obj, message_id) = priority;
+        if (obj->deadlines) obj->deadlines[message_id] = 0;
     }
     // Ignore zero-arg messages as these can appear as queries to the IDM, but allow desc
-    else if (obj->isn_msg_table[message_id].size || priority >= ISN_MSG_PRI_DESCRIPTIONLOW) {
-        if (obj->isn_msg_table[message_id].priority < priority) obj->isn_msg_table[message_id].priority = priority;
+    else if (obj->isn_msg_desc[message_id].size || priority >= ISN_MSG_PRI_DESCRIPTIONLOW) {
+        if (ISN_MSG_PRIORITY(obj, message_id) < priority) ISN_MSG_PRIORITY(obj, message_id) = priority;
+        if (deadline && obj->deadlines) {
+            isn_clock_counter_t *d = &obj->deadlines[message_id];
+            if (!*d || isn_clock_diff(deadline, *d) < 0) *d = deadline;
+        }
         emit(obj);
     }
     CyExitCriticalSection(s);
 
-    if (priority_old != obj->isn_msg_table[message_id].priority && obj->dup && priority <= ISN_MSG_PRI_HIGHEST) {
+    if (priority_old != ISN_MSG_PRIORITY(obj, message_id) && obj->dup && priority <= ISN_MSG_PRI_HIGHEST) {
         isn_msg_post(obj->dup, message_id, priority);
     }
 }
 
+void isn_msg_post(isn_message_t *obj, uint8_t message_id, uint8_t priority) {
+    post(obj, message_id, priority, 0);
+}
+
+void isn_msg_post_until(isn_message_t *obj, uint8_t message_id, uint8_t priority, isn_clock_counter_t deadline) {
+    post(obj, message_id, priority, deadline ? deadline : 1);
+}
+
 void isn_msg_send(isn_message_t *obj, uint8_t message_id, uint8_t priority) {
     if (obj->handler_msgnum != message_id) {         // Do not mark and trigger a message from which we're called
         isn_msg_post(obj, message_id, priority);
     }
 }
 
+void isn_msg_send_within(isn_message_t *obj, uint8_t message_id, uint8_t priority, isn_clock_counter_t max_age) {
+    if (obj->handler_msgnum != message_id) {
+        isn_msg_post_until(obj, message_id, priority, ISN_CLOCK_NOW + max_age);
+    }
+}
+
+void isn_msg_setdeadlines(isn_message_t *obj, isn_clock_counter_t *deadlines) {
+    if (deadlines) memset(deadlines, 0, obj->isn_msg_table_size * sizeof(isn_clock_counter_t));
+    obj->deadlines = deadlines;
+    obj->deadlines_met = 0;
+    obj->deadlines_missed = 0;
+}
+
 uint8_t isn_msg_sendqby(isn_message_t *obj, isn_events_handler_t hnd, uint8_t priority, uint8_t msgnum) {
 	for (; msgnum < obj->isn_msg_table_size; msgnum++) {
-        if (obj->isn_msg_table[msgnum].handler == hnd) {
+        if (obj->isn_msg_desc[msgnum].handler == hnd) {
             isn_msg_send(obj, msgnum, priority);
             return msgnum;
         }
@@ -212,25 +360,25 @@ uint8_t isn_msg_resend_queries(isn_message_t *obj, uint32_t timeout) {
     if (obj->resend_timer > timeout) {
         /* Convert lock into a new pending message */
         if (obj->lock) {
-            obj->isn_msg_table[obj->lock].priority = obj->lock_priority;
+            ISN_MSG_PRIORITY(obj, obj->lock) = obj->lock_priority;
             obj->lock = 0;
         }
         /* Check all messages with QUERY_WAIT as well as UPDATE_ARGS to schedule retries */
         for (uint8_t msgnum = 0; msgnum < obj->isn_msg_table_size; msgnum++) {
-            if (obj->isn_msg_table[msgnum].priority == __ISN_MSG_PRI_QUERY_WAIT) {
-                obj->isn_msg_table[msgnum].priority = ISN_MSG_PRI_QUERY_ARGS;
+            if (ISN_MSG_PRIORITY(obj, msgnum) == __ISN_MSG_PRI_QUERY_WAIT) {
+                ISN_MSG_PRIORITY(obj, msgnum) = ISN_MSG_PRI_QUERY_ARGS;
                 count++;
                 obj->drv.stats.tx_retries++;
             }
             /* Theoretically this is not needed, however it is an additional protection to
                account this type of pending messages and to increase count and trigger
                pending state, which could be missed if lock was already 0 */
-            else if (obj->isn_msg_table[msgnum].priority == ISN_MGG_PRI_UPDATE_ARGS) {
+            else if (ISN_MSG_PRIORITY(obj, msgnum) == ISN_MGG_PRI_UPDATE_ARGS) {
                 count++;
                 obj->drv.stats.tx_retries++;
             }
             /* Theoretically this should not be needed but fixes stalled state machine */
-            else if (obj->isn_msg_table[msgnum].priority) {
+            else if (ISN_MSG_PRIORITY(obj, msgnum)) {
                 count++;
             }
         }
@@ -245,10 +393,11 @@ uint8_t isn_msg_resend_queries(isn_message_t *obj, uint32_t timeout) {
 int isn_msg_discardpending(isn_message_t *obj) {
     uint8_t count = 0;
     for (uint8_t msgnum = 0; msgnum < obj->isn_msg_table_size; msgnum++) {
-        if (obj->isn_msg_table[msgnum].priority > ISN_MSG_PRI_CLEAR) {
-            obj->isn_msg_table[msgnum].priority = ISN_MSG_PRI_CLEAR;
+        if (ISN_MSG_PRIORITY(obj, msgnum) > ISN_MSG_PRI_CLEAR) {
+            ISN_MSG_PRIORITY(obj, msgnum) = ISN_MSG_PRI_CLEAR;
             count++;
         }
+        if (obj->deadlines) obj->deadlines[msgnum] = 0;
     }
     obj->active = 0;
     obj->lock = 0;
@@ -290,7 +439,7 @@ static size_t isn_message_recv(isn_layer_t *drv, const void *src, size_t size, i
         // we cannot handle multiple requests currently so we retry next time
         // if data size does not match, drop complete message
         if (obj->isn_msg_received_data != NULL) return 0;
-        if (data_size != obj->isn_msg_table[msgnum].size) {
+        if (data_size != obj->isn_msg_desc[msgnum].size) {
             obj->drv.stats.rx_dropped++;
             return size;
         }
@@ -298,10 +447,10 @@ static size_t isn_message_recv(isn_layer_t *drv, const void *src, size_t size, i
     /* Discard data if another UPDATE ARGS for the same message is already in progress,
      * which eliminates inter-mediate receieve callbacks
      */
-    if (obj->isn_msg_table[msgnum].priority != ISN_MGG_PRI_UPDATE_ARGS ) {
+    if (ISN_MSG_PRIORITY(obj, msgnum) != ISN_MGG_PRI_UPDATE_ARGS ) {
         if (data_size > 0) {
             ASSERT(data_size <= RECV_MESSAGE_SIZE);
-            isn_memcpy(obj->message_buffer, buf+2, data_size);   // copy recv data into a receive buffer to be handled by sched
+            isn_memcpy_class(isn_memclass(caller), obj->message_buffer, buf+2, data_size);   // copy recv data of the caller into a receive buffer to be handled by sched
             obj->isn_msg_received_data = obj->message_buffer;
             obj->isn_msg_received_msgnum = msgnum;
             isn_reactor_mutex_lock(obj->busy_mutex);        // buffer full we cannot accept new requests
@@ -322,7 +471,7 @@ static size_t isn_message_recv(isn_layer_t *drv, const void *src, size_t size, i
 
 int isn_msg_sched(isn_message_t *obj) {
     if (obj->pending) {
-        if (obj->parent_driver->getsendbuf(obj->parent_driver, NULL, 2, (isn_layer_t *)obj) > 0) {    // Test if we have at least space for 2 bytes to send?
+        if (ISN_MSG_PARENT_GETSENDBUF(obj->parent_driver, NULL, 2, (isn_layer_t *)obj) > 0) {    // Test if we have at least space for 2 bytes to send?
             obj->pending = isn_msg_sendnext(obj);
         }
     }
@@ -334,11 +483,13 @@ int isn_msg_sched(isn_message_t *obj) {
  *   as zero payload means query
  */
 static void sanity_check(isn_message_t *obj) {
+#if CONFIG_ISN_MSG_SANITY_CHECK > 0
 	for (uint8_t i = 0; i < obj->isn_msg_table_size; i++) {
-		if (obj->isn_msg_table[i].priority > ISN_MSG_PRI_CLEAR && obj->isn_msg_table[i].size == 0) {
-            obj->isn_msg_table[i].priority = ISN_MSG_PRI_CLEAR;
+		if (ISN_MSG_PRIORITY(obj, i) > ISN_MSG_PRI_CLEAR && obj->isn_msg_desc[i].size == 0) {
+            ISN_MSG_PRIORITY(obj, i) = ISN_MSG_PRI_CLEAR;
         }
     }
+#endif
 }
 
 void isn_msg_radiate(isn_message_t *obj, isn_reactor_queue_t priority_queue, isn_reactor_mutex_t busy_mutex, isn_reactor_mutex_t holdon_mutex) {
@@ -349,19 +500,24 @@ void isn_msg_radiate(isn_message_t *obj, isn_reactor_queue_t priority_queue, isn
     emit(obj);
 }
 
-void isn_msg_init(isn_message_t *obj, isn_msg_table_t* messages, uint8_t size, isn_layer_t* parent) {
-    ASSERT(obj);
-    ASSERT(messages);
-    ASSERT(parent);
+/* Legacy table is accessed thru the descriptors, and priorities with the stride */
+CASSERT(sizeof(isn_msg_table_t) == sizeof(isn_msg_desc_t), isn_msg_c)
+CASSERT(offsetof(isn_msg_table_t, size) == offsetof(isn_msg_desc_t, size), isn_msg_c)
+CASSERT(offsetof(isn_msg_table_t, handler) == offsetof(isn_msg_desc_t, handler), isn_msg_c)
+CASSERT(offsetof(isn_msg_table_t, desc) == offsetof(isn_msg_desc_t, desc), isn_msg_c)
+CASSERT(offsetof(isn_msg_table_t, desc_len) == offsetof(isn_msg_desc_t, desc_len), isn_msg_c)
+CASSERT(ISN_MSG_TXN_SIZE <= RECV_MESSAGE_SIZE, isn_msg_c)
+
+static void init(isn_message_t *obj, uint8_t size, isn_layer_t* parent) {
     memset(&obj->drv, 0, sizeof(obj->drv));
     obj->drv.recv = isn_message_recv;
     obj->parent_driver = parent;
-    obj->isn_msg_table = messages;
     obj->isn_msg_table_size = size;
     obj->isn_msg_received_msgnum = 0xFF;
     obj->isn_msg_received_data = NULL;
     obj->handler_input = NULL;
     obj->handler_msgnum = -1;
+    obj->handler_output = NULL;
     obj->handler_priority = 0;
     obj->pending = 1;
     obj->active = 0;
@@ -370,12 +526,68 @@ void isn_msg_init(isn_message_t *obj, isn_msg_table_t* messages, uint8_t size, i
     obj->resend_timer = 0;
     obj->queue = NULL;  // By default reactor is not enabled and priority queue is to be set by user
     obj->dup = NULL;
+    obj->cache = NULL;
+    obj->deadlines = NULL;
+    obj->deadlines_met = 0;
+    obj->deadlines_missed = 0;
+    obj->txn = NULL;
     isn_msg_self = obj;
     sanity_check(obj);
 }
 
+void isn_msg_init(isn_message_t *obj, isn_msg_table_t* messages, uint8_t size, isn_layer_t* parent) {
+    ASSERT(obj);
+    ASSERT(messages);
+    ASSERT(parent);
+    obj->isn_msg_table = messages;
+    obj->isn_msg_desc = (const isn_msg_desc_t *)messages;
+    obj->priorities = &messages[0].priority;
+    obj->priorities_stride = sizeof(isn_msg_table_t);
+    init(obj, size, parent);
+}
+
+void isn_msg_init_desc(isn_message_t *obj, const isn_msg_desc_t *descs, uint8_t *priorities, uint8_t size, isn_layer_t* parent) {
+    ASSERT(obj);
+    ASSERT(descs);
+    ASSERT(priorities);
+    ASSERT(parent);
+    for (uint8_t i = 0; i < size; i++) priorities[i] = descs[i].priority;
+    obj->isn_msg_table = NULL;
+    obj->isn_msg_desc = descs;
+    obj->priorities = priorities;
+    obj->priorities_stride = 1;
+    init(obj, size, parent);
+}
+
+void isn_msg_cache_init(isn_msg_cache_t *cache, const isn_encoder_t *encoder, isn_layer_t *frame, isn_layer_t *phy,
+                        isn_msg_cache_entry_t *entries, uint8_t count, void *buf, size_t size) {
+    ASSERT(cache);
+    ASSERT(encoder);
+    ASSERT(frame);
+    ASSERT(phy);
+    ASSERT(entries);
+    ASSERT(size <= UINT16_MAX);
+    memset(entries, 0, count * sizeof(isn_msg_cache_entry_t));
+    cache->encoder = encoder;
+    cache->frame   = frame;
+    cache->phy     = phy;
+    cache->entries = entries;
+    cache->count   = count;
+    cache->buf     = buf;
+    cache->size    = (uint16_t)size;
+    cache->used    = 0;
+}
+
+int isn_msg_cache_build(isn_message_t *obj) {
+    int count = 0;
+    if (obj->cache) {
+        for (uint8_t i = 0; i < obj->isn_msg_table_size; i++) count += (cache_get(obj, i) != NULL);
+    }
+    return count;
+}
+
 isn_message_t* isn_msg_create() {
-    isn_message_t* obj = malloc(sizeof(isn_message_t));
+    isn_message_t* obj = calloc(1, sizeof(isn_message_t));
     return obj;
 }
 
@@ -383,6 +595,115 @@ void isn_msg_drop(isn_message_t *obj) {
     free(obj);
 }
 
+/** Call the handler of a record on behalf of the transaction \returns its output, or NULL */
+static const void *txn_call(isn_message_t *obj, uint8_t msgnum, const void *data) {
+    int32_t handler_msgnum = obj->handler_msgnum;
+    const void *handler_input = obj->handler_input;
+    obj->handler_msgnum = msgnum;
+    obj->handler_input = data;
+    obj->txn->calling = 1;
+    const void *out = obj->isn_msg_desc[msgnum].handler(data);
+    obj->txn->calling = 0;
+    obj->handler_msgnum = handler_msgnum;
+    obj->handler_input = handler_input;
+    return out;
+}
+
+/** Check the records \returns their count, or -1 if any is malformed */
+static int txn_check(isn_message_t *obj, const uint8_t *records) {
+    int count = 0;
+    for (size_t pos = 0; pos < ISN_MSG_TXN_SIZE && records[pos]; count++) {
+        uint8_t msgnum = records[pos];
+        if (msgnum >= obj->isn_msg_table_size || msgnum == obj->txn->msgnum) return -1;
+        const isn_msg_desc_t *d = &obj->isn_msg_desc[msgnum];
+        if (!d->size || !d->handler || pos + 1 + d->size > ISN_MSG_TXN_SIZE) return -1;
+        pos += 1 + d->size;
+    }
+    return count;
+}
+
+void *isn_msg_txn_cb(const void *data) {
+    isn_message_t *obj = isn_msg_self;
+    isn_msg_txn_t *txn = obj->txn;
+    ASSERT(txn);
+    if (!data) return txn->buf;                     // the committed, or the last replied records
+
+    const uint8_t *records = data;
+    if (txn->requester && txn->state == ISN_MSG_TXN_PENDING) {     // confirmation, propagated to the handlers without a reply
+        if (txn_check(obj, records) > 0) {
+            memcpy(txn->buf, records, ISN_MSG_TXN_SIZE);
+            for (size_t pos = 0; pos < ISN_MSG_TXN_SIZE && txn->buf[pos]; pos += 1 + obj->isn_msg_desc[txn->buf[pos]].size) {
+                txn_call(obj, txn->buf[pos], &txn->buf[pos + 1]);
+            }
+            txn->state = ISN_MSG_TXN_APPLIED;
+        }
+        else txn->state = ISN_MSG_TXN_REJECTED;
+        txn->requester = 0;
+        txn->confirmed = 1;
+        return NULL;
+    }
+    /* Late duplicates of the confirmation are ignored, as a request carries at least one record */
+    if (!records[0] || (txn->confirmed && !memcmp(records, txn->buf, ISN_MSG_TXN_SIZE))) return NULL;
+    txn->confirmed = 0;
+
+    /* Validate all, then apply all, and reply the records as applied, or none when rejected */
+    memset(txn->buf, 0, ISN_MSG_TXN_SIZE);
+    if (txn_check(obj, records) <= 0 || (txn->validate && !txn->validate(records))) {
+        txn->state = ISN_MSG_TXN_REJECTED;
+        return txn->buf;
+    }
+    for (size_t pos = 0; pos < ISN_MSG_TXN_SIZE && records[pos]; ) {
+        uint8_t msgnum = records[pos];
+        isn_msg_size_t size = obj->isn_msg_desc[msgnum].size;
+        const void *out = txn_call(obj, msgnum, &records[pos + 1]);
+        txn->buf[pos] = msgnum;
+        memcpy(&txn->buf[pos + 1], out ? out : &records[pos + 1], size);
+        pos += 1 + size;
+    }
+    txn->state = ISN_MSG_TXN_APPLIED;
+    return txn->buf;
+}
+
+void isn_msg_settxn(isn_message_t *obj, isn_msg_txn_t *txn, uint8_t msgnum, isn_events_handler_t validate) {
+    ASSERT(msgnum < obj->isn_msg_table_size);
+    ASSERT(obj->isn_msg_desc[msgnum].size == ISN_MSG_TXN_SIZE);
+    ASSERT(obj->isn_msg_desc[msgnum].handler == isn_msg_txn_cb);
+    memset(txn, 0, sizeof(isn_msg_txn_t));
+    txn->msgnum = msgnum;
+    txn->validate = validate;
+    obj->txn = txn;
+}
+
+int isn_msg_txn_begin(isn_message_t *obj) {
+    isn_msg_txn_t *txn = obj->txn;
+    if (!txn || txn->state == ISN_MSG_TXN_PENDING) return -1;
+    memset(txn->buf, 0, ISN_MSG_TXN_SIZE);
+    txn->used = 0;
+    txn->state = ISN_MSG_TXN_IDLE;
+    txn->requester = 1;
+    txn->confirmed = 0;
+    return 0;
+}
+
+int isn_msg_txn_add(isn_message_t *obj, uint8_t message_id, const void *data) {
+    isn_msg_txn_t *txn = obj->txn;
+    if (!txn || txn->state != ISN_MSG_TXN_IDLE || message_id == 0 || message_id >= obj->isn_msg_table_size || message_id == txn->msgnum) return -1;
+    const isn_msg_desc_t *d = &obj->isn_msg_desc[message_id];
+    if (!d->size || !d->handler || txn->used + 1 + d->size > ISN_MSG_TXN_SIZE) return -1;
+    txn->buf[txn->used] = message_id;
+    memcpy(&txn->buf[txn->used + 1], data, d->size);
+    txn->used += 1 + d->size;
+    return 0;
+}
+
+int isn_msg_txn_commit(isn_message_t *obj) {
+    isn_msg_txn_t *txn = obj->txn;
+    if (!txn || txn->state != ISN_MSG_TXN_IDLE || !txn->used) return -1;
+    txn->state = ISN_MSG_TXN_PENDING;
+    isn_msg_post(obj, txn->msgnum, ISN_MGG_PRI_UPDATE_ARGS);
+    return 0;
+}
+
 void isn_msg_setlogging(isn_logger_level_t level) {
     isn_logger_level = level;
 }
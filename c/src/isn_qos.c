@@ -0,0 +1,205 @@
+/** \file
+ *  \brief ISN Transmit QoS Scheduler Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_qos.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_QoS
+ *
+ * Only one buffer may be handed out at a time, as with most PHYs, either the
+ * parent buffer directly or a slot of the class queue. The parent buffer is
+ * given out only if nothing is queued, to retain the order of the packets.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "isn_qos.h"
+
+/**\{ */
+
+static isn_qos_class_t *find_class(isn_qos_t *obj, const isn_layer_t *caller) {
+    for (uint8_t i=0; i<obj->classes_size; i++) {
+        if (obj->classes[i].caller == caller || obj->classes[i].caller == NULL) return &obj->classes[i];
+    }
+    return NULL;
+}
+
+static int pick_strict(isn_qos_t *obj) {
+    int picked = -1;
+    for (uint8_t i=0; i<obj->classes_size; i++) {
+        if (obj->classes[i].count && (picked < 0 || obj->classes[i].priority > obj->classes[picked].priority)) {
+            picked = i;
+        }
+    }
+    return picked;
+}
+
+/** Deficit round-robin, one quantum is sufficient to send any packet, so one pass suffices */
+static int pick_weighted(isn_qos_t *obj) {
+    for (uint8_t i=0; i<=obj->classes_size; i++) {
+        isn_qos_class_t *c = &obj->classes[obj->rr];
+        if (c->count) {
+            uint16_t size = c->slots[c->rdi].size;
+            if (c->deficit >= size) return obj->rr;
+            if (!obj->rr_credited) {
+                c->deficit += (int32_t)(c->weight ? c->weight : 1) * CONFIG_ISN_QOS_QUANTUM;
+                obj->rr_credited = 1;
+                if (c->deficit >= size) return obj->rr;
+            }
+        }
+        else c->deficit = 0;
+        if (++obj->rr >= obj->classes_size) obj->rr = 0;
+        obj->rr_credited = 0;
+    }
+    return -1;
+}
+
+int isn_qos_flush(isn_qos_t *obj) {
+    while (obj->queued) {
+        int picked = (obj->policy == ISN_QOS_POLICY_WEIGHTED) ? pick_weighted(obj) : pick_strict(obj);
+        if (picked < 0) break;
+
+        isn_qos_class_t *c = &obj->classes[picked];
+        isn_qos_slot_t *slot = &c->slots[c->rdi];
+        void *buf = NULL;
+        if (obj->parent->getsendbuf(obj->parent, &buf, slot->size, c->caller) != slot->size) {
+            if (buf) obj->parent->free(obj->parent, buf);
+            c->stats.tx_retries++;
+            break;
+        }
+        isn_memcpy_class(isn_memclass(obj->parent), buf, slot->data, slot->size);
+        obj->parent->send(obj->parent, buf, slot->size);
+
+        c->deficit -= slot->size;
+        c->stats.tx_packets++;
+        c->stats.tx_counter += slot->size;
+        if (++c->rdi >= c->depth) c->rdi = 0;
+        c->count--;
+        obj->queued--;
+    }
+    return obj->queued;
+}
+
+static int isn_qos_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_qos_t *obj = (isn_qos_t *)drv;
+    isn_qos_class_t *c = find_class(obj, caller);
+
+    if (!c || (!obj->queued && !obj->direct)) {
+        int osize = obj->parent->getsendbuf(obj->parent, dest, size, caller);
+        if (dest && *dest) {
+            obj->direct = *dest;
+            obj->direct_class = c;
+            return osize;
+        }
+        if (!c || (!dest && osize >= 0)) return osize;
+    }
+    if (c->count < c->depth && !obj->alloc) {
+        if (size > CONFIG_ISN_QOS_SLOT_SIZE) size = CONFIG_ISN_QOS_SLOT_SIZE;
+        if (dest) {
+            *dest = c->slots[c->wri].data;
+            obj->alloc = c;
+        }
+        return size;
+    }
+    if (dest) {
+        *dest = NULL;
+        c->stats.tx_retries++;
+    }
+    return -1;
+}
+
+static void isn_qos_free(isn_layer_t *drv, const void *ptr) {
+    isn_qos_t *obj = (isn_qos_t *)drv;
+    if (ptr && ptr == obj->direct) {
+        obj->direct = NULL;
+        obj->parent->free(obj->parent, ptr);
+    }
+    else if (obj->alloc && ptr == obj->alloc->slots[obj->alloc->wri].data) {
+        obj->alloc = NULL;
+    }
+}
+
+static int isn_qos_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_qos_t *obj = (isn_qos_t *)drv;
+    obj->drv.stats.tx_packets++;
+    obj->drv.stats.tx_counter += size;
+
+    if (dest == obj->direct) {
+        obj->direct = NULL;
+        if (obj->direct_class) {
+            obj->direct_class->stats.tx_packets++;
+            obj->direct_class->stats.tx_counter += size;
+        }
+        int retval = obj->parent->send(obj->parent, dest, size);
+        isn_qos_flush(obj);     // packets may have been queued meanwhile
+        return retval;
+    }
+
+    isn_qos_class_t *c = obj->alloc;
+    ASSERT(c && dest == c->slots[c->wri].data);
+    ASSERT(size <= CONFIG_ISN_QOS_SLOT_SIZE);
+    c->slots[c->wri].size = size;
+    if (++c->wri >= c->depth) c->wri = 0;
+    c->count++;
+    obj->queued++;
+    obj->alloc = NULL;
+    isn_qos_flush(obj);
+    return size;
+}
+
+static size_t isn_qos_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    isn_qos_t *obj = (isn_qos_t *)drv;
+    if (obj->child) return obj->child->recv(obj->child, src, size, caller);
+    obj->drv.stats.rx_dropped++;
+    return size;
+}
+
+void isn_qos_init(isn_qos_t *obj, isn_qos_policy_t policy, isn_qos_class_t *classes, uint8_t classes_size,
+                  isn_layer_t* child, isn_layer_t* parent) {
+    ASSERT(obj);
+    ASSERT(classes);
+    ASSERT(parent);
+    memset(&obj->drv, 0, sizeof(obj->drv));
+    obj->drv.getsendbuf = isn_qos_getsendbuf;
+    obj->drv.send       = isn_qos_send;
+    obj->drv.recv       = isn_qos_recv;
+    obj->drv.free       = isn_qos_free;
+    obj->parent         = parent;
+    obj->drv.memclass   = ((isn_driver_t *)parent)->memclass;  // passes the buffers of the parent through
+    obj->child          = child;
+    obj->classes        = classes;
+    obj->classes_size   = classes_size;
+    obj->policy         = policy;
+    obj->queued         = 0;
+    obj->rr             = 0;
+    obj->rr_credited    = 0;
+    obj->alloc          = NULL;
+    obj->direct         = NULL;
+    obj->direct_class   = NULL;
+    for (uint8_t i=0; i<classes_size; i++) {
+        ASSERT(classes[i].slots && classes[i].depth);
+        classes[i].wri = classes[i].rdi = classes[i].count = 0;
+        classes[i].deficit = 0;
+        memset(&classes[i].stats, 0, sizeof(classes[i].stats));
+    }
+}
+
+isn_qos_t* isn_qos_create() {
+    isn_qos_t* obj = calloc(1, sizeof(isn_qos_t));
+    return obj;
+}
+
+void isn_qos_drop(isn_qos_t *obj) {
+    free(obj);
+}
+
+/** \} \endcond */
@@ -89,6 +89,11 @@
 #define QUEUE_MUTEX(i)              ((uint32_t)(queue_table[i].tasklet) & (MUTEX_MASK << MUTEX_SHIFT))
 #define QUEUE_FUNC_VALID(i)         (void *)((uint32_t)(queue_table[i].tasklet) & FUNC_ADDR_MASK)
 #define QUEUE_TIME(i)               queue_table[i].time
+#define QUEUE_FREE(i)               queue_table[i].gen++     ///< Invalidates all handles to the entry
+
+#define HANDLE_GEN_SHIFT            8
+#define HANDLE(i)                   (((int)queue_table[i].gen << HANDLE_GEN_SHIFT) | (i))
+#define HANDLE_INDEX(h)             ((h) & 0xFF)
 
 /**\{ */
 
@@ -103,7 +108,15 @@ static volatile uint32_t queue_changed = 0; ///< Non-zero if event queue loop sh
 
 uint32_t isn_tasklet_queue_size = 0;
 uint32_t isn_tasklet_queue_max = 0;
+uint32_t isn_tasklet_lateness_max = 0;
+uint32_t isn_tasklet_queue_capacity = 0;
 static int self_index = -1;
+static isn_argpool_t *argpool = NULL;
+
+/** Takes the place of a dropped tasklet, until the step unlinks the entry */
+static void *dropped_tasklet(void *arg) {
+    return NULL;
+}
 
 typedef uint8_t critical_section_state_t;
 
@@ -136,14 +149,17 @@ void isn_reactor_initchannel(isn_tasklet_queue_t *queue, isn_tasklet_entry_t* fi
     }
 }
 
-int isn_reactor_channel_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed) {
+static int channel_push(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+                        isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                        void* arg, void *pooled, isn_clock_counter_t timed) {
     size_t next = (queue->wri+1) & queue->size_mask;
     if (queue->rdi != next) {
         isn_tasklet_entry_t *e = &queue->fifo[queue->wri];
         e->tasklet = tasklet;
-        e->caller = NULL;
-        e->caller_queue = NULL;
+        e->caller = caller;
+        e->caller_queue = caller_queue;
         e->arg = arg;
+        e->pooled = pooled;
         e->time = timed;
         __DSB();
         queue->wri = next;
@@ -153,40 +169,18 @@ int isn_reactor_channel_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet
     return -1;
 }
 
+int isn_reactor_channel_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed) {
+    return channel_push(queue, tasklet, NULL, NULL, arg, NULL, timed);
+}
+
 int isn_reactor_channel_call_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
                                 isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
                                 void* arg, isn_clock_counter_t timed) {
-    size_t next = (queue->wri+1) & queue->size_mask;
-    if (queue->rdi != next) {
-        isn_tasklet_entry_t *e = &queue->fifo[queue->wri];
-        e->tasklet = tasklet;
-        e->caller = caller;
-        e->caller_queue = caller_queue;
-        e->arg = arg;
-        e->time = timed;
-        __DSB();
-        queue->wri = next;
-        if (queue->wakeup) queue->wakeup();
-        return 0;
-    }
-    return -1;
+    return channel_push(queue, tasklet, caller_queue, caller, arg, NULL, timed);
 }
 
-int isn_reactor_channel_return(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t caller, void* arg) {
-    size_t next = (queue->wri+1) & queue->size_mask;
-    if (queue->rdi != next) {
-        isn_tasklet_entry_t *e = &queue->fifo[queue->wri];
-        e->tasklet = NULL;
-        e->caller = caller;
-        e->caller_queue = NULL;
-        e->arg = arg;
-        e->time = ISN_CLOCK_NOW;
-        __DSB();
-        queue->wri = next;
-        if (queue->wakeup) queue->wakeup();
-        return 0;
-    }
-    return -1;
+int isn_reactor_channel_return(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t caller, void* arg, void *pooled) {
+    return channel_push(queue, NULL, NULL, caller, arg, pooled, ISN_CLOCK_NOW);
 }
 
 int isn_reactor_pass(const isn_reactor_tasklet_t tasklet, void* arg) {
@@ -203,9 +197,14 @@ int isn_reactor_pass(const isn_reactor_tasklet_t tasklet, void* arg) {
     queue_table[queue_free].caller_queue = queue_table[self_index].caller_queue;
     queue_table[self_index].caller_queue = NULL;
     queue_table[queue_free].arg      = arg;
+    queue_table[queue_free].pooled   = NULL;
+    if (arg && arg == queue_table[self_index].pooled) {
+        queue_table[queue_free].pooled = arg;
+        queue_table[self_index].pooled = NULL;
+    }
     queue_table[queue_free].time     = ISN_CLOCK_NOW;
     queue_changed = 1;   // we have at least one to work-on
-    int queue_index = queue_free;
+    int queue_index = HANDLE(queue_free);
     ++isn_tasklet_queue_size;
 
     queue_free = QUEUE_NEXT(queue_free);
@@ -223,9 +222,10 @@ int isn_reactor_call_at(const isn_reactor_tasklet_t tasklet, const isn_reactor_t
     queue_table[queue_free].caller   = caller;
     queue_table[queue_free].caller_queue = NULL;
     queue_table[queue_free].arg      = arg;
+    queue_table[queue_free].pooled   = NULL;
     queue_table[queue_free].time     = time;
     queue_changed = 1;   // we have at least one to work-on
-    int queue_index = queue_free;
+    int queue_index = HANDLE(queue_free);
     ++isn_tasklet_queue_size;
 
     queue_free = QUEUE_NEXT(queue_free);
@@ -233,7 +233,7 @@ int isn_reactor_call_at(const isn_reactor_tasklet_t tasklet, const isn_reactor_t
     return queue_index;
 }
 
-static int isn_reactor_callx_at(const isn_reactor_tasklet_t tasklet, isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller, void* arg, isn_clock_counter_t time) {
+static int isn_reactor_callx_at(const isn_reactor_tasklet_t tasklet, isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller, void* arg, void *pooled, isn_clock_counter_t time) {
     critical_section_state_t state = critical_section_enter();
     if (QUEUE_NEXT(queue_free) == queue_len || tasklet == NULL) {
         critical_section_exit(state);
@@ -243,9 +243,10 @@ static int isn_reactor_callx_at(const isn_reactor_tasklet_t tasklet, isn_tasklet
     queue_table[queue_free].caller   = caller;
     queue_table[queue_free].caller_queue = caller_queue;
     queue_table[queue_free].arg      = arg;
+    queue_table[queue_free].pooled   = pooled;
     queue_table[queue_free].time     = time;
     queue_changed = 1;   // we have at least one to work-on
-    int queue_index = queue_free;
+    int queue_index = HANDLE(queue_free);
     ++isn_tasklet_queue_size;
 
     queue_free = QUEUE_NEXT(queue_free);
@@ -253,6 +254,28 @@ static int isn_reactor_callx_at(const isn_reactor_tasklet_t tasklet, isn_tasklet
     return queue_index;
 }
 
+void isn_reactor_setargpool(isn_argpool_t *pool) {
+    argpool = pool;
+}
+
+int isn_reactor_call_copy_at(const isn_reactor_tasklet_t tasklet, const isn_reactor_tasklet_t caller, const void *data, size_t size, isn_clock_counter_t time) {
+    void *arg = argpool ? isn_argpool_copy(argpool, data, size) : NULL;
+    if (!arg) return -1;
+    int queue_index = isn_reactor_callx_at(tasklet, NULL, caller, arg, arg, time);
+    if (queue_index < 0) isn_argpool_free(arg);
+    return queue_index;
+}
+
+int isn_reactor_channel_call_copy_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+                                     isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                                     const void *data, size_t size, isn_clock_counter_t timed) {
+    void *arg = argpool ? isn_argpool_copy(argpool, data, size) : NULL;
+    if (!arg) return -1;
+    int retval = channel_push(queue, tasklet, caller_queue, caller, arg, arg, timed);
+    if (retval < 0) isn_argpool_free(arg);
+    return retval;
+}
+
 int isn_reactor_userqueue(const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed, isn_reactor_mutex_t mutex_bits) {
     return isn_reactor_call_at((void *)(((uint32_t)tasklet & FUNC_ADDR_MASK) | mutex_bits), NULL, arg, timed);
 }
@@ -285,8 +308,27 @@ int isn_reactor_mutexqueue(const isn_reactor_tasklet_t tasklet, void* arg, isn_r
     return isn_reactor_queue( (void *)(((uint32_t)tasklet & FUNC_ADDR_MASK) | mutex_bits), arg);
 }
 
+static int handle_isvalid(int handle) {
+    if (handle < 0) return 0;
+    int index = HANDLE_INDEX(handle);
+    return (index < queue_len && HANDLE(index) == handle && QUEUE_FUNC_VALID(index)) ? 1 : 0;
+}
+
+/** Replaces the tasklet in place, keeping the link, so the list is not modified outside the step */
+static void drop_entry(int index) {
+    queue_table[index].tasklet = (void *)(((uint32_t)queue_table[index].tasklet & (0xFF << INDEX_SHIFT)) | ((uint32_t)dropped_tasklet & FUNC_ADDR_MASK));
+    queue_table[index].caller       = NULL;
+    queue_table[index].caller_queue = NULL;
+    queue_table[index].time         = ISN_CLOCK_NOW - 1;
+    isn_argpool_free(queue_table[index].pooled);
+    queue_table[index].pooled       = NULL;
+    QUEUE_FREE(index);
+    queue_changed = 1;
+}
+
 int isn_reactor_isvalid(int index, const isn_reactor_tasklet_t tasklet, const void* arg) {
-    if (index >= queue_len || index < 0) return 0;
+    if (!handle_isvalid(index)) return 0;
+    index = HANDLE_INDEX(index);
     return (QUEUE_FUNC_ADDR(index) == tasklet && queue_table[index].arg == arg) ? 1 : 0;
 }
 
@@ -294,13 +336,36 @@ int isn_reactor_change_timed(int index, const isn_reactor_tasklet_t tasklet, con
     critical_section_state_t state = critical_section_enter();
     int retval = isn_reactor_isvalid(index, tasklet, arg);
     if (retval) {
-        queue_table[index].time = newtime;
+        queue_table[HANDLE_INDEX(index)].time = newtime;
         queue_changed = 1;
     }
     critical_section_exit(state);
     return retval;
 }
 
+int isn_reactor_valid(int handle) {
+    return handle_isvalid(handle);
+}
+
+int isn_reactor_retime(int handle, isn_clock_counter_t newtime) {
+    critical_section_state_t state = critical_section_enter();
+    int retval = handle_isvalid(handle);
+    if (retval) {
+        queue_table[HANDLE_INDEX(handle)].time = newtime;
+        queue_changed = 1;
+    }
+    critical_section_exit(state);
+    return retval;
+}
+
+int isn_reactor_cancel(int handle) {
+    critical_section_state_t state = critical_section_enter();
+    int retval = handle_isvalid(handle) && HANDLE_INDEX(handle) != self_index;
+    if (retval) drop_entry(HANDLE_INDEX(handle));
+    critical_section_exit(state);
+    return retval;
+}
+
 int isn_reactor_change_timed_self(isn_clock_counter_t newtime) {
     if (self_index >= 0) {
         queue_table[self_index].time = newtime;
@@ -310,36 +375,41 @@ int isn_reactor_change_timed_self(isn_clock_counter_t newtime) {
     return -1;
 }
 
+int isn_reactor_change_mutex_self(isn_reactor_mutex_t mutex_bits) {
+    if (self_index >= 0) {
+        critical_section_state_t state = critical_section_enter();
+        queue_table[self_index].tasklet = (void *)(((uint32_t)queue_table[self_index].tasklet & ~(MUTEX_MASK << MUTEX_SHIFT)) | mutex_bits);
+        queue_changed = 1;
+        critical_section_exit(state);
+        return 0;
+    }
+    return -1;
+}
+
+int isn_reactor_self(void) {
+    return (self_index >= 0) ? HANDLE(self_index) : -1;
+}
+
 int isn_reactor_drop(int index, const isn_reactor_tasklet_t tasklet, const void* arg) {
     critical_section_state_t state = critical_section_enter();
-    int retval = isn_reactor_isvalid(index, tasklet, arg);
-    if (retval && index != self_index) queue_table[index].tasklet = NULL;
+    int retval = isn_reactor_isvalid(index, tasklet, arg) && HANDLE_INDEX(index) != self_index;
+    if (retval) drop_entry(HANDLE_INDEX(index));
     critical_section_exit(state);
     return retval;
 }
 
-#ifdef REQUIRES_BUGFIX
 int isn_reactor_dropall(const isn_reactor_tasklet_t tasklet, const void* arg) {
     int removed = 0;
-    uint8_t i,j;
-    for (i=0, j=QUEUE_NEXT(0); QUEUE_FUNC_VALID(j); ) {
-        if (tasklet == QUEUE_FUNC_ADDR(j) && arg == (const void *)queue_table[j].arg) {
-            QUEUE_LINK(i, QUEUE_NEXT(j));
-
-            critical_section_state_t state = critical_section_enter();
-            QUEUE_LINKANDCLEAR(j, QUEUE_NEXT(queue_free));
-            QUEUE_LINK(queue_free, j);
-            queue_changed = --isn_tasklet_queue_size; // avoid additional looping if it is last
-            critical_section_exit(state);
-            j = i;
+    critical_section_state_t state = critical_section_enter();
+    for (uint8_t j=QUEUE_NEXT(0); QUEUE_FUNC_VALID(j); j = QUEUE_NEXT(j)) {
+        if (j != self_index && tasklet == QUEUE_FUNC_ADDR(j) && arg == (const void *)queue_table[j].arg) {
+            drop_entry(j);
             removed++;
         }
-        i = j;
-        j = QUEUE_NEXT(j);
     }
+    critical_section_exit(state);
     return removed;
 }
-#endif
 
 #define MAX_SLEEP_TIME    0x0FFFFFFF    // \todo Consider appropriate max time according to isn_clock.c constraints, derive macro from there
 
@@ -367,6 +437,7 @@ int isn_reactor_step(void) {
                 int32_t time_to_exec = isn_clock_remains(QUEUE_TIME(j));
                 if (time_to_exec <= 0) {
                     isn_reactor_tasklet_t tasklet = QUEUE_FUNC_ADDR(j);
+                    if ((uint32_t)-time_to_exec > isn_tasklet_lateness_max) isn_tasklet_lateness_max = -time_to_exec;
                     _isn_reactor_active_timestamp = queue_table[j].time;
                     self_index                    = j;
 
@@ -390,18 +461,23 @@ int isn_reactor_step(void) {
                             else next_time_to_exec = time_to_exec;
                             goto do_next_event;
                         }
+                        void *pooled = queue_table[j].pooled;
+                        queue_table[j].pooled = NULL;
                         if ( queue_table[j].caller ) {
                             if (queue_table[j].caller_queue) {
-                                isn_reactor_channel_return( queue_table[j].caller_queue, queue_table[j].caller, retval);
+                                // the caller at the other core completes, and releases the pooled argument
+                                if (isn_reactor_channel_return( queue_table[j].caller_queue, queue_table[j].caller, retval, pooled) == 0) pooled = NULL;
                             }
                             else queue_table[j].caller( retval );
                         }
+                        isn_argpool_free(pooled);
                     }
                     QUEUE_LINK(i, QUEUE_NEXT(j));
 
                     critical_section_state_t state = critical_section_enter();
                     QUEUE_LINKANDCLEAR(j, QUEUE_NEXT(queue_free));
                     QUEUE_LINK(queue_free, j);
+                    QUEUE_FREE(j);
 
                     if (isn_tasklet_queue_size > isn_tasklet_queue_max) isn_tasklet_queue_max = isn_tasklet_queue_size;
                     queue_changed = --isn_tasklet_queue_size; // avoid additional looping if it is last
@@ -438,8 +514,13 @@ isn_clock_counter_t isn_reactor_runall(isn_tasklet_queue_t *queue, ...) {
                 If tasklet is NULL but caller is given it is a return feedback call; currently tasklet for cross-cpu
                 is marked as NULL (TBD if really needed)
             */
-            if (e->tasklet) isn_reactor_callx_at( e->tasklet, e->caller_queue, e->caller, e->arg, e->time ); else
-            if (e->caller)  e->caller( e->arg );
+            if (e->tasklet) {
+                if (isn_reactor_callx_at( e->tasklet, e->caller_queue, e->caller, e->arg, e->pooled, e->time ) < 0) isn_argpool_free(e->pooled);
+            }
+            else {
+                if (e->caller) e->caller( e->arg );
+                isn_argpool_free(e->pooled);
+            }
             queue->rdi = (queue->rdi+1) & queue->size_mask;
         }
         queue = va_arg(va, isn_tasklet_queue_t *);
@@ -454,6 +535,18 @@ isn_clock_counter_t isn_reactor_runall(isn_tasklet_queue_t *queue, ...) {
     return isn_reactor_timer_trigger;
 }
 
+void *isn_reactor_stats_cb(const void *arg) {
+    static isn_reactor_stats_t stats;
+    if (arg) {
+        isn_tasklet_queue_max = isn_tasklet_lateness_max = 0;
+    }
+    stats.queue_size   = isn_tasklet_queue_size;
+    stats.queue_max    = isn_tasklet_queue_max;
+    stats.lateness_max = isn_tasklet_lateness_max;
+    stats.queue_capacity = isn_tasklet_queue_capacity;
+    return &stats;
+}
+
 int isn_reactor_selftest() {
     static int count = 0;
     isn_reactor_mutex_t mux = isn_reactor_getmutex();
@@ -485,7 +578,13 @@ void isn_reactor_init(isn_tasklet_entry_t *tasklet_queue, size_t queue_size) {
     queue_mutex_locked_bits = 0;
     isn_tasklet_queue_size = 0;
     isn_tasklet_queue_max = 0;
-    for (uint8_t i=0; i<queue_len; i++) QUEUE_LINKANDCLEAR(i, i+1);
+    isn_tasklet_lateness_max = 0;
+    isn_tasklet_queue_capacity = queue_len - 2;     // first and last are not used
+    for (uint8_t i=0; i<queue_len; i++) {
+        QUEUE_LINKANDCLEAR(i, i+1);
+        queue_table[i].gen = 0;
+        queue_table[i].pooled = NULL;
+    }
 }
 
 /** \} \endcond */
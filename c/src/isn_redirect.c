@@ -19,6 +19,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include "isn_redirect.h"
+#include "isn_static.h"
+
+#ifndef ISN_REDIRECT_TARGET_GETSENDBUF
+# define ISN_REDIRECT_TARGET_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_REDIRECT_TARGET_SEND
+# define ISN_REDIRECT_TARGET_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_REDIRECT_TARGET_FREE
+# define ISN_REDIRECT_TARGET_FREE ISN_DYNAMIC_FREE
+#endif
 
 /**\{ */
 
@@ -26,15 +37,15 @@ static size_t isn_redirect_recv(isn_layer_t *drv, const void *src, size_t size,
     isn_redirect_t *obj = (isn_redirect_t *)drv;
     isn_driver_t *target = (obj->target) ? obj->target : (isn_driver_t *)caller;
     void *obuf = NULL;
-    int bs = target->getsendbuf(target, &obuf, size, caller);
+    int bs = ISN_REDIRECT_TARGET_GETSENDBUF(target, &obuf, size, caller);
     if ( bs == size || (bs > 0 && obj->en_fragment) ) {
-        isn_memcpy(obuf, src, bs);
-        target->send(target, obuf, bs);
+        isn_layer_memcpy(target, obuf, caller, src, bs);
+        ISN_REDIRECT_TARGET_SEND(target, obuf, bs);
         obj->drv.stats.tx_counter += bs;
         return bs;
     }
     else if (obuf) {
-        target->free(target, obuf);
+        ISN_REDIRECT_TARGET_FREE(target, obuf);
     }
     obj->drv.stats.tx_retries++;
     return 0;
@@ -49,7 +60,7 @@ void isn_redirect_init(isn_redirect_t *obj, isn_layer_t* target) {
 }
 
 isn_redirect_t* isn_redirect_create() {
-    isn_redirect_t* obj = malloc(sizeof(isn_redirect_t));
+    isn_redirect_t* obj = calloc(1, sizeof(isn_redirect_t));
     return obj;
 }
 
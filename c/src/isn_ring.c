@@ -0,0 +1,135 @@
+/** \file
+ *  \brief ISN Zero-Copy Circular Buffer Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_ring.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_Ring
+ *
+ * Generalization of the PSoC UART UDB 256 B buffers to any size.
+ * Indices are only written by their owners, the wrap point is written
+ * by the producer before the write index is released, so the consumer
+ * always sees the wrap point belonging to the published data.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include "isn_def.h"
+#include "isn_ring.h"
+
+/**\{ */
+
+void isn_ring_init(isn_ring_t *obj, void *buf, size_t size) {
+    ASSERT(obj);
+    ASSERT(buf);
+    ASSERT(size >= 2);
+    obj->buf  = (uint8_t *)buf;
+    obj->size = (uint32_t)size;
+    isn_ring_reset(obj);
+}
+
+void isn_ring_reset(isn_ring_t *obj) {
+    obj->wri = obj->rdi = 0;
+    obj->wrw = obj->size;
+    obj->alloc_wri  = obj->alloc_wrw = obj->size;   // invalidate, so commit cannot work
+    obj->alloc_size = 0;
+}
+
+size_t isn_ring_reserve(isn_ring_t *obj, void **dest, size_t size) {
+    uint32_t wri = obj->wri;
+    uint32_t rdi = __atomic_load_n(&obj->rdi, __ATOMIC_ACQUIRE);   // take snap shot, as it may change during irq
+
+    obj->alloc_wrw = obj->wrw;  // restore settings from last actual commit as there is
+    obj->alloc_wri = wri;       // a possibilty that there were several reservations meanwhile
+
+    if (rdi > wri) {
+        size_t free = rdi - wri - 1;                    // [ .. wri <-> rdi ..]
+        if (size > free) size = free;
+    }
+    else {
+        size_t free_start = rdi;                        // [ <-> rdi .. wri .. ], actual size is -1
+        size_t free_end = (obj->size - 1) - wri;        // [ .. rdi .. wri <-> ]
+
+        if (size < free_end || free_end >= free_start) {    // prefered place to stretch fifo to max
+            if (size > free_end) size = free_end;
+            obj->alloc_wrw = wri + (uint32_t)size;      // move wrap index to the end
+        }
+        else if (free_start > 0) {
+            free_start--;
+            if (size > free_start) size = free_start;
+            obj->alloc_wrw = wri;                       // cut off the tail
+            obj->alloc_wri = 0;
+        }
+        else {
+            size = 0;
+        }
+    }
+    obj->alloc_size = (uint32_t)size;
+    if (dest) *dest = size ? &obj->buf[obj->alloc_wri] : NULL;
+    return size;
+}
+
+void isn_ring_commit(isn_ring_t *obj, size_t size) {
+    ASSERT(size <= obj->alloc_size);
+    if (size) {
+        __atomic_store_n(&obj->wrw, obj->alloc_wrw, __ATOMIC_RELAXED);
+        __atomic_store_n(&obj->wri, obj->alloc_wri + (uint32_t)size, __ATOMIC_RELEASE);
+        obj->alloc_size = 0;
+    }
+}
+
+size_t isn_ring_peek(isn_ring_t *obj, const void **src) {
+    uint32_t rdi = obj->rdi;
+    uint32_t wri = __atomic_load_n(&obj->wri, __ATOMIC_ACQUIRE);
+
+    if (rdi == wri) return 0;
+    uint32_t wrw = __atomic_load_n(&obj->wrw, __ATOMIC_RELAXED);
+    if (rdi == wrw) {
+        rdi = 0;
+        __atomic_store_n(&obj->rdi, 0, __ATOMIC_RELEASE);
+    }
+    if (src) *src = &obj->buf[rdi];
+    return (wri >= rdi) ? wri - rdi : wrw - rdi;
+}
+
+void isn_ring_consume(isn_ring_t *obj, size_t size) {
+    if (size) {
+        ASSERT(obj->rdi + size <= obj->size);
+        __atomic_store_n(&obj->rdi, obj->rdi + (uint32_t)size, __ATOMIC_RELEASE);
+    }
+}
+
+size_t isn_ring_used(const isn_ring_t *obj) {
+    uint32_t rdi = __atomic_load_n(&obj->rdi, __ATOMIC_ACQUIRE);
+    uint32_t wri = __atomic_load_n(&obj->wri, __ATOMIC_ACQUIRE);
+    return (wri >= rdi) ? wri - rdi : (obj->wrw - rdi) + wri;
+}
+
+int isn_ring_putbyte(isn_ring_t *obj, uint8_t b) {
+    void *dest;
+    if (isn_ring_reserve(obj, &dest, 1)) {
+        *(uint8_t *)dest = b;
+        isn_ring_commit(obj, 1);
+        return 0;
+    }
+    return -1;
+}
+
+int isn_ring_getbyte(isn_ring_t *obj) {
+    const void *src;
+    if (isn_ring_peek(obj, &src)) {
+        int b = *(const uint8_t *)src;
+        isn_ring_consume(obj, 1);
+        return b;
+    }
+    return -1;
+}
+
+/** \} \endcond */
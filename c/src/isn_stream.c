@@ -0,0 +1,136 @@
+/** \file
+ *  \brief ISN Sample Streaming Layer Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_stream.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_Stream
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "isn_stream.h"
+
+/**\{ */
+
+#define HEADER_SIZE     sizeof(isn_stream_header_t)
+
+/* Indices wrap at twice the nblocks, so full and empty differ for any nblocks */
+static inline uint8_t *block_at(isn_stream_t *obj, uint8_t index) {
+    return obj->blocks + (size_t)(index % obj->nblocks) * (HEADER_SIZE + obj->block_size);
+}
+
+static inline uint8_t next_index(const isn_stream_t *obj, uint8_t index) {
+    return (index + 1 == 2 * obj->nblocks) ? 0 : index + 1;
+}
+
+static inline uint8_t filled(const isn_stream_t *obj, uint8_t wri, uint8_t rdi) {
+    return (wri >= rdi) ? wri - rdi : wri + 2 * obj->nblocks - rdi;
+}
+
+void *isn_stream_getblock(isn_stream_t *obj) {
+    uint8_t wri = obj->wri;
+    if (filled(obj, wri, __atomic_load_n(&obj->rdi, __ATOMIC_ACQUIRE)) >= obj->nblocks) {
+        obj->tx_seq++;                  // lost, receiver sees the gap
+        obj->drv.stats.tx_dropped++;
+        return NULL;
+    }
+    return block_at(obj, wri) + HEADER_SIZE;
+}
+
+void isn_stream_commit(isn_stream_t *obj, uint32_t timestamp) {
+    uint8_t wri = obj->wri;
+    isn_stream_header_t *h = (isn_stream_header_t *)block_at(obj, wri);
+    h->seq       = obj->tx_seq++;
+    h->timestamp = timestamp;
+    __atomic_store_n(&obj->wri, next_index(obj, wri), __ATOMIC_RELEASE);
+}
+
+int isn_stream_flush(isn_stream_t *obj) {
+    const size_t size = HEADER_SIZE + obj->block_size;
+    uint8_t rdi = obj->rdi;
+    uint8_t wri = __atomic_load_n(&obj->wri, __ATOMIC_ACQUIRE);
+
+    for (; rdi != wri; rdi = next_index(obj, rdi)) {
+        void *dest = NULL;
+        if (obj->parent->getsendbuf(obj->parent, &dest, size, obj) != (int)size) {
+            if (dest) obj->parent->free(obj->parent, dest);
+            obj->drv.stats.tx_retries++;
+            break;
+        }
+        isn_memcpy_class(isn_memclass(obj->parent), dest, block_at(obj, rdi), size);
+        obj->parent->send(obj->parent, dest, size);
+        obj->drv.stats.tx_packets++;
+        obj->drv.stats.tx_counter += obj->block_size;
+        __atomic_store_n(&obj->rdi, next_index(obj, rdi), __ATOMIC_RELEASE);
+    }
+    return filled(obj, wri, rdi);
+}
+
+static size_t isn_stream_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    isn_stream_t *obj = (isn_stream_t *)drv;
+    if (size < HEADER_SIZE || !obj->ring) {
+        obj->drv.stats.rx_errors++;
+        return size;
+    }
+    isn_stream_header_t h;
+    memcpy(&h, src, HEADER_SIZE);
+    size_t samples = size - HEADER_SIZE;
+
+    if (obj->rx_synced && (int16_t)(h.seq - obj->rx_seq) < 0) {
+        obj->drv.stats.rx_dropped++;    // duplicate or older block, already received or counted as a gap
+        return size;
+    }
+
+    void *dest = NULL;
+    if (samples) {
+        if (isn_ring_reserve(obj->ring, &dest, samples) != samples) {
+            obj->drv.stats.rx_retries++;
+            return 0;       // application is late, keep the block in the sender
+        }
+        isn_memcpy_class(isn_memclass(caller), dest, (const uint8_t *)src + HEADER_SIZE, samples);
+        isn_ring_commit(obj->ring, samples);
+    }
+
+    if (obj->rx_synced && h.seq != obj->rx_seq) {
+        obj->gaps += (uint16_t)(h.seq - obj->rx_seq);       // forward jump only, see above
+    }
+    obj->rx_synced    = 1;
+    obj->rx_seq       = h.seq + 1;
+    obj->rx_timestamp = h.timestamp;
+    obj->drv.stats.rx_packets++;
+    obj->drv.stats.rx_counter += samples;
+    return size;
+}
+
+void isn_stream_init(isn_stream_t *obj, isn_layer_t* parent, void *blocks, uint16_t block_size, uint8_t nblocks, isn_ring_t *ring) {
+    ASSERT(obj);
+    ASSERT(!blocks || (parent && nblocks > 0 && nblocks <= 128));
+    memset(obj, 0, sizeof(isn_stream_t));
+    obj->drv.recv       = isn_stream_recv;   // blocks are sent by the isn_stream_flush() only
+    obj->parent         = parent;
+    obj->blocks         = blocks;
+    obj->block_size     = block_size;
+    obj->nblocks        = nblocks;
+    obj->ring           = ring;
+}
+
+isn_stream_t* isn_stream_create() {
+    isn_stream_t* obj = calloc(1, sizeof(isn_stream_t));
+    return obj;
+}
+
+void isn_stream_drop(isn_stream_t *obj) {
+    free(obj);
+}
+
+/** \} \endcond */
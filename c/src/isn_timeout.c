@@ -0,0 +1,62 @@
+/** \file
+ *  \brief ISN Adaptive Frame Timeout Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_timeout.h
+ */
+/**
+ * \ingroup GR_ISN
+ * \cond Implementation
+ * \addtogroup GR_ISN_Timeout
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <string.h>
+#include "isn_timeout.h"
+
+/**\{ */
+
+void isn_timeout_init(isn_timeout_t *obj, isn_clock_counter_t min, isn_clock_counter_t max) {
+    ASSERT(obj);
+    ASSERT(min <= max);
+    memset(obj, 0, sizeof(isn_timeout_t));
+    obj->min     = min;
+    obj->max     = max;
+    obj->timeout = max;
+}
+
+isn_clock_counter_t isn_timeout_sample(isn_timeout_t *obj, isn_clock_counter_t gap) {
+    if (gap > obj->max) gap = obj->max;         // a broken link counts as the longest gap
+    int bucket = gap ? 32 - __builtin_clz(gap) : 0;
+    if (bucket >= ISN_TIMEOUT_BUCKETS) bucket = ISN_TIMEOUT_BUCKETS - 1;
+    obj->hist[bucket]++;
+    obj->samples++;
+
+    if (++obj->total >= ISN_TIMEOUT_DECAY) {
+        obj->total = 0;
+        for (int i = 0; i < ISN_TIMEOUT_BUCKETS; i++) {
+            obj->hist[i] >>= 1;
+            obj->total += obj->hist[i];
+        }
+    }
+    if (obj->samples < ISN_TIMEOUT_WARMUP) return obj->timeout;
+
+    uint32_t covered = 0, needed = ((uint32_t)obj->total * ISN_TIMEOUT_PERCENTILE + 99) / 100;
+    int i = 0;
+    for (; i < ISN_TIMEOUT_BUCKETS - 1; i++) {
+        covered += obj->hist[i];
+        if (covered >= needed) break;
+    }
+    uint64_t timeout = (uint64_t)2 << i;    // twice the bucket upper bound, 2^i
+    if (timeout < obj->min) timeout = obj->min;
+    if (timeout > obj->max) timeout = obj->max;
+    obj->timeout = (isn_clock_counter_t)timeout;
+    return obj->timeout;
+}
+
+/** \} \endcond */
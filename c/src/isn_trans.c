@@ -25,6 +25,20 @@
 #include <string.h>
 #include <stdlib.h>
 #include "isn_trans.h"
+#include "isn_static.h"
+
+#ifndef ISN_TRANS_CHILD_RECV
+# define ISN_TRANS_CHILD_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_TRANS_PARENT_GETSENDBUF
+# define ISN_TRANS_PARENT_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_TRANS_PARENT_SEND
+# define ISN_TRANS_PARENT_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_TRANS_PARENT_FREE
+# define ISN_TRANS_PARENT_FREE ISN_DYNAMIC_FREE
+#endif
 
 #define PROTO_SIZE  2
 
@@ -41,7 +55,7 @@ static int isn_trans_getsendbuf(isn_layer_t *drv, void **dest, size_t size, cons
     //size_t port = (const isn_trans_dispatchtbl_t *)caller - obj->tbl;
     //if (port > obj->tbl_size) return 0; // Invalid port
 
-    int osize = obj->parent->getsendbuf(obj->parent, dest, size+PROTO_SIZE, caller);
+    int osize = ISN_TRANS_PARENT_GETSENDBUF(obj->parent, dest, size+PROTO_SIZE, caller);
     uint8_t **buf = (uint8_t **)dest;
     if (buf) {
         if (*buf) {
@@ -55,7 +69,7 @@ static int isn_trans_getsendbuf(isn_layer_t *drv, void **dest, size_t size, cons
 static void isn_trans_free(isn_layer_t *drv, const void *ptr) {
     isn_trans_t *obj = (isn_trans_t *)drv;
     const uint8_t *buf = ptr;
-    if (buf) obj->parent->free(obj->parent, buf-PROTO_SIZE);
+    if (buf) ISN_TRANS_PARENT_FREE(obj->parent, buf-PROTO_SIZE);
 }
 
 static int isn_trans_send(isn_layer_t *drv, void *dest, size_t size) {
@@ -66,7 +80,7 @@ static int isn_trans_send(isn_layer_t *drv, void *dest, size_t size) {
     obj->tbl[port].tx_counter++;
     obj->drv.stats.tx_packets++;
     obj->drv.stats.tx_counter += size;
-    return obj->parent->send(obj->parent, buf - 1, size + PROTO_SIZE);
+    return ISN_TRANS_PARENT_SEND(obj->parent, buf - 1, size + PROTO_SIZE);
 }
 
 static size_t isn_trans_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
@@ -84,7 +98,7 @@ static size_t isn_trans_recv(isn_layer_t *drv, const void *src, size_t size, isn
                 obj->drv.stats.rx_counter += size - PROTO_SIZE;
                 obj->drv.stats.rx_packets++;
                 isn_receiver_t *driver = (isn_receiver_t *)obj->tbl[port].driver;
-                return driver->recv(driver, buf, size-PROTO_SIZE, drv) + PROTO_SIZE;
+                return ISN_TRANS_CHILD_RECV(driver, buf, size-PROTO_SIZE, drv) + PROTO_SIZE;
             }
         }
     }
@@ -103,13 +117,14 @@ void isn_trans_init(isn_trans_t *obj, isn_trans_dispatchtbl_t *tbl, size_t tbl_s
     obj->drv.recv       = isn_trans_recv;
     obj->drv.free       = isn_trans_free;
     obj->parent         = parent;
+    obj->drv.memclass   = ((isn_driver_t *)parent)->memclass;  // passes the buffers of the parent through
     obj->tbl            = tbl;
     obj->tbl_size       = tbl_size;
     for (size_t i=0; i<tbl_size; i++) tbl[i].rx_counter = tbl[i].tx_counter = tbl[i].rx_dropped = 0;
 }
 
 isn_trans_t* isn_trans_create() {
-    isn_trans_t* obj = malloc(sizeof(isn_trans_t));
+    isn_trans_t* obj = calloc(1, sizeof(isn_trans_t));
     return obj;
 }
 
@@ -19,12 +19,26 @@
 #include <string.h>
 #include <stdlib.h>
 #include "isn_user.h"
+#include "isn_static.h"
+
+#ifndef ISN_USER_CHILD_RECV
+# define ISN_USER_CHILD_RECV ISN_DYNAMIC_RECV
+#endif
+#ifndef ISN_USER_PARENT_GETSENDBUF
+# define ISN_USER_PARENT_GETSENDBUF ISN_DYNAMIC_GETSENDBUF
+#endif
+#ifndef ISN_USER_PARENT_SEND
+# define ISN_USER_PARENT_SEND ISN_DYNAMIC_SEND
+#endif
+#ifndef ISN_USER_PARENT_FREE
+# define ISN_USER_PARENT_FREE ISN_DYNAMIC_FREE
+#endif
 
 /**\{ */
 
 static int isn_user_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
     isn_user_t *obj = (isn_user_t *)drv;
-    int osize = obj->parent->getsendbuf(obj->parent, dest, size+1, caller);
+    int osize = ISN_USER_PARENT_GETSENDBUF(obj->parent, dest, size+1, caller);
     uint8_t **buf = (uint8_t **)dest;
     if (buf) {
         if (*buf) (*buf)++; // add protocol header at the front
@@ -35,7 +49,7 @@ static int isn_user_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const
 static void isn_user_free(isn_layer_t *drv, const void *ptr) {
     isn_user_t *obj = (isn_user_t *)drv;
     const uint8_t *buf = ptr;
-    if (buf) obj->parent->free(obj->parent, buf-1);
+    if (buf) ISN_USER_PARENT_FREE(obj->parent, buf-1);
 }
 
 static int isn_user_send(isn_layer_t *drv, void *dest, size_t size) {
@@ -44,7 +58,7 @@ static int isn_user_send(isn_layer_t *drv, void *dest, size_t size) {
     *(--buf) = obj->user_id;
     obj->drv.stats.tx_packets++;
     obj->drv.stats.tx_counter+=size;
-    return obj->parent->send(obj->parent, buf, size+1)-1;
+    return ISN_USER_PARENT_SEND(obj->parent, buf, size+1)-1;
 }
 
 static size_t isn_user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
@@ -52,7 +66,7 @@ static size_t isn_user_recv(isn_layer_t *drv, const void *src, size_t size, isn_
     if (src && size && obj->child) {
         const uint8_t *buf = src;
         if (*buf == obj->user_id) {
-            size_t passed = obj->child->recv(obj->child, buf+1, size-1, drv);
+            size_t passed = ISN_USER_CHILD_RECV(obj->child, buf+1, size-1, drv);
             if (passed > 0 || size == 1) {  // user stream can receive zero-payload in which case we must also confirm
                 obj->drv.stats.rx_packets++;
                 obj->drv.stats.rx_counter += passed;
@@ -78,10 +92,11 @@ void isn_user_init(isn_user_t *obj, isn_layer_t* child, isn_layer_t* parent, uin
     obj->user_id        = user_id;
     obj->child          = child;
     obj->parent         = parent;
+    obj->drv.memclass   = ((isn_driver_t *)parent)->memclass;  // passes the buffers of the parent through
 }
 
 isn_user_t* isn_user_create() {
-    isn_user_t* obj = malloc(sizeof(isn_user_t));
+    isn_user_t* obj = calloc(1, sizeof(isn_user_t));
     return obj;
 }
 
@@ -0,0 +1,301 @@
+/** \file
+ *  \brief ISN Traffic Capture and Replay Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_capture.h
+ */
+/**
+ * \ingroup GR_ISN_POSIX
+ * \cond Implementation
+ * \addtogroup GR_ISN_CAPTURE
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <posix/isn_capture.h>
+
+/**\{ */
+
+#define PCAP_MAGIC_NS       0xA1B23C4D      ///< pcap with nanosecond timestamps
+#define REPLAY_BUF_SIZE     8192
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version_major, version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs, snaplen, network;
+} pcap_header_t;
+
+typedef struct {
+    uint32_t ts_sec, ts_nsec, incl_len, orig_len;
+} pcap_record_t;
+
+struct isn_capture_s {
+    isn_driver_t drv;
+    isn_driver_t *child;
+    isn_driver_t *parent;
+    FILE *f;
+    uint32_t records;
+};
+
+typedef struct {
+    uint64_t t_ns;                  ///< relative to the first record
+    uint32_t offset;                ///< into the data
+    uint32_t size;
+    uint8_t dir;
+} replay_record_t;
+
+struct isn_replay_s {
+    isn_driver_t drv;
+    isn_driver_t *child;
+    replay_record_t *records;
+    uint32_t count;
+    uint8_t *data;
+
+    uint32_t rx_next;               ///< next record to deliver
+    uint32_t rx_offset;             ///< bytes already accepted of the rx_next
+    uint32_t rx_left;               ///< RX records still to be delivered
+    uint32_t tx_next;               ///< next record to compare the sent packets with
+    uint32_t mismatches;
+    double speed;
+    uint64_t start_ns;              ///< monotonic time of the first delivery, or 0
+    uint64_t first_ns;              ///< time of the first RX record
+
+    uint8_t buf[REPLAY_BUF_SIZE];
+    int buf_locked;
+};
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+/* Capture                                                            */
+/*--------------------------------------------------------------------*/
+
+static void write_record(isn_capture_t *obj, uint8_t dir, const void *src, size_t size) {
+    uint64_t now = clock_ns(CLOCK_REALTIME);
+    if (size > ISN_CAPTURE_SNAPLEN - 1) size = ISN_CAPTURE_SNAPLEN - 1;
+    pcap_record_t r = { (uint32_t)(now / 1000000000ULL), (uint32_t)(now % 1000000000ULL), size + 1, size + 1 };
+    fwrite(&r, sizeof(r), 1, obj->f);
+    fputc(dir, obj->f);
+    fwrite(src, 1, size, obj->f);
+    obj->records++;
+}
+
+static size_t capture_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    isn_capture_t *obj = (isn_capture_t *)drv;
+    size_t accepted = obj->child->recv(obj->child, src, size, obj);
+    if (accepted) {
+        write_record(obj, ISN_CAPTURE_RX, src, accepted);
+        obj->drv.stats.rx_packets++;
+        obj->drv.stats.rx_counter += accepted;
+    }
+    else obj->drv.stats.rx_retries++;
+    return accepted;
+}
+
+static int capture_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_capture_t *obj = (isn_capture_t *)drv;
+    return obj->parent->getsendbuf(obj->parent, dest, size, caller);
+}
+
+static int capture_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_capture_t *obj = (isn_capture_t *)drv;
+    write_record(obj, ISN_CAPTURE_TX, dest, size);
+    obj->drv.stats.tx_packets++;
+    obj->drv.stats.tx_counter += size;
+    return obj->parent->send(obj->parent, dest, size);
+}
+
+static void capture_free(isn_layer_t *drv, const void *ptr) {
+    isn_capture_t *obj = (isn_capture_t *)drv;
+    obj->parent->free(obj->parent, ptr);
+}
+
+isn_capture_t *isn_capture_create(const char *filename, isn_layer_t *child, isn_layer_t *parent) {
+    isn_capture_t *obj = calloc(1, sizeof(isn_capture_t));
+    if (!obj) return NULL;
+    if (!(obj->f = fopen(filename, "wb"))) {
+        free(obj);
+        return NULL;
+    }
+    pcap_header_t h = { PCAP_MAGIC_NS, 2, 4, 0, 0, ISN_CAPTURE_SNAPLEN, ISN_CAPTURE_LINKTYPE };
+    fwrite(&h, sizeof(h), 1, obj->f);
+
+    obj->drv.recv       = capture_recv;
+    obj->drv.getsendbuf = capture_getsendbuf;
+    obj->drv.send       = capture_send;
+    obj->drv.free       = capture_free;
+    obj->child          = child;
+    obj->parent         = parent;
+    return obj;
+}
+
+void isn_capture_setparent(isn_capture_t *obj, isn_layer_t *parent) {
+    obj->parent = parent;
+}
+
+void isn_capture_flush(isn_capture_t *obj) {
+    fflush(obj->f);
+}
+
+uint32_t isn_capture_records(const isn_capture_t *obj) {
+    return obj->records;
+}
+
+void isn_capture_drop(isn_capture_t *obj) {
+    if (!obj) return;
+    fclose(obj->f);
+    free(obj);
+}
+
+/*--------------------------------------------------------------------*/
+/* Replay                                                             */
+/*--------------------------------------------------------------------*/
+
+static int replay_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_replay_t *obj = (isn_replay_t *)drv;
+    if (obj->buf_locked) {
+        if (dest) *dest = NULL;
+        return -1;
+    }
+    if (dest) {
+        obj->buf_locked = 1;
+        *dest = obj->buf;
+    }
+    return (size > REPLAY_BUF_SIZE) ? REPLAY_BUF_SIZE : size;
+}
+
+static void replay_free(isn_layer_t *drv, const void *ptr) {
+    isn_replay_t *obj = (isn_replay_t *)drv;
+    if (ptr == obj->buf) obj->buf_locked = 0;
+}
+
+static int replay_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_replay_t *obj = (isn_replay_t *)drv;
+    while (obj->tx_next < obj->count && obj->records[obj->tx_next].dir != ISN_CAPTURE_TX) obj->tx_next++;
+
+    if (obj->tx_next < obj->count) {
+        const replay_record_t *r = &obj->records[obj->tx_next++];
+        if (r->size != size || memcmp(&obj->data[r->offset], dest, size)) obj->mismatches++;
+    }
+    else obj->mismatches++;
+
+    obj->drv.stats.tx_packets++;
+    obj->drv.stats.tx_counter += size;
+    replay_free(drv, dest);
+    return size;
+}
+
+static int load(isn_replay_t *obj, FILE *f) {
+    pcap_header_t h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != PCAP_MAGIC_NS || h.network != ISN_CAPTURE_LINKTYPE) return -1;
+
+    long start = ftell(f);
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    fseek(f, start, SEEK_SET);
+    if (!(obj->data = malloc(end - start + 1))) return -1;
+
+    uint32_t capacity = 0, offset = 0;
+    uint64_t first = 0;
+    pcap_record_t r;
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        if (r.incl_len < 1 || r.incl_len > (uint32_t)(end - start) || fread(&obj->data[offset], 1, r.incl_len, f) != r.incl_len) return -1;
+        if (obj->count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            replay_record_t *grown = realloc(obj->records, capacity * sizeof(replay_record_t));
+            if (!grown) return -1;
+            obj->records = grown;
+        }
+        uint64_t t = (uint64_t)r.ts_sec * 1000000000ULL + r.ts_nsec;
+        if (!obj->count) first = t;
+        obj->records[obj->count++] = (replay_record_t){ t - first, offset + 1, r.incl_len - 1, obj->data[offset] };
+        offset += r.incl_len;
+    }
+    return 0;
+}
+
+isn_replay_t *isn_replay_create(const char *filename, isn_layer_t *child) {
+    isn_replay_t *obj = calloc(1, sizeof(isn_replay_t));
+    FILE *f = fopen(filename, "rb");
+    if (!obj || !f || load(obj, f) < 0) {
+        if (f) fclose(f);
+        isn_replay_drop(obj);
+        return NULL;
+    }
+    fclose(f);
+
+    obj->drv.getsendbuf = replay_getsendbuf;
+    obj->drv.send       = replay_send;
+    obj->drv.free       = replay_free;
+    obj->child          = child;
+    isn_replay_rewind(obj);
+    return obj;
+}
+
+void isn_replay_drop(isn_replay_t *obj) {
+    if (!obj) return;
+    free(obj->records);
+    free(obj->data);
+    free(obj);
+}
+
+void isn_replay_setspeed(isn_replay_t *obj, double speed) {
+    obj->speed = speed;
+    obj->start_ns = 0;
+}
+
+void isn_replay_rewind(isn_replay_t *obj) {
+    obj->rx_next = obj->rx_offset = obj->tx_next = obj->mismatches = 0;
+    obj->start_ns = 0;
+    memset(&obj->drv.stats, 0, sizeof(obj->drv.stats));
+    obj->rx_left = 0;
+    for (uint32_t i = 0; i < obj->count; i++) obj->rx_left += (obj->records[i].dir == ISN_CAPTURE_RX);
+    while (obj->rx_next < obj->count && obj->records[obj->rx_next].dir != ISN_CAPTURE_RX) obj->rx_next++;
+    obj->first_ns = (obj->rx_next < obj->count) ? obj->records[obj->rx_next].t_ns : 0;
+}
+
+int isn_replay_poll(isn_replay_t *obj) {
+    if (obj->rx_next >= obj->count) return 0;
+    const replay_record_t *r = &obj->records[obj->rx_next];
+
+    if (obj->speed > 0) {
+        uint64_t now = clock_ns(CLOCK_MONOTONIC);
+        if (!obj->start_ns) obj->start_ns = now;
+        uint64_t due = obj->start_ns + (uint64_t)((r->t_ns - obj->first_ns) / obj->speed);
+        if (due > now) {
+            struct timespec ts = { (due - now) / 1000000000ULL, (due - now) % 1000000000ULL };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    size_t accepted = obj->child->recv(obj->child, &obj->data[r->offset + obj->rx_offset], r->size - obj->rx_offset, obj);
+    obj->rx_offset += accepted;
+    if (!accepted && r->size) obj->drv.stats.rx_retries++;
+    if (obj->rx_offset >= r->size) {
+        obj->drv.stats.rx_packets++;
+        obj->drv.stats.rx_counter += r->size;
+        obj->rx_offset = 0;
+        obj->rx_left--;
+        do obj->rx_next++; while (obj->rx_next < obj->count && obj->records[obj->rx_next].dir != ISN_CAPTURE_RX);
+    }
+    return obj->rx_left;
+}
+
+uint32_t isn_replay_mismatches(const isn_replay_t *obj) {
+    return obj->mismatches;
+}
+
+/** \} \endcond */
@@ -0,0 +1,551 @@
+/** \file
+ *  \brief Isotel Sensor Network Reactor Implementation for Hosts
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_reactor.h
+ */
+/**
+ * \ingroup GR_ISN_POSIX
+ * \cond Implementation
+ * \addtogroup GR_ISN_Reactor
+ *
+ * Same reactor as the MCU one, however links, mutexes and indices are kept in
+ * separate 32-bit fields instead of being packed into the tasklet pointer, so
+ * the number of pending tasklets is not limited to 255, but to 1M by the handle.
+ *
+ * Entries are allocated in chunks, which are never moved or freed while the
+ * reactor is in use, so an entry stays in place while its tasklet executes.
+ * When no entry is free, a new chunk is added instead of failing the queuing.
+ * Freed entries are reused in FIFO order, to keep the same entry, and thus
+ * the generation of its handle, from being reused right away.
+ *
+ * Queuing and modifications may be called from other threads, the step
+ * itself must be called from a single thread only.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "isn_reactor.h"
+
+/**\{ */
+
+#ifndef CONFIG_ISN_REACTOR_CHUNK
+#define CONFIG_ISN_REACTOR_CHUNK    64          ///< Default number of entries added at once
+#endif
+
+#define NONE                        UINT32_MAX
+#define HANDLE_INDEX_BITS           20          ///< Up to 1M pending tasklets, the remaining 11 bits carry the generation
+#define HANDLE_INDEX_MASK           ((1UL << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GEN_MASK             0x7FF
+#define HANDLE_GEN(g)               ((uint32_t)((g) & HANDLE_GEN_MASK) << HANDLE_INDEX_BITS)
+#define HANDLE(i)                   ((int)(HANDLE_GEN(ENTRY(i)->e.gen) | (i)))
+#define HANDLE_INDEX(h)             ((uint32_t)((uint32_t)(h) & HANDLE_INDEX_MASK))
+
+#define ENTRY(i)                    (&chunks[(i) >> chunk_shift][(i) & chunk_mask])
+
+#define MAX_SLEEP_TIME              0x0FFFFFFF
+
+typedef struct {
+    isn_tasklet_entry_t e;
+    uint32_t next;
+    isn_reactor_mutex_t mutex;
+} entry_t;
+
+isn_clock_counter_t _isn_reactor_active_timestamp;
+isn_clock_counter_t isn_reactor_timer_trigger;
+
+uint32_t isn_tasklet_queue_size = 0;
+uint32_t isn_tasklet_queue_max = 0;
+uint32_t isn_tasklet_lateness_max = 0;
+uint32_t isn_tasklet_queue_capacity = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static entry_t **chunks = NULL;
+static uint32_t nchunks = 0;
+static uint32_t chunk_shift = 0, chunk_mask = 0;
+
+static uint32_t head = NONE, tail = NONE;               ///< Pending tasklets
+static uint32_t free_head = NONE, free_tail = NONE;     ///< Free entries
+
+static volatile isn_reactor_mutex_t queue_mutex_locked_bits = 0;
+static volatile uint32_t queue_changed = 0;
+static int64_t self_index = -1;
+static entry_t *self_entry = NULL;                      ///< Of the self_index, as chunks may be reallocated meanwhile
+static isn_argpool_t *argpool = NULL;
+
+static void *dropped_tasklet(void *arg) {
+    (void)arg;
+    return NULL;
+}
+
+static inline void critical_section_enter(void) {
+    pthread_mutex_lock(&lock);
+}
+
+static inline void critical_section_exit(void) {
+    pthread_mutex_unlock(&lock);
+}
+
+static void free_entry(uint32_t index) {
+    entry_t *e = ENTRY(index);
+    e->e.tasklet = NULL;
+    e->e.pooled  = NULL;
+    e->e.gen++;
+    e->next = NONE;
+    if (free_tail != NONE) ENTRY(free_tail)->next = index; else free_head = index;
+    free_tail = index;
+}
+
+/** Adds a chunk of entries to the free list \returns 0 on success */
+static int grow(void) {
+    uint32_t first = nchunks << chunk_shift;
+    if ((uint64_t)first + chunk_mask + 1 > HANDLE_INDEX_MASK) return -1;
+
+    entry_t **grown = realloc(chunks, (nchunks + 1) * sizeof(entry_t *));
+    if (!grown) return -1;
+    chunks = grown;
+    if (!(chunks[nchunks] = calloc(chunk_mask + 1, sizeof(entry_t)))) return -1;
+    nchunks++;
+
+    for (uint32_t i = first; i <= first + chunk_mask; i++) free_entry(i);
+    isn_tasklet_queue_capacity += chunk_mask + 1;
+    return 0;
+}
+
+static int queue_entry(const isn_reactor_tasklet_t tasklet, isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                       void* arg, void *pooled, isn_clock_counter_t time, isn_reactor_mutex_t mutex_bits) {
+    if (tasklet == NULL) return -1;
+
+    critical_section_enter();
+    if (free_head == NONE && grow() < 0) {
+        critical_section_exit();
+        return -1;
+    }
+    uint32_t index = free_head;
+    entry_t *e = ENTRY(index);
+    free_head = e->next;
+    if (free_head == NONE) free_tail = NONE;
+
+    e->e.tasklet      = tasklet;
+    e->e.caller       = caller;
+    e->e.caller_queue = caller_queue;
+    e->e.arg          = arg;
+    e->e.pooled       = pooled;
+    e->e.time         = time;
+    e->mutex          = mutex_bits;
+    e->next           = NONE;
+    if (tail != NONE) ENTRY(tail)->next = index; else head = index;
+    tail = index;
+
+    if (++isn_tasklet_queue_size > isn_tasklet_queue_max) isn_tasklet_queue_max = isn_tasklet_queue_size;
+    queue_changed = 1;
+    int handle = HANDLE(index);
+    critical_section_exit();
+    return handle;
+}
+
+void isn_reactor_initchannel(isn_tasklet_queue_t *queue, isn_tasklet_entry_t* fifobuf, size_t size_mask) {
+    if (fifobuf && size_mask) {
+        queue->fifo = fifobuf;
+        queue->size_mask = size_mask;
+        queue->rdi = queue->wri = 0;
+        queue->wakeup = NULL;
+    }
+}
+
+static int channel_push(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+                        isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                        void* arg, void *pooled, isn_clock_counter_t timed) {
+    size_t next = (queue->wri+1) & queue->size_mask;
+    if (queue->rdi != next) {
+        isn_tasklet_entry_t *e = &queue->fifo[queue->wri];
+        e->tasklet = tasklet;
+        e->caller = caller;
+        e->caller_queue = caller_queue;
+        e->arg = arg;
+        e->pooled = pooled;
+        e->time = timed;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        queue->wri = next;
+        if (queue->wakeup) queue->wakeup();
+        return 0;
+    }
+    return -1;
+}
+
+int isn_reactor_channel_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed) {
+    return channel_push(queue, tasklet, NULL, NULL, arg, NULL, timed);
+}
+
+int isn_reactor_channel_call_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+                                isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                                void* arg, isn_clock_counter_t timed) {
+    return channel_push(queue, tasklet, caller_queue, caller, arg, NULL, timed);
+}
+
+int isn_reactor_channel_call_copy_at(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t tasklet,
+                                     isn_tasklet_queue_t *caller_queue, const isn_reactor_tasklet_t caller,
+                                     const void *data, size_t size, isn_clock_counter_t timed) {
+    void *arg = argpool ? isn_argpool_copy(argpool, data, size) : NULL;
+    if (!arg) return -1;
+    int retval = channel_push(queue, tasklet, caller_queue, caller, arg, arg, timed);
+    if (retval < 0) isn_argpool_free(arg);
+    return retval;
+}
+
+static int isn_reactor_channel_return(isn_tasklet_queue_t *queue, const isn_reactor_tasklet_t caller, void* arg, void *pooled) {
+    return channel_push(queue, NULL, NULL, caller, arg, pooled, ISN_CLOCK_NOW);
+}
+
+int isn_reactor_pass(const isn_reactor_tasklet_t tasklet, void* arg) {
+    if (self_index < 0) return -1;
+    entry_t *self = self_entry;
+    void *pooled = (arg && arg == self->e.pooled) ? arg : NULL;
+    int handle = queue_entry(tasklet, self->e.caller_queue, self->e.caller, arg, pooled, ISN_CLOCK_NOW, 0);
+    if (handle >= 0) {
+        self->e.caller       = NULL;
+        self->e.caller_queue = NULL;
+        if (pooled) self->e.pooled = NULL;
+    }
+    return handle;
+}
+
+int isn_reactor_call_at(const isn_reactor_tasklet_t tasklet, const isn_reactor_tasklet_t caller, void* arg, isn_clock_counter_t time) {
+    return queue_entry(tasklet, NULL, caller, arg, NULL, time, 0);
+}
+
+void isn_reactor_setargpool(isn_argpool_t *pool) {
+    argpool = pool;
+}
+
+int isn_reactor_call_copy_at(const isn_reactor_tasklet_t tasklet, const isn_reactor_tasklet_t caller, const void *data, size_t size, isn_clock_counter_t time) {
+    void *arg = argpool ? isn_argpool_copy(argpool, data, size) : NULL;
+    if (!arg) return -1;
+    int handle = queue_entry(tasklet, NULL, caller, arg, arg, time, 0);
+    if (handle < 0) isn_argpool_free(arg);
+    return handle;
+}
+
+int isn_reactor_userqueue(const isn_reactor_tasklet_t tasklet, void* arg, isn_clock_counter_t timed, isn_reactor_mutex_t mutex_bits) {
+    return queue_entry(tasklet, NULL, NULL, arg, NULL, timed, mutex_bits);
+}
+
+isn_reactor_mutex_t isn_reactor_getmutex() {
+    static uint32_t muxes = 0;
+    return muxes >= 8*sizeof(isn_reactor_mutex_t) ? 0 : (isn_reactor_mutex_t)1 << muxes++;
+}
+
+int isn_reactor_mutex_lock(isn_reactor_mutex_t mutex_bits) {
+    isn_reactor_mutex_t old_locks = __atomic_fetch_or(&queue_mutex_locked_bits, mutex_bits, __ATOMIC_ACQ_REL);
+    return (old_locks | mutex_bits) == old_locks;
+}
+
+int isn_reactor_mutex_unlock(isn_reactor_mutex_t mutex_bits) {
+    isn_reactor_mutex_t old_locks = __atomic_fetch_and(&queue_mutex_locked_bits, ~mutex_bits, __ATOMIC_ACQ_REL);
+    if ((old_locks & ~mutex_bits) == old_locks) return 1;
+    queue_changed = 1;
+    return 0;
+}
+
+int isn_reactor_mutex_is_locked(isn_reactor_mutex_t mutex_bits) {
+    return (queue_mutex_locked_bits & mutex_bits) != 0;
+}
+
+int isn_reactor_mutexqueue(const isn_reactor_tasklet_t tasklet, void* arg, isn_reactor_mutex_t mutex_bits) {
+    return queue_entry(tasklet, NULL, NULL, arg, NULL, ISN_CLOCK_NOW, mutex_bits);
+}
+
+static int handle_isvalid(int handle) {
+    if (handle < 0) return 0;
+    uint32_t index = HANDLE_INDEX(handle);
+    return (index < (nchunks << chunk_shift) && HANDLE(index) == handle && ENTRY(index)->e.tasklet) ? 1 : 0;
+}
+
+static void drop_entry(uint32_t index) {
+    entry_t *e = ENTRY(index);
+    e->e.tasklet      = dropped_tasklet;
+    e->e.caller       = NULL;
+    e->e.caller_queue = NULL;
+    e->e.time         = ISN_CLOCK_NOW - 1;
+    e->mutex          = 0;
+    isn_argpool_free(e->e.pooled);
+    e->e.pooled       = NULL;
+    e->e.gen++;
+    queue_changed = 1;
+}
+
+static int entry_isvalid(int index, const isn_reactor_tasklet_t tasklet, const void* arg) {
+    if (!handle_isvalid(index)) return 0;
+    entry_t *e = ENTRY(HANDLE_INDEX(index));
+    return (e->e.tasklet == tasklet && e->e.arg == arg) ? 1 : 0;
+}
+
+int isn_reactor_isvalid(int index, const isn_reactor_tasklet_t tasklet, const void* arg) {
+    critical_section_enter();
+    int retval = entry_isvalid(index, tasklet, arg);
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_change_timed(int index, const isn_reactor_tasklet_t tasklet, const void* arg, isn_clock_counter_t newtime) {
+    critical_section_enter();
+    int retval = entry_isvalid(index, tasklet, arg);
+    if (retval) {
+        ENTRY(HANDLE_INDEX(index))->e.time = newtime;
+        queue_changed = 1;
+    }
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_valid(int handle) {
+    critical_section_enter();
+    int retval = handle_isvalid(handle);
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_retime(int handle, isn_clock_counter_t newtime) {
+    critical_section_enter();
+    int retval = handle_isvalid(handle);
+    if (retval) {
+        ENTRY(HANDLE_INDEX(handle))->e.time = newtime;
+        queue_changed = 1;
+    }
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_cancel(int handle) {
+    critical_section_enter();
+    int retval = handle_isvalid(handle) && HANDLE_INDEX(handle) != self_index;
+    if (retval) drop_entry(HANDLE_INDEX(handle));
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_change_timed_self(isn_clock_counter_t newtime) {
+    if (self_index >= 0) {
+        self_entry->e.time = newtime;
+        queue_changed = 1;
+        return 0;
+    }
+    return -1;
+}
+
+int isn_reactor_change_mutex_self(isn_reactor_mutex_t mutex_bits) {
+    if (self_index >= 0) {
+        critical_section_enter();
+        self_entry->mutex = mutex_bits;
+        queue_changed = 1;
+        critical_section_exit();
+        return 0;
+    }
+    return -1;
+}
+
+int isn_reactor_self(void) {
+    if (self_index < 0) return -1;
+    return (int)(HANDLE_GEN(self_entry->e.gen) | (uint32_t)self_index);
+}
+
+int isn_reactor_drop(int index, const isn_reactor_tasklet_t tasklet, const void* arg) {
+    critical_section_enter();
+    int retval = entry_isvalid(index, tasklet, arg) && HANDLE_INDEX(index) != self_index;
+    if (retval) drop_entry(HANDLE_INDEX(index));
+    critical_section_exit();
+    return retval;
+}
+
+int isn_reactor_dropall(const isn_reactor_tasklet_t tasklet, const void* arg) {
+    int removed = 0;
+    critical_section_enter();
+    for (uint32_t j = head; j != NONE; j = ENTRY(j)->next) {
+        entry_t *e = ENTRY(j);
+        if (j != self_index && e->e.tasklet == tasklet && e->e.arg == arg) {
+            drop_entry(j);
+            removed++;
+        }
+    }
+    critical_section_exit();
+    return removed;
+}
+
+/** Executes all due tasklets in a single pass, see the MCU implementation for the rules */
+int isn_reactor_step(void) {
+    int executed = 0;
+    int32_t next_time_to_exec = MAX_SLEEP_TIME;
+
+    if (queue_changed || (int32_t)(isn_reactor_timer_trigger - ISN_CLOCK_NOW) <= 0) {
+        queue_changed = 0;
+
+        critical_section_enter();
+        for (uint32_t i = NONE, j = head; j != NONE; ) {
+            entry_t *e = ENTRY(j);
+            if (e->mutex & queue_mutex_locked_bits) goto do_next_event;
+
+            int32_t time_to_exec = isn_clock_remains(e->e.time);
+            if (time_to_exec > 0) {
+                if (time_to_exec < next_time_to_exec) next_time_to_exec = time_to_exec;
+                goto do_next_event;
+            }
+
+            isn_reactor_tasklet_t tasklet = e->e.tasklet;
+            if ((uint32_t)-time_to_exec > isn_tasklet_lateness_max) isn_tasklet_lateness_max = -time_to_exec;
+            _isn_reactor_active_timestamp = e->e.time;
+            self_index = j;
+            self_entry = e;
+            executed++;
+
+            critical_section_exit();
+            void *retval = tasklet(e->e.arg);
+            critical_section_enter();
+
+            // as on MCU, returning self or moving the time ahead keeps the entry, however the time
+            // must be strictly ahead, as the host clock may not have moved during the execution
+            time_to_exec = isn_clock_remains(e->e.time);
+            if (retval == (const void *)tasklet || time_to_exec > 0) {
+                if (time_to_exec < 0) {
+                    e->e.time = isn_clock_now();
+                    next_time_to_exec = 0;
+                }
+                else if (time_to_exec < next_time_to_exec) next_time_to_exec = time_to_exec;
+                goto do_next_event;
+            }
+
+            isn_reactor_tasklet_t caller = e->e.caller;
+            isn_tasklet_queue_t *caller_queue = e->e.caller_queue;
+            void *pooled = e->e.pooled;
+
+            // unlink, only the step removes entries, so the i remains the predecessor
+            uint32_t next = e->next;
+            if (i == NONE) head = next; else ENTRY(i)->next = next;
+            if (tail == j) tail = i;
+            free_entry(j);
+            isn_tasklet_queue_size--;
+            self_index = -1;
+
+            if (caller || pooled) {
+                critical_section_exit();
+                if (caller_queue && caller) {
+                    // the caller at the other core completes, and releases
+                    if (isn_reactor_channel_return(caller_queue, caller, retval, pooled) < 0) isn_argpool_free(pooled);
+                }
+                else {
+                    if (caller) caller(retval);
+                    isn_argpool_free(pooled);
+                }
+                critical_section_enter();
+            }
+            j = next;
+            continue;
+do_next_event:
+            i = j;
+            j = e->next;
+        }
+        self_index = -1;
+        critical_section_exit();
+        isn_reactor_timer_trigger = ISN_CLOCK_NOW + next_time_to_exec;
+    }
+    return executed;
+}
+
+isn_clock_counter_t isn_reactor_run(void) {
+    while( isn_reactor_step() );
+    return isn_reactor_timer_trigger;
+}
+
+isn_clock_counter_t isn_reactor_runall(isn_tasklet_queue_t *queue, ...) {
+    va_list va;
+    va_start(va, queue);
+    while(queue) {
+        while(queue->rdi != queue->wri) {
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            isn_tasklet_entry_t *e = &queue->fifo[queue->rdi];
+            if (e->tasklet) {
+                if (queue_entry( e->tasklet, e->caller_queue, e->caller, e->arg, e->pooled, e->time, 0 ) < 0) isn_argpool_free(e->pooled);
+            }
+            else {
+                if (e->caller) e->caller( e->arg );
+                isn_argpool_free(e->pooled);
+            }
+            queue->rdi = (queue->rdi+1) & queue->size_mask;
+        }
+        queue = va_arg(va, isn_tasklet_queue_t *);
+    }
+    va_end(va);
+
+    while( isn_reactor_step() );
+
+    return isn_reactor_timer_trigger;
+}
+
+void *isn_reactor_stats_cb(const void *arg) {
+    static isn_reactor_stats_t stats;
+    if (arg) {
+        isn_tasklet_queue_max = isn_tasklet_lateness_max = 0;
+    }
+    stats.queue_size     = isn_tasklet_queue_size;
+    stats.queue_max      = isn_tasklet_queue_max;
+    stats.lateness_max   = isn_tasklet_lateness_max;
+    stats.queue_capacity = isn_tasklet_queue_capacity;
+    return &stats;
+}
+
+static int selftest_count = 0;
+
+static void *selftest_event(void *arg) {
+    (void)arg;
+    selftest_count++;
+    return NULL;
+}
+
+int isn_reactor_selftest() {
+    isn_reactor_mutex_t mux = isn_reactor_getmutex();
+    selftest_count = 0;
+
+    isn_reactor_queue(selftest_event, NULL);
+    isn_reactor_run();
+    if (selftest_count != 1) return -1;
+    isn_reactor_mutex_lock( mux );
+    isn_reactor_mutexqueue(selftest_event, NULL, mux);
+    isn_reactor_run();
+    if (selftest_count != 1) return -2;
+    isn_reactor_mutex_unlock( mux );
+    isn_reactor_run();
+    if (selftest_count != 2) return -3;
+    return 0;
+}
+
+void isn_reactor_init(isn_tasklet_entry_t *tasklet_queue, size_t queue_size) {
+    (void)tasklet_queue;    // entries are allocated in chunks instead
+    critical_section_enter();
+    for (uint32_t i = 0; i < nchunks; i++) free(chunks[i]);
+    free(chunks);
+    chunks  = NULL;
+    nchunks = 0;
+
+    if (!queue_size) queue_size = CONFIG_ISN_REACTOR_CHUNK;
+    for (chunk_shift = 0; ((size_t)1 << chunk_shift) < queue_size; chunk_shift++);
+    chunk_mask = (1UL << chunk_shift) - 1;
+
+    head = tail = free_head = free_tail = NONE;
+    self_index = -1;
+    queue_changed = 0;
+    queue_mutex_locked_bits = 0;
+    isn_tasklet_queue_size = 0;
+    isn_tasklet_queue_max = 0;
+    isn_tasklet_lateness_max = 0;
+    isn_tasklet_queue_capacity = 0;
+    grow();
+    critical_section_exit();
+}
+
+/** \} \endcond */
@@ -383,6 +383,12 @@ isn_driver_stats_t* isn_serial_driver_get_stats(isn_serial_driver_t* driver) {
     return &(driver->drv.stats);
 }
 
+#ifndef _WIN32
+int isn_serial_driver_getfd(isn_serial_driver_t* driver) {
+    return driver->fd;
+}
+#endif
+
 #ifndef _WIN32
 static speed_t baud_rate_value_to_enum(int baud_rate) {
     speed_t ret;
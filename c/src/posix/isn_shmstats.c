@@ -0,0 +1,132 @@
+/** \file
+ *  \brief ISN Shared Memory Statistics Page Implementation
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_shmstats.h
+ */
+/**
+ * \ingroup GR_ISN_POSIX
+ * \cond Implementation
+ * \addtogroup GR_ISN_SHMSTATS
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <posix/isn_shmstats.h>
+
+/**\{ */
+
+struct isn_shmstats_s {
+    isn_shmstats_page_t *page;
+    size_t map_size;
+    int fd;
+    char *name;
+    const isn_driver_stats_t **sources;
+};
+
+isn_shmstats_t *isn_shmstats_create(const char *name, uint32_t capacity) {
+    isn_shmstats_t *obj = calloc(1, sizeof(isn_shmstats_t));
+    if (!obj) return NULL;
+
+    obj->map_size = isn_shmstats_pagesize(capacity);
+    obj->sources  = calloc(capacity, sizeof(*obj->sources));
+    obj->name     = strdup(name);
+    obj->fd       = shm_open(name, O_CREAT | O_RDWR, 0644);
+
+    if (!obj->sources || !obj->name || obj->fd < 0 || ftruncate(obj->fd, obj->map_size) < 0) goto error;
+    obj->page = mmap(NULL, obj->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, obj->fd, 0);
+    if (obj->page == MAP_FAILED) {
+        obj->page = NULL;
+        goto error;
+    }
+    memset(obj->page, 0, obj->map_size);
+    obj->page->version    = ISN_SHMSTATS_VERSION;
+    obj->page->capacity   = capacity;
+    obj->page->entry_size = sizeof(isn_shmstats_entry_t);
+    __atomic_store_n(&obj->page->magic, ISN_SHMSTATS_MAGIC, __ATOMIC_RELEASE);    // page is valid from now on
+    return obj;
+
+error:
+    isn_shmstats_drop(obj);
+    return NULL;
+}
+
+void isn_shmstats_drop(isn_shmstats_t *obj) {
+    if (!obj) return;
+    if (obj->page) munmap(obj->page, obj->map_size);
+    if (obj->fd >= 0) {
+        close(obj->fd);
+        shm_unlink(obj->name);
+    }
+    free(obj->name);
+    free(obj->sources);
+    free(obj);
+}
+
+static void write_begin(isn_shmstats_page_t *page) {
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void write_end(isn_shmstats_page_t *page) {
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELEASE);
+}
+
+int isn_shmstats_add_stats(isn_shmstats_t *obj, const char *name, const isn_driver_stats_t *stats, int parent) {
+    isn_shmstats_page_t *page = obj->page;
+    if (page->count >= page->capacity) return -1;
+
+    int index = page->count;
+    obj->sources[index] = stats;
+
+    write_begin(page);
+    isn_shmstats_entry_t *e = &page->entries[index];
+    strncpy(e->name, name, sizeof(e->name) - 1);
+    e->parent = (parent >= 0 && parent < index) ? parent : -1;
+    e->stats  = *stats;
+    page->count++;
+    write_end(page);
+    return index;
+}
+
+void isn_shmstats_update(isn_shmstats_t *obj) {
+    isn_shmstats_page_t *page = obj->page;
+    write_begin(page);
+    for (uint32_t i = 0; i < page->count; i++) {
+        page->entries[i].stats = *obj->sources[i];
+    }
+    page->updates++;
+    write_end(page);
+}
+
+int isn_shmstats_snapshot(const isn_shmstats_page_t *page, isn_shmstats_page_t *copy, int retries) {
+    if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != ISN_SHMSTATS_MAGIC ||
+        page->version != ISN_SHMSTATS_VERSION || page->entry_size != sizeof(isn_shmstats_entry_t)) {
+        return -1;
+    }
+    size_t size = isn_shmstats_pagesize(page->capacity);
+
+    while (retries-- > 0) {
+        uint32_t seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) continue;
+        memcpy(copy, page, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == seq) {
+            if (copy->count > copy->capacity) return -1;
+            return 0;
+        }
+    }
+    return -2;
+}
+
+/** \} \endcond */
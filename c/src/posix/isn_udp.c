@@ -16,6 +16,10 @@
  * (c) Copyright 2019, Isotel, http://isotel.org
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE         // recvmmsg()
+#endif
+
 #include <isn.h>
 #include <posix/isn_udp.h>
 #include <stdio.h>
@@ -70,6 +74,7 @@ typedef int SOCKET;
 #define MAXIMUM_PACKET_SIZE 64
 #define MAXIMUM_CLIENTS 32
 #define CLIENT_TIMEOUT_MS 5000
+#define MAXIMUM_BATCH 16    ///< Max number of datagrams read at once by the recvmmsg()
 
 static isn_logger_level_t isn_logger_level = ISN_LOGGER_LOG_LEVEL_FATAL;
 
@@ -192,6 +197,8 @@ static int send_buf(isn_layer_t* drv, void* buf, size_t sz) {
     isn_udp_driver_t* const driver = (isn_udp_driver_t*) drv;
     udp_clients_send(&driver->clients, driver->sock, buf, sz);
     free_send_buf(driver, buf);
+    driver->drv.stats.tx_packets++;
+    driver->drv.stats.tx_counter += sz;
     return 0;
 }
 
@@ -281,6 +288,42 @@ int isn_udp_driver_poll(isn_udp_driver_t* driver, time_ms_t timeout) {
     int ret = select(driver->sock + 1, &read_fds, NULL, NULL, &select_timeout);
 #endif
     if (ret != 0 && FD_ISSET(driver->sock, &read_fds)) {
+#if defined(__linux__)
+        /* Read all pending datagrams at once and pass them down as a single batch */
+        char bufs[MAXIMUM_BATCH][MAXIMUM_PACKET_SIZE];
+        struct sockaddr_in addrs[MAXIMUM_BATCH];
+        struct iovec iovs[MAXIMUM_BATCH];
+        struct mmsghdr msgs[MAXIMUM_BATCH];
+        isn_packet_t pkts[MAXIMUM_BATCH];
+
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < MAXIMUM_BATCH; i++) {
+            iovs[i].iov_base = bufs[i];
+            iovs[i].iov_len = MAXIMUM_PACKET_SIZE;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
+        const int n = recvmmsg(driver->sock, msgs, MAXIMUM_BATCH, MSG_DONTWAIT, NULL);
+        size_t count = 0;
+        for (int i = 0; i < n; i++) {
+            if (msgs[i].msg_len > 0) {
+                udp_clients_update(&driver->clients, (struct sockaddr*) &addrs[i], msgs[i].msg_hdr.msg_namelen);
+                pkts[count].src = bufs[i];
+                pkts[count].size = msgs[i].msg_len;
+                count++;
+                driver->drv.stats.rx_packets++;
+                driver->drv.stats.rx_counter += msgs[i].msg_len;
+            }
+        }
+        /* The batch stops at the first packet not accepted, the rest are delivered one by one as before */
+        for (size_t done = count ? isn_recv_batch(driver->child_driver, pkts, count, driver) : 0; done < count; done++) {
+            if (driver->child_driver->recv(driver->child_driver, pkts[done].src, pkts[done].size, driver) == 0) {
+                driver->drv.stats.rx_dropped++;
+            }
+        }
+#else
         char buf[MAXIMUM_PACKET_SIZE];
         struct sockaddr client_addr;
         socket_length_type sa_len = sizeof(struct sockaddr_in);
@@ -290,8 +333,11 @@ int isn_udp_driver_poll(isn_udp_driver_t* driver, time_ms_t timeout) {
             //for (int i=0; i<sz; i++) printf("%.2x ", buf[i]); 
             //printf(": udp recv %ld bytes:\n", sz);
             udp_clients_update(&driver->clients, &client_addr, sa_len);
+            driver->drv.stats.rx_packets++;
+            driver->drv.stats.rx_counter += sz;
             driver->child_driver->recv(driver->child_driver, buf, sz, driver);
         }
+#endif
     }
     return driver->clients.active_clients;
 }
@@ -300,4 +346,14 @@ void isn_udp_driver_setlogging(isn_logger_level_t level) {
     isn_logger_level = level;
 }
 
+isn_driver_stats_t* isn_udp_driver_get_stats(isn_udp_driver_t* driver) {
+    return &(driver->drv.stats);
+}
+
+#ifndef _WIN32
+int isn_udp_driver_getfd(isn_udp_driver_t* driver) {
+    return driver->sock;
+}
+#endif
+
 /** \} \endcond */
@@ -188,7 +188,9 @@ void isn_uart_init(isn_uart_t *obj, isn_layer_t* child, uint8_t port)
     obj->drv.getsendbuf = isn_uart_getsendbuf;
     obj->drv.send = isn_uart_send;
     obj->drv.recv = NULL;
+    obj->drv.recv_batch = NULL;
     obj->drv.free = isn_uart_free;
+    obj->drv.memclass = ISN_MEMCLASS_DMA;      // buffers are accessed by the uDMA
     obj->child_driver = child;
     obj->buf_locked = 0;
 
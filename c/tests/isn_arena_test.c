@@ -0,0 +1,43 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+
+ISN_ARENA_STATIC(pool, 256);
+
+int user_packets;
+
+static size_t user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    user_packets++;
+    return size;
+}
+
+int main(int argc, char *argv[]) {
+    /* Static pool: aligned, zeroed, and bounded */
+    uint8_t *a = isn_arena_alloc(&pool, 10);
+    uint8_t *b = isn_arena_alloc(&pool, 10);
+    if (!a || !b || (uintptr_t)a % CONFIG_ISN_ARENA_ALIGN || (uintptr_t)b % CONFIG_ISN_ARENA_ALIGN) return -1;
+    if (isn_arena_alloc(&pool, 256)) return -2;
+    isn_arena_reset(&pool);
+    if (!isn_arena_alloc(&pool, 256) || isn_arena_alloc(&pool, 1)) return -3;
+
+    /* Whole stack in a single block */
+    isn_arena_t *arena = isn_arena_create(1024);
+    isn_bindings_t *bindings = isn_arena_alloc(arena, 2 * sizeof(isn_bindings_t));
+    isn_receiver_t *user = ISN_ARENA_NEW(arena, isn_receiver_t);
+    isn_dispatch_t *dispatch = ISN_ARENA_NEW(arena, isn_dispatch_t);
+    isn_frame_t *frame = ISN_ARENA_NEW(arena, isn_frame_t);
+    if (!bindings || !user || !dispatch || !frame) return -4;
+    printf("stack of %zu bytes\n", arena->used);
+
+    user->recv = user_recv;
+    bindings[0] = (isn_bindings_t){ISN_PROTO_USER1, user};
+    bindings[1] = (isn_bindings_t){ISN_PROTO_LISTEND, NULL};
+    isn_dispatch_init(dispatch, bindings);
+    isn_frame_init(frame, ISN_FRAME_MODE_SHORT, dispatch, NULL, &(isn_driver_t){0}, ISN_CLOCK_ms(100));
+
+    const uint8_t f[] = {0x81, ISN_PROTO_USER1, 1};
+    frame->drv.recv(frame, f, sizeof(f), NULL);
+    isn_arena_drop(arena);
+    return (user_packets == 1) ? 0 : -5;
+}
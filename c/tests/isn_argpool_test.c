@@ -0,0 +1,43 @@
+#include <string.h>
+#include <stdio.h>
+#include "isn_argpool.h"
+
+ISN_ARGPOOL_STATIC(pool, 20, 40);
+
+int main(int argc, char *argv[]) {
+    void *slots[40];
+
+    /* Static pool: aligned, bounded by the size and by the number of slots */
+    if (isn_argpool_alloc(&pool, 21)) return -1;
+    for (int i = 0; i < 40; i++) {
+        slots[i] = isn_argpool_copy(&pool, &i, sizeof(i));
+        if (!slots[i] || (uintptr_t)slots[i] % 8) return -2;
+    }
+    if (isn_argpool_alloc(&pool, 1) || pool.failed != 1 || pool.used != 40 || pool.high != 40) return -3;
+    for (int i = 0; i < 40; i++) {
+        if (memcmp(slots[i], &i, sizeof(i))) return -4;
+    }
+
+    /* Released slots are reused, in any order */
+    isn_argpool_free(slots[35]);
+    isn_argpool_free(slots[3]);
+    isn_argpool_free(NULL);
+    if (pool.used != 38) return -5;
+    void *a = isn_argpool_alloc(&pool, 20), *b = isn_argpool_alloc(&pool, 20);
+    if (a != slots[3] || b != slots[35] || isn_argpool_alloc(&pool, 1)) return -6;
+    for (int i = 0; i < 40; i++) isn_argpool_free(slots[i]);
+    if (pool.used != 0) return -7;
+
+    /* Heap pool, slots are released to their own pool */
+    isn_argpool_t *heap = isn_argpool_create(100, 3);
+    void *h = isn_argpool_alloc(heap, 100);
+    void *s = isn_argpool_alloc(&pool, 1);
+    if (!h || !s || heap->used != 1 || pool.used != 1) return -8;
+    isn_argpool_free(h);
+    isn_argpool_free(s);
+    if (heap->used != 0 || pool.used != 0) return -9;
+    isn_argpool_drop(heap);
+
+    printf("slot of %u bytes\n", pool.slot_size);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+
+isn_dispatch_t dispatch;
+isn_frame_t frame;
+int user_packets, msg_packets, msg_batches, msg_busy;
+
+static size_t user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    user_packets++;
+    return size;
+}
+
+static size_t msg_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    msg_packets++;
+    return size;
+}
+
+static size_t msg_recv_batch(isn_layer_t *drv, const isn_packet_t *pkts, size_t count, isn_layer_t *caller) {
+    msg_batches++;
+    if (msg_busy && count > 1) count = 1;
+    msg_packets += count;
+    return count;
+}
+
+static isn_bindings_t bindings[] = {
+    {ISN_PROTO_USER1, &(isn_receiver_t){user_recv}},
+    {ISN_PROTO_MSG,   &(isn_receiver_t){msg_recv, msg_recv_batch}},
+    {ISN_PROTO_LISTEND, NULL}
+};
+
+int main(int argc, char *argv[]) {
+    const uint8_t u[] = {ISN_PROTO_USER1, 1}, m[] = {ISN_PROTO_MSG, 2, 3};
+    isn_packet_t pkts[] = {
+        {u, sizeof(u)}, {m, sizeof(m)}, {m, sizeof(m)}, {m, sizeof(m)}, {u, sizeof(u)}, {"\x55", 1}, {u, sizeof(u)}
+    };
+
+    /* Dispatch passes runs of the same protocol at once, and falls back to recv() */
+    isn_dispatch_init(&dispatch, bindings);
+    if (isn_recv_batch(&dispatch, pkts, ARRAY_SIZE(pkts), NULL) != ARRAY_SIZE(pkts)) return -1;
+    printf("user: %d, msg: %d in %d batches\n", user_packets, msg_packets, msg_batches);
+    if (user_packets != 3 || msg_packets != 3 || msg_batches != 1) return -2;
+
+    /* Busy receiver stops the batch at the first unprocessed packet */
+    msg_busy = 1;
+    if (isn_recv_batch(&dispatch, pkts, ARRAY_SIZE(pkts), NULL) != 2) return -3;
+
+    /* Frame decoder over several PHY reads, frames may span packets */
+    const uint8_t f1[] = {0x81, ISN_PROTO_USER1, 1, 0x81}, f2[] = {ISN_PROTO_USER1, 2};
+    isn_packet_t phy[] = {{f1, sizeof(f1)}, {f2, sizeof(f2)}};
+    user_packets = 0;
+    isn_frame_init(&frame, ISN_FRAME_MODE_SHORT, &dispatch, NULL, &(isn_driver_t){0}, ISN_CLOCK_ms(100));
+    if (isn_recv_batch(&frame, phy, ARRAY_SIZE(phy), NULL) != ARRAY_SIZE(phy)) return -4;
+    printf("frame: %d packets\n", user_packets);
+    if (user_packets != 2 || frame.drv.stats.rx_packets != 2) return -5;
+
+    return 0;
+}
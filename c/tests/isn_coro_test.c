@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include "isn_coro.h"
+
+/* Controlled time and a single entry reactor, implementing the parts the coroutines rely on */
+
+static isn_clock_counter_t now = 0;
+volatile const isn_clock_counter_t * const isn_clock_counter = &now;
+isn_clock_counter_t _isn_reactor_active_timestamp;
+
+static struct {
+    isn_reactor_tasklet_t tasklet;
+    void *arg;
+    isn_clock_counter_t time;
+    isn_reactor_mutex_t mutex;
+} entry;
+
+static int self_index = -1;
+static isn_reactor_mutex_t locked = 0;
+static int executions = 0;
+
+int isn_reactor_change_timed_self(isn_clock_counter_t newtime) {
+    if (self_index < 0) return -1;
+    entry.time = newtime;
+    return 0;
+}
+
+int isn_reactor_change_mutex_self(isn_reactor_mutex_t mutex_bits) {
+    if (self_index < 0) return -1;
+    entry.mutex = mutex_bits;
+    return 0;
+}
+
+int isn_reactor_self(void) {
+    return self_index;
+}
+
+int isn_reactor_retime(int handle, isn_clock_counter_t newtime) {
+    if (handle != 0 || !entry.tasklet) return 0;
+    entry.time = newtime;
+    return 1;
+}
+
+int isn_reactor_mutex_lock(isn_reactor_mutex_t mutex_bits) {
+    if (locked & mutex_bits) return -1;
+    locked |= mutex_bits;
+    return 0;
+}
+
+int isn_reactor_mutex_unlock(isn_reactor_mutex_t mutex_bits) {
+    locked &= ~mutex_bits;
+    return 0;
+}
+
+static void queue(isn_reactor_tasklet_t tasklet, void *arg) {
+    entry.tasklet = tasklet;
+    entry.arg     = arg;
+    entry.time    = now;
+    entry.mutex   = 0;
+}
+
+/** Executes the entry if due and not blocked \returns 1 while still queued */
+static int step(void) {
+    if (!entry.tasklet) return 0;
+    if (isn_clock_elapsed(entry.time) >= 0 && !(entry.mutex & locked)) {
+        self_index = 0;
+        _isn_reactor_active_timestamp = entry.time;
+        void *retval = entry.tasklet(entry.arg);
+        self_index = -1;
+        executions++;
+        if (retval != (void *)entry.tasklet) entry.tasklet = NULL;
+    }
+    return entry.tasklet != NULL;
+}
+
+/* Coroutine under the test */
+
+#define MUTEX_BUS   0x1
+
+typedef struct {
+    isn_coro_t co;
+    int i;
+    int trace[16];
+    int n;
+    int timeouts;
+} job_t;
+
+static job_t job = { .co = ISN_CORO_INIT };
+
+static void *job_task(void *arg) {
+    job_t *j = arg;
+    ISN_CORO_BEGIN(&j->co, job_task);
+
+    j->trace[j->n++] = 1;
+    ISN_CORO_YIELD(&j->co);
+    j->trace[j->n++] = 2;
+
+    for (j->i = 0; j->i < 3; j->i++) {
+        ISN_CORO_REPEAT(&j->co, 10);
+        j->trace[j->n++] = 10 + j->i;
+    }
+
+    ISN_CORO_LOCK(&j->co, MUTEX_BUS);
+    j->trace[j->n++] = 20;
+
+    ISN_CORO_WAIT(&j->co, 100);
+    j->timeouts += ISN_CORO_TIMEDOUT(&j->co);
+    ISN_CORO_WAIT(&j->co, 100);
+    j->timeouts += ISN_CORO_TIMEDOUT(&j->co);
+    isn_reactor_mutex_unlock(MUTEX_BUS);
+
+    ISN_CORO_DELAY(&j->co, 5);
+    j->trace[j->n++] = 30;
+
+    ISN_CORO_END(&j->co, NULL);
+}
+
+int main() {
+    queue(job_task, &job);
+
+    /* Yield resumes in the next pass, at the same time */
+    step();
+    if (job.n != 1 || job.trace[0] != 1) return -1;
+    step();
+    if (job.n != 2 || job.trace[1] != 2) return -2;
+
+    /* Periodic loop without accumulating the error, although executed late */
+    for (int k = 0; k < 3; k++) {
+        isn_clock_counter_t due = entry.time;
+        now = due - 1;
+        step();
+        if (job.n != 2 + k) return -3;
+        now = due + 3;
+        step();
+        if (job.n != 3 + k || job.trace[2 + k] != 10 + k) return -4;
+        if (k < 2 && entry.time != due + 10) return -5;
+    }
+
+    /* Mutex is held by someone else: no execution until unlocked */
+    isn_reactor_mutex_lock(MUTEX_BUS);
+    executions = 0;
+    step();
+    step();
+    if (executions != 0 || job.n != 5) return -6;
+    isn_reactor_mutex_unlock(MUTEX_BUS);
+    step();                                         // locks, and enters the first wait
+    if (job.n != 6 || job.trace[5] != 20 || !(locked & MUTEX_BUS)) return -7;
+
+    /* Notified wait resumes immediately */
+    now += 10;
+    step();
+    if (executions != 1) return -8;
+    if (isn_coro_notify(&job.co) != 1) return -9;
+    if (isn_coro_notify(&job.co) != 0) return -10;  // only once
+    step();
+    if (job.timeouts != 0) return -11;
+
+    /* Second wait times out */
+    now += 50;
+    step();
+    if (job.timeouts != 0) return -12;
+    now += 51;
+    step();
+    if (job.timeouts != 1 || (locked & MUTEX_BUS)) return -13;
+
+    /* Delay and finish */
+    now += 6;
+    if (step() != 0 || job.n != 7 || job.trace[6] != 30) return -14;
+    if (job.co.lc != 0) return -15;
+
+    printf("Coroutines passed in %d executions\n", executions);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define main isn_gateway_main
+#include "../tools/isn_gateway.c"
+#undef main
+
+/** Poll the route until the condition holds, or give up after a while */
+#define POLL_UNTIL(r, condition) \
+    for (int i = 0; i < 50 && !(condition); i++) { isn_serial_driver_poll((r)->serial, 10); isn_udp_driver_poll((r)->udp, 10); }
+
+static int write_config(const char *filename, const char *text) {
+    FILE *f = fopen(filename, "w");
+    if (!f) return -1;
+    fputs(text, f);
+    fclose(f);
+    return 0;
+}
+
+int main() {
+    char conf[64], text[512];
+    snprintf(conf, sizeof(conf), "/tmp/isn_gateway_test_%d.conf", (int)getpid());
+
+    /* Parsing, bad routes leave no routes behind */
+    write_config(conf, "# comment\n\nok /dev/null 115200 33010 compact 127.0.0.1:1 127.0.0.1:2\nbad /dev/null 115200 33011 none localhost\n");
+    if (load_config(conf) != -1 || routes || routes_size) return -1;
+    write_config(conf, "bad /dev/null 115200 33010 crc\n");
+    if (load_config(conf) != -1 || routes_size) return -2;
+    write_config(conf, "bad /dev/null 115200 99999 none\n");
+    if (load_config(conf) != -1 || routes_size) return -3;
+
+    /* Serial side is a pseudo terminal, UDP side a local socket */
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) return -4;
+    fcntl(master, F_SETFL, O_NONBLOCK);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in me = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t len = sizeof(me);
+    if (sock < 0 || bind(sock, (struct sockaddr *)&me, sizeof(me)) || getsockname(sock, (struct sockaddr *)&me, &len)) return -5;
+    fcntl(sock, F_SETFL, O_NONBLOCK);
+
+    uint16_t port = 34000 + getpid() % 1000;
+    snprintf(text, sizeof(text), "pty %s 115200 %u none 127.0.0.1:%u\n", ptsname(master), port, ntohs(me.sin_port));
+    write_config(conf, text);
+    if (load_config(conf) != 1 || routes[0].clients_size != 1 || routes[0].mode != FRAME_NONE) return -6;
+    route_t *r = &routes[0];
+    if (route_open(r)) return -7;
+
+    /* Serial to UDP */
+    char buf[64];
+    ssize_t n = 0;
+    if (write(master, "hello", 5) != 5) return -8;
+    POLL_UNTIL(r, (n = recv(sock, buf, sizeof(buf), 0)) > 0);
+    if (n != 5 || memcmp(buf, "hello", 5)) return -9;
+
+    /* UDP to serial */
+    struct sockaddr_in gw = {.sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    if (sendto(sock, "world", 5, 0, (struct sockaddr *)&gw, sizeof(gw)) != 5) return -10;
+    n = 0;
+    POLL_UNTIL(r, (n = read(master, buf, sizeof(buf))) > 0);
+    if (n != 5 || memcmp(buf, "world", 5)) return -11;
+
+    printf("Gateway forwarded %u and %u bytes\n", isn_serial_driver_get_stats(r->serial)->rx_counter, isn_udp_driver_get_stats(r->udp)->rx_counter);
+    route_close(r);
+    unload_config();
+    close(sock);
+    close(master);
+    unlink(conf);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+#include "isn_metrics.h"
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[64];
+    uint8_t last[64];
+    size_t last_size;
+}
+isn_tester_t;
+
+isn_tester_t tester;
+isn_message_t message;
+isn_metrics_t metrics;
+
+static isn_metric_t metric_table[4];
+static isn_msg_table_t msg_table[12] = {
+    {0, 0, NULL, "%T0{Metrics Test}"},
+};
+
+static uint32_t counters[2] = {7, 9};
+static void *counters_cb(const void *arg) { return counters; }
+
+static int tester_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void tester_free(isn_layer_t *drv, const void *ptr) {}
+
+static int tester_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    memcpy(obj->last, dest, size);
+    obj->last_size = size;
+    return size;
+}
+
+/** Reactor queue, keeps the last stream event */
+static int stream_events;
+static isn_reactor_tasklet_t stream_tasklet;
+
+static int fake_queue(const isn_reactor_tasklet_t tasklet, void *arg, isn_clock_counter_t timed, isn_reactor_mutex_t mutex_bits) {
+    if (arg == &metrics) {
+        stream_events++;
+        stream_tasklet = tasklet;
+    }
+    return 0;
+}
+
+/** Query arguments of a message, as host would, and return the reply */
+static const uint8_t *query(uint8_t msgnum) {
+    uint8_t q[2] = {ISN_PROTO_MSG, msgnum};
+    tester.last_size = 0;
+    message.drv.recv(&message, q, sizeof(q), &tester);
+    while (isn_msg_sched(&message));
+    return (tester.last_size > 2 && tester.last[1] == msgnum) ? &tester.last[2] : NULL;
+}
+
+int main(int argc, char *argv[]) {
+    tester.drv.getsendbuf = tester_getsendbuf;
+    tester.drv.send       = tester_send;
+    tester.drv.free       = tester_free;
+    tester.drv.stats.rx_packets = 42;
+
+    isn_metrics_init(&metrics, metric_table, ARRAY_SIZE(metric_table));
+    isn_metrics_add_layer(&metrics, "PHY ", &tester);
+    isn_metrics_add(&metrics, (isn_msg_table_t[]){
+        {0, sizeof(counters), counters_cb, "Counters {:a}={%lu}{:b}={%lu}"}
+    }, 1);
+
+    uint8_t size = isn_metrics_generate(&metrics, msg_table, 1, ARRAY_SIZE(msg_table));
+    printf("table size: %d\n", size);
+    if (size != 1 + 3 + 1 + 1) return -1;
+    if (strcmp(msg_table[1].desc, "PHY " ISN_DRIVER_STATS_DESC_RX) || strcmp(msg_table[5].desc, "%!")) return -2;
+
+    isn_msg_init(&message, msg_table, size, &tester);
+    while (isn_msg_sched(&message));
+
+    const isn_driver_stats_t *stats = (const isn_driver_stats_t *)query(1);
+    if (!stats || stats->rx_packets != 42) return -3;
+
+    const uint32_t *c = (const uint32_t *)query(4);
+    if (!c || c[0] != 7 || c[1] != 9) return -4;
+
+    /* Streaming from the main loop */
+    isn_metrics_stream(&metrics, &message, ISN_CLOCK_ms(1));
+    isn_metrics_post(&metrics);
+    if (msg_table[1].priority != ISN_MSG_PRI_LOW || msg_table[4].priority != ISN_MSG_PRI_LOW) return -5;
+    if (msg_table[2].priority) return -6;   // descriptor continuation is not posted
+
+    /* Generated table used as shared descriptors */
+    static uint8_t priorities[ARRAY_SIZE(msg_table)];
+    isn_msg_init_desc(&message, (const isn_msg_desc_t *)msg_table, priorities, size, &tester);
+    while (isn_msg_sched(&message));
+    tester.drv.stats.rx_packets = 43;
+    stats = (const isn_driver_stats_t *)query(1);
+    if (!stats || stats->rx_packets != 43) return -7;
+
+    /* Stopped and restarted before the event fires, a single event is kept */
+    isn_metrics_stream(&metrics, &message, 0);
+    message.queue = fake_queue;
+    isn_metrics_stream(&metrics, &message, ISN_CLOCK_ms(1));
+    isn_metrics_stream(&metrics, &message, 0);
+    isn_metrics_stream(&metrics, &message, ISN_CLOCK_ms(1));
+    if (stream_events != 1) return -8;
+    stream_events = 0;
+    stream_tasklet(&metrics);
+    isn_metrics_stream(&metrics, &message, ISN_CLOCK_ms(2));
+    if (stream_events != 1) return -9;                  // re-queued by the event only
+    isn_metrics_stream(&metrics, &message, 0);
+    stream_tasklet(&metrics);
+    isn_metrics_stream(&metrics, &message, ISN_CLOCK_ms(1));
+    if (stream_events != 2) return -10;                 // stopped event is gone, started again
+    message.queue = NULL;
+
+    return 0;
+}
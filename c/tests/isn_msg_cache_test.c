@@ -0,0 +1,118 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[128];
+    uint8_t last[128];
+    size_t last_size;
+    int sent;
+    int refuse;
+}
+isn_tester_t;
+
+isn_tester_t phy;
+isn_frame_t frame;
+isn_message_t message;
+
+static uint32_t counter = 5;
+static void *counter_cb(const void *data) { return &counter; }
+
+static isn_msg_table_t msg_table[] = {
+    {0, 0, NULL, "%T0{Cache Test}"},
+    {0, sizeof(counter), counter_cb, "Counter {:value}={%lu}"},
+    ISN_MSG_DESC_END(0)
+};
+
+static isn_msg_cache_entry_t entries[ARRAY_SIZE(msg_table)];
+static uint8_t cache_buf[40];
+static isn_msg_cache_t cache;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (dest && obj->refuse) {
+        obj->refuse--;
+        *dest = NULL;
+        return 0;
+    }
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+
+/** Keeps the first frame, as a descriptor is followed by the arguments */
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (!obj->sent++) {
+        memcpy(obj->last, dest, size);
+        obj->last_size = size;
+    }
+    return size;
+}
+
+static void request_desc(uint8_t msgnum) {
+    uint8_t q[] = {ISN_PROTO_MSG, 0x80 | msgnum};
+    phy.sent = 0;
+    message.drv.recv(&message, q, sizeof(q), &frame);
+    while (isn_msg_sched(&message));
+}
+
+int main(int argc, char *argv[]) {
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+
+    isn_frame_init(&frame, ISN_FRAME_MODE_COMPACT, &message, NULL, &phy, ISN_CLOCK_ms(100));
+    isn_msg_init(&message, msg_table, ARRAY_SIZE(msg_table), &frame);
+    while (isn_msg_sched(&message));
+
+    /* Reference frame, encoded by the frame layer */
+    request_desc(1);
+    uint8_t ref[128];
+    size_t ref_size = phy.last_size;
+    memcpy(ref, phy.last, ref_size);
+    if (ref_size != strlen(msg_table[1].desc) + 2 + 2) return -1;
+
+    isn_msg_cache_init(&cache, &isn_frame_encoder, &frame, &phy, entries, ARRAY_SIZE(entries), cache_buf, sizeof(cache_buf));
+    isn_msg_setcache(&message, &cache);
+
+    /* Encoded on first request, and reused afterwards */
+    uint32_t frame_packets = frame.drv.stats.tx_packets;
+    for (int i = 0; i < 2; i++) {
+        request_desc(1);
+        if (phy.last_size != ref_size || memcmp(phy.last, ref, ref_size)) return -2;
+        if (cache.used != ref_size || entries[1].size != ref_size) return -3;
+    }
+    if (frame.drv.stats.tx_packets - frame_packets != 4) return -4;   // two descriptors and args
+
+    /* Descriptors that do not fit are sent as usual */
+    if (isn_msg_cache_build(&message) != 2 || entries[0].size != 0 || entries[2].size == 0) return -5;
+    request_desc(0);
+    if (phy.last_size != strlen(msg_table[0].desc) + 4 || phy.last[2] != 0x80) return -6;
+
+    /* Refused by the phy, sent thru the frame layer instead */
+    phy.refuse = 1;
+    request_desc(1);
+    if (phy.sent != 2 || phy.last_size != ref_size || memcmp(phy.last, ref, ref_size)) return -7;
+
+    /* Descriptors longer than a frame are never cached */
+    static isn_msg_table_t long_table[] = {
+        {0, 0, NULL, "%T0{Cache Test}"},
+        {0, sizeof(counter), counter_cb, "Counter {:value}={%lu} {:a}={%lu} {:b}={%lu} {:c}={%lu} {:d}={%lu} {:e}={%lu}"},
+        ISN_MSG_DESC_END(0)
+    };
+    static isn_msg_cache_entry_t long_entries[ARRAY_SIZE(long_table)];
+    static uint8_t long_buf[256];
+    isn_msg_init(&message, long_table, ARRAY_SIZE(long_table), &frame);
+    while (isn_msg_sched(&message));
+    isn_msg_cache_init(&cache, &isn_frame_encoder, &frame, &phy, long_entries, ARRAY_SIZE(long_entries), long_buf, sizeof(long_buf));
+    isn_msg_setcache(&message, &cache);
+    if (strlen(long_table[1].desc) + 2 <= ISN_FRAME_MAXSIZE) return -8;
+    if (isn_msg_cache_build(&message) != 2 || long_entries[1].size != 0) return -9;
+
+    printf("Cached %u bytes\n", cache.used);
+    return 0;
+}
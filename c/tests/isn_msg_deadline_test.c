@@ -0,0 +1,96 @@
+#include <string.h>
+#include <stdio.h>
+#include "isn.h"
+
+static isn_clock_counter_t now = 1000;
+volatile const isn_clock_counter_t * const isn_clock_counter = &now;
+
+static isn_driver_t phy;
+static isn_message_t message;
+static uint8_t buf[64], order[16];
+static int sent;
+
+static uint16_t value = 0x1234;
+
+static void *value_cb(const void *data) {
+    return &value;
+}
+
+static isn_msg_table_t msg_table[] = {
+    {0, 0,              NULL,     "%T0{Deadline Test}"},
+    {0, sizeof(value),  value_cb, "A {:a}={%hu}"},
+    {0, sizeof(value),  value_cb, "B {:b}={%hu}"},
+    {0, sizeof(value),  value_cb, "C {:c}={%hu}"},
+    ISN_MSG_DESC_END(0)
+};
+
+static isn_clock_counter_t deadlines[ARRAY_SIZE(msg_table)];
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    if (dest) *dest = buf;
+    return (size > sizeof(buf)) ? sizeof(buf) : size;
+}
+
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    if (sent < (int)sizeof(order)) order[sent] = ((uint8_t *)dest)[1];
+    sent++;
+    return size;
+}
+
+static void sched(void) {
+    sent = 0;
+    memset(order, 0, sizeof(order));
+    while (isn_msg_sched(&message));
+}
+
+int main() {
+    phy.getsendbuf = phy_getsendbuf;
+    phy.send       = phy_send;
+
+    isn_msg_init(&message, msg_table, ARRAY_SIZE(msg_table), &phy);
+    sched();
+
+    /* Round-robin without deadlines, in the table order */
+    isn_msg_send_within(&message, 3, ISN_MSG_PRI_NORMAL, 10);
+    isn_msg_send(&message, 1, ISN_MSG_PRI_NORMAL);
+    isn_msg_send(&message, 2, ISN_MSG_PRI_NORMAL);
+    sched();
+    if (sent != 3 || order[0] != 1 || order[1] != 2 || order[2] != 3) return -1;
+
+    /* Earliest deadline first, then those without */
+    isn_msg_setdeadlines(&message, deadlines);
+    isn_msg_send(&message, 1, ISN_MSG_PRI_HIGH);
+    isn_msg_send_within(&message, 2, ISN_MSG_PRI_LOW, 100);
+    isn_msg_send_within(&message, 3, ISN_MSG_PRI_LOW, 20);
+    sched();
+    if (sent != 3 || order[0] != 3 || order[1] != 2 || order[2] != 1) return -2;
+    if (message.deadlines_met != 2 || message.deadlines_missed != 0 || deadlines[2] || deadlines[3]) return -3;
+
+    /* Earlier deadline is kept on repost, and later ones sent late are counted */
+    isn_msg_send_within(&message, 1, ISN_MSG_PRI_NORMAL, 50);
+    isn_msg_send_within(&message, 1, ISN_MSG_PRI_NORMAL, 10);
+    isn_msg_send_within(&message, 2, ISN_MSG_PRI_NORMAL, 30);
+    if (deadlines[1] != now + 10) return -4;
+    now += 40;
+    sched();
+    if (sent != 2 || order[0] != 1 || order[1] != 2) return -5;
+    if (message.deadlines_met != 2 || message.deadlines_missed != 2) return -6;
+
+    /* Requested descriptors go ahead of deadlines */
+    isn_msg_send_within(&message, 1, ISN_MSG_PRI_NORMAL, 10);
+    isn_msg_post(&message, 3, ISN_MSG_PRI_DESCRIPTION);
+    sched();
+    if (order[0] != (0x80 | 3) || order[1] != 1) return -7;
+
+    /* Cleared and discarded messages drop their deadlines, uncounted */
+    isn_msg_send_within(&message, 1, ISN_MSG_PRI_NORMAL, 10);
+    isn_msg_post(&message, 1, ISN_MSG_PRI_CLEAR);
+    isn_msg_send_within(&message, 2, ISN_MSG_PRI_NORMAL, 10);
+    isn_msg_discardpending(&message);
+    if (deadlines[1] || deadlines[2]) return -8;
+    sched();
+    if (sent != 0 || message.deadlines_met != 3 || message.deadlines_missed != 2) return -9;
+
+    printf("Deadlines met %u, missed %u\n", message.deadlines_met, message.deadlines_missed);
+    return 0;
+}
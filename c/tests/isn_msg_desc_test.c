@@ -0,0 +1,75 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[64];
+    uint8_t last[64];
+    size_t last_size;
+}
+isn_tester_t;
+
+isn_tester_t tester;
+isn_message_t dev1, dev2;
+
+static uint16_t value[2] = {10, 20};
+
+/** Shared by both devices, which are told apart by the isn_msg_self */
+static void *value_cb(const void *data) {
+    uint16_t *v = &value[isn_msg_self == &dev2];
+    if (data) *v = *(const uint16_t *)data;
+    return v;
+}
+
+static const isn_msg_desc_t descs[] = {
+    {0, 0, NULL, "%T0{Shared Test}", ISN_MSG_DESC_LEN("%T0{Shared Test}")},
+    {ISN_MSG_PRI_LOW, sizeof(uint16_t), value_cb, "Value {:v}={%u}"},
+    ISN_MSG_DESC_END(0)
+};
+static uint8_t priorities1[ARRAY_SIZE(descs)], priorities2[ARRAY_SIZE(descs)];
+
+static int tester_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void tester_free(isn_layer_t *drv, const void *ptr) {}
+
+static int tester_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    memcpy(obj->last, dest, size);
+    obj->last_size = size;
+    return size;
+}
+
+int main(int argc, char *argv[]) {
+    tester.drv.getsendbuf = tester_getsendbuf;
+    tester.drv.send       = tester_send;
+    tester.drv.free       = tester_free;
+
+    isn_msg_init_desc(&dev1, descs, priorities1, ARRAY_SIZE(descs), &tester);
+    isn_msg_init_desc(&dev2, descs, priorities2, ARRAY_SIZE(descs), &tester);
+    if (priorities1[1] != ISN_MSG_PRI_LOW || priorities2[1] != ISN_MSG_PRI_LOW || dev1.isn_msg_table) return -1;
+
+    /* Initial priorities are sent out per instance */
+    while (isn_msg_sched(&dev1));
+    if (tester.last_size != 4 || *(uint16_t *)&tester.last[2] != 10 || !isn_msg_isdone(&dev1, 1)) return -2;
+    if (isn_msg_isdone(&dev2, 1)) return -3;
+    while (isn_msg_sched(&dev2));
+    if (*(uint16_t *)&tester.last[2] != 20) return -4;
+
+    /* Host writes to the second device only */
+    uint8_t w[] = {ISN_PROTO_MSG, 1, 0x34, 0x12};
+    dev2.drv.recv(&dev2, w, sizeof(w), &tester);
+    while (isn_msg_sched(&dev2));
+    if (value[0] != 10 || value[1] != 0x1234) return -5;
+
+    isn_msg_send(&dev1, 1, ISN_MSG_PRI_NORMAL);
+    if (priorities1[1] != ISN_MSG_PRI_NORMAL || priorities2[1] != ISN_MSG_PRI_CLEAR) return -6;
+
+    printf("RAM per instance: %zu B table vs %zu B priorities\n", sizeof(isn_msg_table_t) * ARRAY_SIZE(descs), sizeof(priorities1));
+    return 0;
+}
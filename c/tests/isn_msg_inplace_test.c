@@ -0,0 +1,118 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[128];
+    uint8_t last[128];
+    size_t last_size;
+    int refuse;
+    int sent;
+    int freed;
+}
+isn_tester_t;
+
+isn_tester_t phy;
+isn_message_t message;
+
+typedef struct {
+    uint32_t seq;
+    uint16_t samples[32];
+} __attribute__((packed)) samples_t;
+
+static samples_t samples;
+static void *samples_out;
+static int samples_mode;
+
+static void *samples_cb(const void *data) {
+    samples_t *out = isn_msg_getoutbuf(&message);
+    samples_out = out;
+    if (out && isn_msg_getoutbuf(&message) != out) return NULL;     // must be stable within a call
+    if (!out || samples_mode == 1) out = &samples;
+    out->seq = 0x12345678;
+    for (int i = 0; i < 32; i++) out->samples[i] = i;
+    switch (samples_mode) {
+        case 2:  return NULL;                                       // reserved buffer is released
+        default: return out;                                        // mode 1 is copied into the reserved buffer
+    }
+}
+
+static isn_msg_table_t msg_table[] = {
+    {0, 0, NULL, "%T0{Inplace Test}"},
+    {0, sizeof(samples_t), samples_cb, "Samples {:seq}={%lu}{:s}={%hu}"},
+    ISN_MSG_DESC_END(0)
+};
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (dest && obj->refuse) {          // taken by someone else since the availability check
+        obj->refuse--;
+        *dest = NULL;
+        return 0;
+    }
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void phy_free(isn_layer_t *drv, const void *ptr) {
+    ((isn_tester_t *)drv)->freed++;
+}
+
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    obj->sent++;
+    memcpy(obj->last, dest, size);
+    obj->last_size = size;
+    return size;
+}
+
+static int check_reply(void) {
+    if (phy.sent != 1 || phy.last_size != sizeof(samples_t) + 2) return -1;
+    if (phy.last[0] != ISN_PROTO_MSG || phy.last[1] != 1) return -2;
+    const samples_t *s = (const samples_t *)&phy.last[2];
+    if (s->seq != 0x12345678 || s->samples[31] != 31) return -3;
+    return 0;
+}
+
+static void query(int mode) {
+    samples_mode = mode;
+    samples_out  = NULL;
+    phy.sent = phy.freed = 0;
+    memset(phy.last, 0, sizeof(phy.last));
+    isn_msg_send(&message, 1, ISN_MSG_PRI_NORMAL);
+    while (isn_msg_sched(&message));
+}
+
+int main(int argc, char *argv[]) {
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+
+    isn_msg_init(&message, msg_table, ARRAY_SIZE(msg_table), &phy);
+    while (isn_msg_sched(&message));
+
+    if (isn_msg_getoutbuf(&message) != NULL) return -10;        // outside a callback
+
+    /* Written in place */
+    query(0);
+    if (samples_out != phy.buf + 2) return -11;
+    if (check_reply()) return -12;
+
+    /* Other pointer is copied into the reserved buffer */
+    query(1);
+    if (samples_out != phy.buf + 2 || check_reply()) return -13;
+
+    /* Reserved buffer is released when there is no reply */
+    query(2);
+    if (phy.sent != 0 || phy.freed != 1) return -14;
+
+    /* Fallback to own storage when parent cannot provide the buffer */
+    phy.refuse = 1;
+    query(0);
+    if (samples_out != NULL || check_reply()) return -15;
+
+    printf("Sent %lu bytes in place\n", (unsigned long)phy.last_size);
+    return 0;
+}
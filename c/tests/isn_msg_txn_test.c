@@ -0,0 +1,181 @@
+#include <string.h>
+#include <stdio.h>
+#include "isn.h"
+
+/* Two message layers back to back, the requester and the device */
+typedef struct {
+    isn_driver_t drv;
+    isn_message_t *peer;
+    uint8_t buf[128];
+    uint8_t packet[128];
+    size_t size;
+    int sent;
+}
+isn_wire_t;
+
+static isn_wire_t wire_req, wire_dev;
+static isn_message_t requester, device;
+
+typedef struct {
+    uint16_t kp, ki, kd;
+} __attribute__((packed)) gains_t;
+
+typedef struct {
+    int16_t min, max;
+} __attribute__((packed)) limits_t;
+
+static gains_t gains[2];
+static limits_t limits[2];
+static int gains_calls[2], limits_calls[2];
+
+#define SIDE    (isn_msg_self == &device)
+
+static void *gains_cb(const void *data) {
+    if (data) {
+        gains[SIDE] = *(const gains_t *)data;
+        if (gains[SIDE].kp > 1000) gains[SIDE].kp = 1000;      // clamped by the device
+        gains_calls[SIDE]++;
+    }
+    return &gains[SIDE];
+}
+
+static void *limits_cb(const void *data) {
+    if (data) {
+        limits[SIDE] = *(const limits_t *)data;
+        limits_calls[SIDE]++;
+    }
+    return &limits[SIDE];
+}
+
+/** Rejects the limits with min above max */
+static void *validate_cb(const void *data) {
+    const uint8_t *records = data;
+    for (size_t pos = 0; pos < ISN_MSG_TXN_SIZE && records[pos]; ) {
+        if (records[pos] == 2) {
+            limits_t l;
+            memcpy(&l, &records[pos + 1], sizeof(l));
+            if (l.min > l.max) return NULL;
+        }
+        pos += 1 + (records[pos] == 1 ? sizeof(gains_t) : sizeof(limits_t));
+    }
+    return (void *)data;
+}
+
+#define MSG_TXN     3
+
+static const isn_msg_desc_t msg_desc[] = {
+    {0, 0,                  NULL,           "%T0{Transaction Test}"},
+    {0, sizeof(gains_t),    gains_cb,       "Gains {:kp}={%hu}{:ki}={%hu}{:kd}={%hu}"},
+    {0, sizeof(limits_t),   limits_cb,      "Limits {:min}={%d}{:max}={%d}"},
+    {0, ISN_MSG_TXN_SIZE,   isn_msg_txn_cb, "Transaction"},
+    ISN_MSG_DESC_END(0)
+};
+
+static uint8_t req_priorities[ARRAY_SIZE(msg_desc)], dev_priorities[ARRAY_SIZE(msg_desc)];
+static isn_msg_txn_t req_txn, dev_txn;
+
+static int wire_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_wire_t *obj = (isn_wire_t *)drv;
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static int wire_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_wire_t *obj = (isn_wire_t *)drv;
+    memcpy(obj->packet, dest, size);
+    obj->size = size;
+    obj->sent++;
+    return size;
+}
+
+/** Pass the packets over the wire until both sides are idle \returns number of packets */
+static int exchange(void) {
+    int packets = 0;
+    for (int i = 0; i < 10; i++) {
+        wire_req.size = wire_dev.size = 0;
+        isn_msg_sched(&requester);
+        if (wire_req.size) {
+            device.drv.recv(&device, wire_req.packet, wire_req.size, &wire_dev);
+            packets++;
+        }
+        isn_msg_sched(&device);
+        if (wire_dev.size) {
+            requester.drv.recv(&requester, wire_dev.packet, wire_dev.size, &wire_req);
+            packets++;
+        }
+        if (!wire_req.size && !wire_dev.size) break;
+    }
+    return packets;
+}
+
+int main() {
+    wire_req.drv.getsendbuf = wire_dev.drv.getsendbuf = wire_getsendbuf;
+    wire_req.drv.send = wire_dev.drv.send = wire_send;
+
+    isn_msg_init_desc(&requester, msg_desc, req_priorities, ARRAY_SIZE(msg_desc), &wire_req);
+    isn_msg_init_desc(&device, msg_desc, dev_priorities, ARRAY_SIZE(msg_desc), &wire_dev);
+    isn_msg_settxn(&requester, &req_txn, MSG_TXN, NULL);
+    isn_msg_settxn(&device, &dev_txn, MSG_TXN, validate_cb);
+    exchange();
+
+    /* Both updates in a single round trip, confirmed as applied */
+    gains_t g = {2000, 20, 3};
+    limits_t l = {-100, 100};
+    if (isn_msg_txn_commit(&requester) == 0) return -1;                // nothing to commit
+    if (isn_msg_txn_begin(&requester) || isn_msg_txn_add(&requester, 1, &g) || isn_msg_txn_add(&requester, 2, &l)) return -2;
+    if (isn_msg_txn_add(&requester, MSG_TXN, &g) == 0 || isn_msg_txn_add(&requester, 0, &g) == 0) return -3;
+    if (isn_msg_txn_commit(&requester) || req_txn.state != ISN_MSG_TXN_PENDING) return -4;
+    if (isn_msg_txn_begin(&requester) == 0) return -5;                 // still pending
+
+    int packets = exchange();
+    if (packets != 2 || wire_req.sent != 1 || wire_dev.sent != 1) return -6;
+    if (gains_calls[1] != 1 || limits_calls[1] != 1 || gains[1].kp != 1000 || limits[1].min != -100) return -7;
+    if (req_txn.state != ISN_MSG_TXN_APPLIED || dev_txn.state != ISN_MSG_TXN_APPLIED) return -8;
+    if (gains_calls[0] != 1 || limits_calls[0] != 1 || gains[0].kp != 1000 || gains[0].ki != 20 || limits[0].max != 100) return -9;
+
+    /* Rejected as a whole, none applied */
+    limits_t bad = {100, -100};
+    g.ki = 40;
+    isn_msg_txn_begin(&requester);
+    isn_msg_txn_add(&requester, 1, &g);
+    isn_msg_txn_add(&requester, 2, &bad);
+    isn_msg_txn_commit(&requester);
+    if (exchange() != 2) return -10;
+    if (req_txn.state != ISN_MSG_TXN_REJECTED || dev_txn.state != ISN_MSG_TXN_REJECTED) return -11;
+    if (gains_calls[1] != 1 || limits_calls[1] != 1 || gains[1].ki != 20 || gains_calls[0] != 1) return -12;
+
+    /* Records which do not fit are refused */
+    isn_msg_txn_begin(&requester);
+    int added = 0;
+    while (isn_msg_txn_add(&requester, 1, &g) == 0) added++;
+    if (added != ISN_MSG_TXN_SIZE / (1 + sizeof(gains_t))) return -13;
+
+    /* Lost confirmation is resent, and late duplicates are ignored */
+    isn_msg_txn_commit(&requester);
+    isn_msg_sched(&requester);
+    device.drv.recv(&device, wire_req.packet, wire_req.size, &wire_dev);
+    isn_msg_sched(&device);                                             // reply lost
+    isn_msg_resend_queries(&requester, 0);
+    if (exchange() != 2 || req_txn.state != ISN_MSG_TXN_APPLIED || gains[0].ki != 40) return -14;
+    requester.drv.recv(&requester, wire_dev.packet, wire_dev.size, &wire_req);
+    wire_req.sent = 0;
+    exchange();
+    if (wire_req.sent != 0 || req_txn.state != ISN_MSG_TXN_APPLIED) return -15;
+
+    /* Device begins the next one, and the former requester applies it */
+    limits_t dl = {-5, 5};
+    int req_limits = limits_calls[0];
+    if (isn_msg_txn_begin(&device) || isn_msg_txn_add(&device, 2, &dl) || isn_msg_txn_commit(&device)) return -16;
+    if (exchange() != 2 || dev_txn.state != ISN_MSG_TXN_APPLIED || req_txn.state != ISN_MSG_TXN_APPLIED) return -17;
+    if (limits_calls[0] != req_limits + 1 || limits[0].min != -5 || limits[1].max != 5) return -18;
+
+    /* And then the requester again */
+    g.kd = 7;
+    isn_msg_txn_begin(&requester);
+    isn_msg_txn_add(&requester, 1, &g);
+    isn_msg_txn_commit(&requester);
+    if (exchange() != 2 || req_txn.state != ISN_MSG_TXN_APPLIED || gains[1].kd != 7 || gains[0].kd != 7) return -19;
+
+    printf("Transaction applied %u %u %u, %d, %d\n", gains[1].kp, gains[1].ki, gains[1].kd, limits[1].min, limits[1].max);
+    return 0;
+}
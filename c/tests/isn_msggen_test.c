@@ -0,0 +1,76 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+#include "flashlight_msg.h"
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[64];
+    uint8_t last[64];
+    size_t last_size;
+}
+isn_tester_t;
+
+isn_tester_t tester;
+isn_message_t message;
+
+static uint64_t sno = 0x1234;
+static flashlight_led_t led = {1, 2, 3};
+static flashlight_temp_t temp = {21.5f, -3};
+
+void *id_cb(const void *data) { return &sno; }
+void *led_cb(const void *data) {
+    if (data) led = *(const flashlight_led_t *)data;
+    return &led;
+}
+void *temp_cb(const void *data) { return &temp; }
+
+static int tester_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void tester_free(isn_layer_t *drv, const void *ptr) {}
+
+/** Keeps the first reply, as a descriptor is followed by the arguments */
+static int tester_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (obj->last_size) return size;
+    memcpy(obj->last, dest, size);
+    obj->last_size = size;
+    return size;
+}
+
+static void request(const uint8_t *q, size_t size) {
+    tester.last_size = 0;
+    message.drv.recv(&message, q, size, &tester);
+    while (isn_msg_sched(&message));
+}
+
+int main(int argc, char *argv[]) {
+    tester.drv.getsendbuf = tester_getsendbuf;
+    tester.drv.send       = tester_send;
+    tester.drv.free       = tester_free;
+
+    if (sizeof(flashlight_led_t) != 3 || sizeof(flashlight_temp_t) != 6) return -1;
+    for (int i = 0; i < FLASHLIGHT_MSG_COUNT; i++) {
+        if (flashlight_msg_table[i].desc_len != strlen(flashlight_msg_table[i].desc)) return -2;
+    }
+    if (flashlight_msg_table[FLASHLIGHT_MSG_INFO].size || flashlight_msg_table[FLASHLIGHT_MSG_END].handler) return -3;
+
+    isn_msg_init(&message, flashlight_msg_table, FLASHLIGHT_MSG_COUNT, &tester);
+    while (isn_msg_sched(&message));
+
+    /* Descriptor is sent with the precomputed length */
+    request((uint8_t[]){ISN_PROTO_MSG, 0x80 | FLASHLIGHT_MSG_LED}, 2);
+    printf("%.*s\n", (int)tester.last_size - 2, &tester.last[2]);
+    if (tester.last_size != flashlight_msg_table[FLASHLIGHT_MSG_LED].desc_len + 2U) return -4;
+
+    /* Arguments map to the generated struct */
+    request((uint8_t[]){ISN_PROTO_MSG, FLASHLIGHT_MSG_LED, 4, 5, 6}, 5);
+    if (led.red != 4 || led.blue != 6 || tester.last_size != 5 || tester.last[4] != 6) return -5;
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+#include "isn_reactor.h"
+#include "isn_coro.h"
+
+static isn_clock_counter_t now = 1000;
+volatile const isn_clock_counter_t * const isn_clock_counter = &now;
+
+#define COUNT   1000
+
+static int order[COUNT], executed = 0;
+static int calls = 0, returned = 0;
+
+static void *record_event(void *arg) {
+    order[executed++] = (int)(intptr_t)arg;
+    return NULL;
+}
+
+static void *count_event(void *arg) {
+    calls++;
+    return arg;
+}
+
+static void *return_event(void *arg) {
+    returned = (int)(intptr_t)arg;
+    return NULL;
+}
+
+/** Re-triggers itself three times, one tick apart */
+static void *repeat_event(void *arg) {
+    if (++calls < 3) {
+        isn_reactor_change_timed_self(ISN_REACTOR_REPEAT_ticks(1));
+        return repeat_event;
+    }
+    return (void *)42;
+}
+
+typedef struct {
+    isn_coro_t co;
+    int state;
+} waiter_t;
+
+static waiter_t waiter = { .co = ISN_CORO_INIT };
+
+static void *waiter_task(void *arg) {
+    waiter_t *w = arg;
+    ISN_CORO_BEGIN(&w->co, waiter_task);
+    w->state = 1;
+    ISN_CORO_WAIT(&w->co, 1000);
+    w->state = ISN_CORO_TIMEDOUT(&w->co) ? -1 : 2;
+    ISN_CORO_END(&w->co, NULL);
+}
+
+ISN_ARGPOOL_STATIC(pool, 16, 4);
+
+static char seen[16];
+
+static void *print_event(void *arg) {
+    strcpy(seen, arg);
+    return arg;
+}
+
+static void *forward_event(void *arg) {
+    return (isn_reactor_pass(print_event, arg) < 0) ? NULL : arg;
+}
+
+static void *check_event(void *arg) {
+    returned = (strcmp(arg, seen) == 0) ? 1 : -1;     // argument is still valid in the caller
+    return NULL;
+}
+
+static void *notify_event(void *arg) {
+    isn_coro_notify(&((waiter_t *)arg)->co);
+    return NULL;
+}
+
+int main() {
+    /* Small chunks to force the growth */
+    isn_reactor_init(NULL, 4);
+    if (isn_reactor_selftest()) return -1;
+
+    for (int i = 0; i < COUNT; i++) {
+        if (isn_reactor_queue(record_event, (void *)(intptr_t)i) < 0) return -2;
+    }
+    if (isn_tasklet_queue_size != COUNT || isn_tasklet_queue_capacity < COUNT) return -3;
+    isn_reactor_run();
+    if (executed != COUNT || isn_tasklet_queue_size != 0 || isn_tasklet_queue_max < COUNT) return -4;
+    for (int i = 0; i < COUNT; i++) {
+        if (order[i] != i) return -5;
+    }
+    uint32_t capacity = isn_tasklet_queue_capacity;
+
+    /* Entries are reused, with the old handles invalid */
+    for (int i = 0; i < 2 * COUNT; i++) {
+        int h = isn_reactor_queue(count_event, NULL);
+        if (!isn_reactor_valid(h)) return -6;
+        isn_reactor_run();
+        if (isn_reactor_valid(h) || isn_reactor_isvalid(h, count_event, NULL)) return -7;
+    }
+    if (isn_tasklet_queue_capacity != capacity) return -8;
+
+    isn_reactor_init(NULL, 1);
+    int h0 = isn_reactor_queue(count_event, NULL);
+    isn_reactor_run();
+    int h1 = isn_reactor_queue(count_event, NULL);
+    if (isn_tasklet_queue_capacity != 1 || h0 == h1) return -9;     // same entry, another generation
+    if (isn_reactor_valid(h0) || isn_reactor_retime(h0, now) || isn_reactor_cancel(h0) || !isn_reactor_valid(h1)) return -10;
+    isn_reactor_run();
+
+    /* Retime and cancel by handle */
+    calls = 0;
+    int ht = isn_reactor_queue_at(count_event, NULL, now + 100);
+    int hc = isn_reactor_queue_at(count_event, NULL, now + 100);
+    if (!isn_reactor_retime(ht, now + 10) || !isn_reactor_cancel(hc) || isn_reactor_cancel(hc)) return -11;
+    now += 11;
+    isn_reactor_run();
+    if (calls != 1 || isn_reactor_valid(ht)) return -12;
+    now += 100;
+    isn_reactor_run();
+    if (calls != 1 || isn_tasklet_queue_size != 0) return -13;
+
+    /* Drop all of the same tasklet and arg, without calling their callers */
+    calls = returned = 0;
+    for (int i = 0; i < 5; i++) isn_reactor_call(count_event, return_event, (void *)1);
+    isn_reactor_call(count_event, return_event, (void *)2);
+    if (isn_reactor_dropall(count_event, (void *)1) != 5) return -14;
+    isn_reactor_run();
+    if (calls != 1 || returned != 2 || isn_tasklet_queue_size != 0) return -15;
+
+    /* Self re-triggering and return to the caller */
+    calls = returned = 0;
+    isn_reactor_call(repeat_event, return_event, NULL);
+    for (int i = 0; i < 5; i++) {
+        isn_reactor_run();
+        now++;
+    }
+    if (calls != 3 || returned != 42) return -16;
+
+    /* Mutex holds the tasklet back */
+    isn_reactor_mutex_t mux = isn_reactor_getmutex();
+    calls = 0;
+    isn_reactor_mutex_lock(mux);
+    isn_reactor_mutexqueue(count_event, NULL, mux);
+    isn_reactor_run();
+    if (calls != 0) return -17;
+    isn_reactor_mutex_unlock(mux);
+    isn_reactor_run();
+    if (calls != 1) return -18;
+
+    /* Coroutine waits in its entry, and is resumed by another tasklet */
+    isn_reactor_queue(waiter_task, &waiter);
+    isn_reactor_run();
+    if (waiter.state != 1 || isn_tasklet_queue_size != 1) return -19;
+    isn_reactor_queue_at(notify_event, &waiter, now + 10);
+    now += 10;
+    isn_reactor_run();
+    if (waiter.state != 2 || isn_tasklet_queue_size != 0) return -20;
+
+    /* Pooled arguments are released after the tasklet, its caller, on drop and when passed further */
+    isn_reactor_setargpool(&pool);
+    returned = 0;
+    isn_reactor_call_copy_at(print_event, check_event, "hello", 6, now);
+    if (pool.used != 1) return -21;
+    isn_reactor_run();
+    if (strcmp(seen, "hello") || returned != 1 || pool.used != 0) return -22;
+
+    for (int i = 0; i < 4; i++) {
+        if (isn_reactor_queue_copy(print_event, "x", 2) < 0) return -23;
+    }
+    if (isn_reactor_queue_copy(print_event, "x", 2) >= 0 || isn_reactor_call_copy_at(print_event, NULL, "too long for a slot", 20, now) >= 0) return -24;
+    if (isn_reactor_dropall(print_event, pool.slots + sizeof(isn_argpool_t *)) != 1 || pool.used != 3) return -25;
+    isn_reactor_run();
+    if (pool.used != 0 || isn_tasklet_queue_size != 0) return -26;
+
+    isn_reactor_queue_copy(forward_event, "passed", 7);
+    isn_reactor_run();
+    if (strcmp(seen, "passed") || pool.used != 0) return -27;
+
+    /* Cross-core, looped back over channels, the caller at the posting side releases */
+    static isn_tasklet_entry_t fifo_a[4], fifo_b[4];
+    static isn_tasklet_queue_t core_a = ISN_TASKLET_QUEUE_INIT, core_b = ISN_TASKLET_QUEUE_INIT;
+    isn_reactor_initchannel(&core_a, fifo_a, 3);
+    isn_reactor_initchannel(&core_b, fifo_b, 3);
+    returned = 0;
+    if (isn_reactor_channel_call_copy_at(&core_b, print_event, &core_a, check_event, "remote", 7, now) < 0) return -28;
+    isn_reactor_runall(&core_b, NULL);
+    if (strcmp(seen, "remote") || pool.used != 1 || returned != 0) return -29;
+    isn_reactor_runall(&core_a, NULL);
+    if (returned != 1 || pool.used != 0) return -30;
+
+    isn_reactor_stats_t *stats = isn_reactor_stats_cb(NULL);
+    printf("Reactor passed, capacity %u, max %u\n", stats->queue_capacity, stats->queue_max);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn_def.h"
+#include "isn_ring.h"
+
+static uint8_t buf[100];
+static isn_ring_t ring;
+
+int main(int argc, char *argv[]) {
+    void *dest;
+    const void *src;
+
+    /* Linear segments, wrap point is moved to cut the tail */
+    isn_ring_init(&ring, buf, sizeof(buf));
+    if (isn_ring_reserve(&ring, &dest, 200) != 99 || dest != buf) return -1;
+    if (isn_ring_reserve(&ring, &dest, 70) != 70) return -2;
+    isn_ring_commit(&ring, 70);
+    if (isn_ring_peek(&ring, &src) != 70 || src != buf) return -3;
+    isn_ring_consume(&ring, 60);
+    if (isn_ring_reserve(&ring, &dest, 40) != 40 || dest != buf) return -4;    // 29 free at the end, 59 at the start
+    isn_ring_commit(&ring, 40);
+    if (isn_ring_used(&ring) != 50) return -5;
+    if (isn_ring_peek(&ring, &src) != 10 || src != &buf[60]) return -6;
+    isn_ring_consume(&ring, 10);
+    if (isn_ring_peek(&ring, &src) != 40 || src != buf) return -7;
+    isn_ring_consume(&ring, 40);
+    if (isn_ring_peek(&ring, &src) != 0 || isn_ring_used(&ring)) return -8;
+
+    /* Byte access, one byte always remains unused */
+    isn_ring_reset(&ring);
+    for (int i=0; i<99; i++) if (isn_ring_putbyte(&ring, i)) return -9;
+    if (isn_ring_putbyte(&ring, 0) != -1) return -10;
+    for (int i=0; i<99; i++) if (isn_ring_getbyte(&ring) != i) return -11;
+    if (isn_ring_getbyte(&ring) != -1) return -12;
+
+    /* Randomly interleaved producer and consumer must preserve the stream */
+    isn_ring_init(&ring, buf, 97);
+    uint8_t wr_seq = 0, rd_seq = 0;
+    size_t total = 0;
+    srand(1);
+    for (int n=0; n<100000; n++) {
+        size_t size = isn_ring_reserve(&ring, &dest, 1 + rand() % 60);
+        if (size) {
+            size_t len = rand() % (size + 1);
+            for (size_t i=0; i<len; i++) ((uint8_t *)dest)[i] = wr_seq++;
+            isn_ring_commit(&ring, len);
+        }
+        size = isn_ring_peek(&ring, &src);
+        if (size) {
+            size_t len = rand() % (size + 1);
+            for (size_t i=0; i<len; i++) {
+                if (((const uint8_t *)src)[i] != rd_seq++) {
+                    printf("Mismatch after %zu bytes\n", total);
+                    return -13;
+                }
+            }
+            total += len;
+            isn_ring_consume(&ring, len);
+        }
+    }
+    printf("Streamed %zu bytes\n", total);
+    return total > 100000 ? 0 : -14;
+}
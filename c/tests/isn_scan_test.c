@@ -0,0 +1,79 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+#include "isn_scan.h"
+
+static uint8_t data[1024];
+static uint8_t other[1024];
+static size_t other_size = 0, other_calls = 0, frames = 0;
+
+static size_t ref_frame(const uint8_t *buf, size_t size) {
+    size_t i = 0;
+    while (i < size && buf[i] <= 0x80) i++;
+    return i;
+}
+
+static size_t ref_masked(const uint8_t *buf, size_t size, uint8_t mask, uint8_t value) {
+    size_t i = 0;
+    while (i < size && (buf[i] & mask) != value) i++;
+    return i;
+}
+
+static size_t other_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    memcpy(&other[other_size], src, size);
+    other_size += size;
+    other_calls++;
+    return size;
+}
+
+static size_t child_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    if (size == 3 && memcmp(src, "abc", 3) == 0) frames++;
+    return size;
+}
+
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) { return size; }
+
+int main() {
+    srand(1);
+
+    /* All positions and lengths, with a single header byte or none, against the byte by byte */
+    for (int value = 0; value < 256; value++) {
+        for (size_t pos = 0; pos < 80; pos++) {
+            memset(data, 'a', 80);
+            data[pos] = value;
+            for (size_t start = 0; start < 8; start++) {
+                size_t size = 80 - start;
+                if (isn_scan_frame(data + start, size) != ref_frame(data + start, size)) return -1;
+                if (isn_scan_masked(data + start, size, ISN_PROTO_FRAME_LONG_MASK, ISN_PROTO_FRAME_LONG) !=
+                    ref_masked(data + start, size, ISN_PROTO_FRAME_LONG_MASK, ISN_PROTO_FRAME_LONG)) return -2;
+                if (isn_scan_masked(data + start, size, ISN_PROTO_FRAME_JUMBO_MASK, ISN_PROTO_FRAME_JUMBO) !=
+                    ref_masked(data + start, size, ISN_PROTO_FRAME_JUMBO_MASK, ISN_PROTO_FRAME_JUMBO)) return -3;
+            }
+        }
+    }
+
+    /* Random content */
+    for (int n = 0; n < 10000; n++) {
+        size_t size = rand() % sizeof(data);
+        for (size_t i = 0; i < size; i++) data[i] = (rand() % 16) ? (rand() & 0x7F) : rand();
+        if (isn_scan_frame(data, size) != ref_frame(data, size)) return -4;
+        if (isn_scan_masked(data, size, 0xE0, 0x20) != ref_masked(data, size, 0xE0, 0x20)) return -5;
+    }
+
+    /* Runs of other data longer than the frame buffer and 255 bytes pass in one call each around the frame */
+    isn_frame_t frame;
+    isn_driver_t phy = {0};
+    phy.send = phy_send;
+    isn_frame_init(&frame, ISN_FRAME_MODE_SHORT, &(isn_receiver_t){child_recv}, &(isn_receiver_t){other_recv}, &phy, ISN_CLOCK_ms(100));
+
+    memset(data, 'x', 300);
+    memcpy(&data[300], "\x82" "abc", 4);
+    memset(&data[304], 'y', 400);
+    ((isn_driver_t *)&frame)->recv(&frame, data, 704, &phy);
+    if (frames != 1 || other_calls != 2 || other_size != 700) return -6;
+    if (other[0] != 'x' || other[299] != 'x' || other[300] != 'y' || other[699] != 'y') return -7;
+
+    printf("Scan passed\n");
+    return 0;
+}
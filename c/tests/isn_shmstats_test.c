@@ -0,0 +1,44 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "isn.h"
+#include "posix/isn_shmstats.h"
+
+isn_driver_t phy, frame;
+
+int main(int argc, char *argv[]) {
+    char name[32];
+    snprintf(name, sizeof(name), "/isn_test_%d", (int)getpid());
+
+    isn_shmstats_t *shm = isn_shmstats_create(name, 2);
+    if (!shm) return -1;
+    int p = isn_shmstats_add(shm, "phy", &phy, -1);
+    int f = isn_shmstats_add(shm, "frame", &frame, p);
+    if (p != 0 || f != 1 || isn_shmstats_add(shm, "full", &frame, p) != -1) return -2;
+
+    phy.stats.rx_counter = 100;
+    frame.stats.rx_packets = 3;
+    isn_shmstats_update(shm);
+
+    /* Reader maps the page read-only, as an external agent would */
+    int fd = shm_open(name, O_RDONLY, 0);
+    size_t size = isn_shmstats_pagesize(2);
+    const isn_shmstats_page_t *page = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) return -3;
+
+    isn_shmstats_page_t *copy = malloc(size);
+    if (isn_shmstats_snapshot(page, copy, 10)) return -4;
+    printf("%s %u, %s %u (parent %d)\n", copy->entries[0].name, copy->entries[0].stats.rx_counter,
+           copy->entries[1].name, copy->entries[1].stats.rx_packets, copy->entries[1].parent);
+    if (copy->count != 2 || copy->updates != 1 || strcmp(copy->entries[1].name, "frame") || copy->entries[1].parent != 0) return -5;
+    if (copy->entries[0].stats.rx_counter != 100 || copy->entries[1].stats.rx_packets != 3) return -6;
+
+    munmap((void *)page, size);
+    free(copy);
+    isn_shmstats_drop(shm);
+    return 0;
+}
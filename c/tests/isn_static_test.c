@@ -0,0 +1,55 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn_def.h"
+
+int user_packets, other_packets;
+static size_t user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller);
+
+#define ISN_FRAME_CHILD_RECV(l, src, size, caller)  isn_dispatch_recv(l, src, size, caller)
+#define ISN_DUP_CHILD_RECV(l, src, size, caller)    user_recv(l, src, size, caller)
+#define ISN_DISPATCH_STATIC_BINDINGS(X) \
+    X(ISN_PROTO_USER1, isn_dup_recv, &twin)
+
+#define ISN_STATIC_FRAME
+#define ISN_STATIC_DUP
+#define ISN_STATIC_DISPATCH
+#include "isn_static.h"
+#include "../src/isn_frame.c"
+#include "../src/isn_dup.c"
+
+isn_dup_t twin;
+
+#include "../src/isn_dispatch.c"
+
+isn_dispatch_t dispatch;
+isn_receiver_t user_layer = {user_recv};
+isn_frame_t frame;
+
+static size_t user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    user_packets++;
+    return size;
+}
+
+static size_t other_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    other_packets++;
+    return size;
+}
+
+static isn_bindings_t bindings[] = {
+    {ISN_PROTO_OTHER, &(isn_receiver_t){other_recv}},
+    {ISN_PROTO_LISTEND, NULL}
+};
+
+int main(int argc, char *argv[]) {
+    const uint8_t f[] = {0x81, ISN_PROTO_USER1, 1, 0x81, ISN_PROTO_USER2, 1};
+
+    isn_dispatch_init(&dispatch, bindings);
+    isn_dup_init(&twin, &user_layer, &user_layer);
+    isn_frame_init(&frame, ISN_FRAME_MODE_SHORT, &dispatch, NULL, &(isn_driver_t){0}, ISN_CLOCK_ms(100));
+    frame.drv.recv(&frame, f, sizeof(f), NULL);
+
+    /* USER1 is bound statically and duplicated, the rest falls thru to the run-time table */
+    printf("user: %d, other: %d\n", user_packets, other_packets);
+    return (user_packets == 2 && other_packets == 1) ? 0 : -1;
+}
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include "isn_static.hpp"
+
+int user_packets, stream2_packets, other_packets;
+int stream2;
+
+static size_t user_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    if (drv == &stream2) stream2_packets++;
+    else user_packets++;
+    return size;
+}
+
+static size_t other_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    other_packets++;
+    return size;
+}
+
+isn::Dispatch<
+    isn::Bind<ISN_PROTO_USER1, user_recv>,
+    isn::Bind<ISN_PROTO_USER2, user_recv, &stream2>,
+    isn::Bind<ISN_PROTO_OTHER, other_recv>
+> dispatch;
+
+int main(int argc, char *argv[]) {
+    const uint8_t u1[] = {ISN_PROTO_USER1, 1}, u2[] = {ISN_PROTO_USER2, 1}, m[] = {ISN_PROTO_MSG, 1};
+
+    isn_receiver_t *drv = (isn_receiver_t *)&dispatch;
+    drv->recv(drv, u1, sizeof(u1), NULL);
+    drv->recv(drv, u2, sizeof(u2), NULL);
+    drv->recv(drv, m, sizeof(m), NULL);
+
+    printf("user: %d, stream2: %d, other: %d\n", user_packets, stream2_packets, other_packets);
+    return (user_packets == 1 && stream2_packets == 1 && other_packets == 1) ? 0 : -1;
+}
@@ -0,0 +1,129 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "isn.h"
+#include "isn_stream.h"
+
+#define BLOCK_SIZE  32
+
+typedef struct {
+    isn_driver_t drv;
+    uint8_t buf[128];
+    uint8_t pending[128];   ///< packet not accepted by the receiver, to be retried
+    size_t pending_size;
+    int busy;
+}
+isn_tester_t;
+
+isn_tester_t phy;
+isn_user_t tx_user, rx_user;
+isn_stream_t tx, rx;
+
+static uint8_t blocks[ISN_STREAM_BUF_SIZE(BLOCK_SIZE, 3)];
+static uint8_t ring_buf[4 * BLOCK_SIZE];
+static isn_ring_t ring;
+
+static int phy_getsendbuf(isn_layer_t *drv, void **dest, size_t size, const isn_layer_t *caller) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    if (obj->busy) {
+        if (dest) *dest = NULL;
+        return -1;
+    }
+    if (dest) *dest = obj->buf;
+    return (size > sizeof(obj->buf)) ? sizeof(obj->buf) : size;
+}
+
+static void phy_free(isn_layer_t *drv, const void *ptr) {}
+
+static void phy_deliver(void) {
+    if (rx_user.drv.recv(&rx_user, phy.pending, phy.pending_size, &phy)) phy.pending_size = 0;
+}
+
+/** Loopback into the receiving user layer */
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) {
+    isn_tester_t *obj = (isn_tester_t *)drv;
+    memcpy(obj->pending, dest, size);
+    obj->pending_size = size;
+    phy_deliver();
+    return size;
+}
+
+static int produce(uint8_t first, uint32_t timestamp) {
+    uint8_t *s = isn_stream_getblock(&tx);
+    if (!s) return -1;
+    for (int i = 0; i < BLOCK_SIZE; i++) s[i] = first + i;
+    isn_stream_commit(&tx, timestamp);
+    return 0;
+}
+
+static int consume(uint8_t first) {
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+        if (isn_ring_getbyte(&ring) != (uint8_t)(first + i)) return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    phy.drv.getsendbuf = phy_getsendbuf;
+    phy.drv.send       = phy_send;
+    phy.drv.free       = phy_free;
+
+    isn_ring_init(&ring, ring_buf, sizeof(ring_buf));
+    phy.drv.memclass = ISN_MEMCLASS_DMA;
+    isn_user_init(&tx_user, NULL, &phy, ISN_PROTO_USER1);
+    if (isn_memclass(&tx_user) != ISN_MEMCLASS_DMA) return -20;    // passes the buffers of the phy
+    isn_user_init(&rx_user, &rx, &phy, ISN_PROTO_USER1);
+    isn_stream_init(&tx, &tx_user, blocks, BLOCK_SIZE, 3, NULL);
+    isn_stream_init(&rx, NULL, NULL, 0, 0, &ring);
+
+    /* Triple buffered, the 4th block is lost */
+    if (produce(0, 100) || produce(32, 200) || produce(64, 300)) return -1;
+    if (produce(96, 400) == 0 || tx.drv.stats.tx_dropped != 1) return -2;
+
+    /* Parent busy, blocks stay pending */
+    phy.busy = 1;
+    if (isn_stream_flush(&tx) != 3 || tx.drv.stats.tx_retries != 1) return -3;
+    phy.busy = 0;
+
+    if (isn_stream_flush(&tx) != 0) return -4;
+    if (rx.drv.stats.rx_packets != 3 || rx.gaps != 0 || rx.rx_timestamp != 300) return -5;
+    if (consume(0) || consume(32) || consume(64)) return -6;
+
+    /* Lost block is detected by the receiver */
+    if (produce(128, 500) || isn_stream_flush(&tx) != 0) return -7;
+    if (rx.gaps != 1 || rx.rx_timestamp != 500 || consume(128)) return -8;
+
+    /* Receiver that is late requests a retry of the block */
+    uint32_t ts = 600;
+    while (!phy.pending_size) {
+        if (ts > 610 || produce(0, ts++) || isn_stream_flush(&tx)) return -9;
+    }
+    if (rx.drv.stats.rx_retries != 1 || rx_user.drv.stats.rx_retries != 1 || rx.rx_timestamp != ts - 2) return -10;
+    while (isn_ring_getbyte(&ring) >= 0);
+    phy_deliver();
+    if (phy.pending_size || rx.gaps != 1 || rx.rx_timestamp != ts - 1) return -11;
+
+    /* Duplicate and older blocks are dropped, not counted as gaps */
+    uint32_t packets = rx.drv.stats.rx_packets;
+    while (isn_ring_getbyte(&ring) >= 0);
+    for (int back = 1; back <= 2; back++) {
+        uint8_t block[sizeof(isn_stream_header_t) + BLOCK_SIZE] = {0};
+        isn_stream_header_t h = {.seq = (uint16_t)(rx.rx_seq - back), .timestamp = 1};
+        memcpy(block, &h, sizeof(h));
+        rx.drv.recv(&rx, block, sizeof(block), &rx_user);
+    }
+    if (rx.gaps != 1 || rx.drv.stats.rx_dropped != 2 || rx.drv.stats.rx_packets != packets || rx.rx_timestamp != ts - 1) return -12;
+    if (isn_ring_getbyte(&ring) >= 0) return -13;
+
+    /* Triple buffering beyond the 256 blocks, none overwritten before sent */
+    uint32_t gaps = rx.gaps;
+    for (int i = 0; i < 300; i++) {
+        if (produce((uint8_t)i, 1000 + i) || produce((uint8_t)(i + 1), 2000 + i)) return -14;
+        if (isn_stream_flush(&tx) != 0) return -15;
+        if (consume((uint8_t)i) || consume((uint8_t)(i + 1))) return -16;
+    }
+    if (rx.gaps != gaps || rx.rx_timestamp != 2000 + 299) return -17;
+
+    printf("Streamed %u blocks, %u gaps\n", rx.drv.stats.rx_packets, rx.gaps);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <string.h>
+#include "isn_frame.h"
+#include "isn_timeout.h"
+
+static isn_clock_counter_t now = 1000;
+volatile const isn_clock_counter_t * const isn_clock_counter = &now;
+
+static int frames = 0;
+
+static size_t child_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    frames++;
+    return size;
+}
+
+static int phy_send(isn_layer_t *drv, void *dest, size_t size) { return size; }
+
+int main() {
+    isn_timeout_t t;
+
+    /* Initial is the max until warmed up, then twice the upper bound of the gaps */
+    isn_timeout_init(&t, 10, 100000);
+    for (int i = 0; i < ISN_TIMEOUT_WARMUP - 1; i++) {
+        if (isn_timeout_sample(&t, 50) != 100000) return -1;
+    }
+    if (isn_timeout_sample(&t, 50) != 128) return -2;
+
+    /* Rare stalls do not raise it, frequent do */
+    for (int i = 0; i < 200; i++) isn_timeout_sample(&t, 50);
+    if (isn_timeout_sample(&t, 90000) != 128) return -3;
+    for (int i = 0; i < 10; i++) isn_timeout_sample(&t, 600);
+    if (isn_timeout_get(&t) != 2048) return -4;
+
+    /* Limited by the min and max */
+    isn_timeout_init(&t, 10, 1000);
+    for (int i = 0; i < 100; i++) isn_timeout_sample(&t, 1);
+    if (isn_timeout_get(&t) != 10) return -5;
+    for (int i = 0; i < 1000; i++) isn_timeout_sample(&t, 5000);
+    if (isn_timeout_get(&t) != 1000) return -6;
+
+    /* Follows the link after the decay */
+    for (int i = 0; i < 4 * ISN_TIMEOUT_DECAY; i++) isn_timeout_sample(&t, 100);
+    if (isn_timeout_get(&t) != 256 || t.samples != 100 + 1000 + 4 * ISN_TIMEOUT_DECAY) return -7;
+
+    /* Frames split in two chunks 300 ticks apart teach the frame layer */
+    isn_frame_t frame;
+    isn_driver_t phy = {0};
+    phy.send = phy_send;
+    isn_frame_init(&frame, ISN_FRAME_MODE_SHORT, &(isn_receiver_t){child_recv}, NULL, &phy, ISN_CLOCK_ms(100));
+    isn_timeout_init(&t, ISN_TIMEOUT_UART(115200), ISN_CLOCK_ms(100));
+    isn_frame_setadaptive(&frame, &t);
+    if (frame.frame_timeout != ISN_CLOCK_ms(100)) return -8;
+
+    static const uint8_t f[] = {0x83, 1, 2, 3, 4};
+    for (int i = 0; i < 64; i++) {
+        ((isn_driver_t *)&frame)->recv(&frame, f, 2, &phy);
+        now += 300;
+        ((isn_driver_t *)&frame)->recv(&frame, f + 2, 3, &phy);
+        now += 5000;
+    }
+    if (frames != 64 || frame.drv.stats.rx_dropped || frame.frame_timeout != 1024) return -9;
+
+    /* Broken partial frame is dropped after the learned, not the configured timeout, and its gap is learned too */
+    unsigned samples = t.samples;
+    ((isn_driver_t *)&frame)->recv(&frame, f, 2, &phy);
+    now += 2000;
+    ((isn_driver_t *)&frame)->recv(&frame, f, sizeof(f), &phy);
+    if (frames != 65 || frame.drv.stats.rx_dropped != 1) return -10;
+    if (t.samples != samples + 1) return -11;
+
+    /* Link slows down after the warm-up, the dropped frames raise the timeout until they pass */
+    int dropped = frame.drv.stats.rx_dropped, passed = frames;
+    for (int i = 0; i < 64; i++) {
+        ((isn_driver_t *)&frame)->recv(&frame, f, 2, &phy);
+        now += 6000;
+        ((isn_driver_t *)&frame)->recv(&frame, f + 2, 3, &phy);
+        now += 50000;
+    }
+    if (frame.drv.stats.rx_dropped == dropped || frame.frame_timeout < 6000 || frames == passed) return -12;
+    dropped = frame.drv.stats.rx_dropped;
+    ((isn_driver_t *)&frame)->recv(&frame, f, 2, &phy);
+    now += 6000;
+    ((isn_driver_t *)&frame)->recv(&frame, f + 2, 3, &phy);
+    if (frame.drv.stats.rx_dropped != dropped) return -13;
+
+    printf("Timeout passed, learned %u ticks\n", (unsigned)isn_timeout_get(&t));
+    return 0;
+}
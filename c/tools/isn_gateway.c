@@ -0,0 +1,304 @@
+/** \file
+ *  \brief ISN Serial to UDP Gateway
+ *  \author Uros Platise <uros@isotel.org>
+ *
+ * Bridges any number of serial devices to UDP ports, as the
+ * python/demo_udp_serial_bridge.py does for one, from a single poll() loop.
+ *
+ * Usage: isn_gateway [-s interval_s] [-m /shm_name] [-v] routes.conf
+ *
+ * Each non-empty line of the configuration, except comments starting with #,
+ * describes one route:
+ * ~~~
+ * # name    device         baud    udp_port  frame    [clients host:port ...]
+ * sensor1   /dev/ttyUSB0   115200  33010     compact
+ * sensor2   /dev/ttyUSB1   921600  33011     none     192.168.1.10:33011
+ * ~~~
+ * With frame `short` or `compact` the serial stream is deframed by the
+ * \ref GR_ISN_Frame layer and payload is forwarded as one datagram, and
+ * datagrams are framed in reverse. With `none` the raw bytes are forwarded.
+ *
+ * Per-route statistics are printed every interval and on SIGUSR1, and with
+ * -m published to the shared memory page, see isn_shmstat.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "isn.h"
+#include "isn_frame.h"
+#include "isn_redirect.h"
+#include "posix/isn_serial.h"
+#include "posix/isn_udp.h"
+#include "posix/isn_shmstats.h"
+
+#define FRAME_NONE      (-1)
+#define FRAME_TIMEOUT   ISN_CLOCK_ms(100)
+#define MAX_CLIENTS     8
+#define POLL_PERIOD_ms  100     ///< Upper bound of the wait, for the statistics and the signals
+
+typedef struct {
+    char name[ISN_SHMSTATS_NAME_SIZE];
+    char device[128];
+    int baud;
+    uint16_t port;
+    int mode;                       ///< isn_frame_mode_t or FRAME_NONE
+    char *clients[MAX_CLIENTS];     ///< host:port
+    int clients_size;
+
+    isn_serial_driver_t *serial;
+    isn_udp_driver_t *udp;
+    isn_frame_t frame;
+    isn_redirect_t to_udp;
+    isn_redirect_t to_serial;
+}
+route_t;
+
+static route_t *routes;
+static int routes_size;
+static volatile sig_atomic_t running = 1, dump = 0;
+
+static void on_signal(int sig) {
+    if (sig == SIGUSR1) dump = 1;
+    else running = 0;
+}
+
+static int parse_mode(const char *s) {
+    if (!strcmp(s, "none"))    return FRAME_NONE;
+    if (!strcmp(s, "short"))   return ISN_FRAME_MODE_SHORT;
+    if (!strcmp(s, "compact")) return ISN_FRAME_MODE_COMPACT;
+    return -2;
+}
+
+static void free_clients(route_t *r) {
+    for (int i = 0; i < r->clients_size; i++) free(r->clients[i]);
+    r->clients_size = 0;
+}
+
+/** Drop all routes loaded so far */
+static void unload_config(void) {
+    for (int i = 0; i < routes_size; i++) free_clients(&routes[i]);
+    free(routes);
+    routes = NULL;
+    routes_size = 0;
+}
+
+/** \returns number of routes or -1 on error, with no routes left */
+static int load_config(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        return -1;
+    }
+    char line[512];
+    for (int lineno = 1; fgets(line, sizeof(line), f); lineno++) {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char *argv[5 + MAX_CLIENTS + 1];
+        int argc = 0;
+        for (char *tok = strtok(line, " \t\r\n"); tok && argc < (int)ARRAY_SIZE(argv); tok = strtok(NULL, " \t\r\n")) {
+            argv[argc++] = tok;
+        }
+        if (argc == 0) continue;
+
+        route_t r = {0};
+        if (argc < 5 || argc > 5 + MAX_CLIENTS || (r.mode = parse_mode(argv[4])) < FRAME_NONE ||
+            (r.baud = atoi(argv[2])) <= 0 || atoi(argv[3]) <= 0 || atoi(argv[3]) > 65535) {
+            fprintf(stderr, "%s:%d: expected: name device baud udp_port none|short|compact [host:port ...]\n", filename, lineno);
+            goto fail;
+        }
+        snprintf(r.name, sizeof(r.name), "%s", argv[0]);
+        snprintf(r.device, sizeof(r.device), "%s", argv[1]);
+        r.port = (uint16_t)atoi(argv[3]);
+        for (int i = 5; i < argc; i++) {
+            if (!strchr(argv[i], ':')) {
+                fprintf(stderr, "%s:%d: client %s requires host:port\n", filename, lineno, argv[i]);
+                free_clients(&r);
+                goto fail;
+            }
+            if (!(r.clients[r.clients_size] = strdup(argv[i]))) {
+                free_clients(&r);
+                goto fail;
+            }
+            r.clients_size++;
+        }
+
+        route_t *grown = realloc(routes, (routes_size + 1) * sizeof(route_t));
+        if (!grown) {
+            free_clients(&r);
+            goto fail;
+        }
+        routes = grown;
+        routes[routes_size++] = r;
+    }
+    fclose(f);
+    return routes_size;
+
+fail:
+    fclose(f);
+    unload_config();
+    return -1;
+}
+
+/** Create the drivers and wire them, with the optional frame layer in between */
+static int route_open(route_t *r) {
+    isn_serial_driver_params_t params = isn_serial_driver_default_params;
+    params.baud_rate = r->baud;
+
+    isn_layer_t *serial_child = (r->mode == FRAME_NONE) ? (isn_layer_t *)&r->to_udp : (isn_layer_t *)&r->frame;
+    if (!(r->serial = isn_serial_driver_create(r->device, &params, serial_child))) {
+        fprintf(stderr, "%s: cannot open %s\n", r->name, r->device);
+        return -1;
+    }
+    if (!(r->udp = isn_udp_driver_create(r->port, &r->to_serial, 0))) {
+        fprintf(stderr, "%s: cannot bind UDP port %u\n", r->name, r->port);
+        return -1;
+    }
+    for (int i = 0; i < r->clients_size; i++) {
+        char *port = strrchr(r->clients[i], ':');
+        *port++ = '\0';
+        if (isn_udp_driver_addclient(r->udp, r->clients[i], port) < 0) {
+            fprintf(stderr, "%s: cannot resolve client %s:%s\n", r->name, r->clients[i], port);
+            return -1;
+        }
+    }
+
+    isn_redirect_init(&r->to_udp, r->udp);
+    if (r->mode == FRAME_NONE) {
+        isn_redirect_init(&r->to_serial, r->serial);
+    }
+    else {
+        isn_frame_init(&r->frame, (isn_frame_mode_t)r->mode, &r->to_udp, NULL, r->serial, FRAME_TIMEOUT);
+        isn_redirect_init(&r->to_serial, &r->frame);
+    }
+    return 0;
+}
+
+static void route_close(route_t *r) {
+    if (r->serial) isn_serial_driver_free(r->serial);
+    if (r->udp) isn_udp_driver_free(r->udp);
+    r->serial = NULL;
+    r->udp = NULL;
+}
+
+static isn_shmstats_t *publish(const char *shm_name) {
+    isn_shmstats_t *shm = isn_shmstats_create(shm_name, routes_size * 5);
+    if (!shm) return NULL;
+    for (int i = 0; i < routes_size; i++) {
+        route_t *r = &routes[i];
+        int top = isn_shmstats_add_stats(shm, r->name, isn_serial_driver_get_stats(r->serial), -1);
+        if (r->mode != FRAME_NONE) isn_shmstats_add_stats(shm, "frame", &r->frame.drv.stats, top);
+        isn_shmstats_add_stats(shm, "udp", isn_udp_driver_get_stats(r->udp), top);
+        isn_shmstats_add_stats(shm, "to_udp", &r->to_udp.drv.stats, top);
+        isn_shmstats_add_stats(shm, "to_serial", &r->to_serial.drv.stats, top);
+    }
+    return shm;
+}
+
+static void print_stats(void) {
+    printf("%-16s %12s %12s %12s %12s %10s %10s %10s\n", "route",
+           "serial_rx", "serial_tx", "udp_rx", "udp_tx", "frame_err", "to_udp_rt", "to_ser_rt");
+    for (int i = 0; i < routes_size; i++) {
+        route_t *r = &routes[i];
+        const isn_driver_stats_t *s = isn_serial_driver_get_stats(r->serial), *u = isn_udp_driver_get_stats(r->udp);
+        printf("%-16s %12u %12u %12u %12u %10u %10u %10u\n", r->name,
+               s->rx_counter, s->tx_counter, u->rx_counter, u->tx_counter,
+               (r->mode != FRAME_NONE) ? r->frame.drv.stats.rx_errors + r->frame.drv.stats.rx_dropped : 0,
+               r->to_udp.drv.stats.tx_retries, r->to_serial.drv.stats.tx_retries);
+    }
+    fflush(stdout);
+}
+
+static int64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int main(int argc, char *argv[]) {
+    int interval_s = 0, opt;
+    const char *shm_name = NULL;
+
+    while ((opt = getopt(argc, argv, "s:m:vh")) != -1) {
+        switch (opt) {
+            case 's': interval_s = atoi(optarg); break;
+            case 'm': shm_name = optarg; break;
+            case 'v':
+                isn_serial_driver_setlogging(ISN_LOGGER_LOG_LEVEL_INFO);
+                isn_udp_driver_setlogging(ISN_LOGGER_LOG_LEVEL_INFO);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s stats_interval_s] [-m /shm_name] [-v] routes.conf\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Missing routes configuration file\n");
+        return 1;
+    }
+    if (load_config(argv[optind]) <= 0) {
+        fprintf(stderr, "No routes\n");
+        return 1;
+    }
+
+    int err = 0;
+    struct pollfd *fds = calloc(2 * routes_size, sizeof(struct pollfd));
+    for (int i = 0; i < routes_size && !err; i++) {
+        err = route_open(&routes[i]);
+        if (!err) {
+            fds[2*i].fd       = isn_serial_driver_getfd(routes[i].serial);
+            fds[2*i+1].fd     = isn_udp_driver_getfd(routes[i].udp);
+            fds[2*i].events   = fds[2*i+1].events = POLLIN;
+        }
+    }
+    isn_shmstats_t *shm = NULL;
+    if (!err && shm_name && !(shm = publish(shm_name))) {
+        fprintf(stderr, "Cannot create the statistics page %s\n", shm_name);
+        err = 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGUSR1, on_signal);
+
+    int64_t next_print = now_ms() + interval_s * 1000;
+    while (running && !err) {
+        int n = poll(fds, 2 * routes_size, POLL_PERIOD_ms);
+        for (int i = 0; n > 0 && i < routes_size; i++) {
+            if (fds[2*i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                fprintf(stderr, "%s: %s closed\n", routes[i].name, routes[i].device);
+                err = 2;
+            }
+            else if (fds[2*i].revents & POLLIN) {
+                isn_serial_driver_poll(routes[i].serial, 0);
+            }
+            if (fds[2*i+1].revents & POLLIN) {
+                isn_udp_driver_poll(routes[i].udp, 0);
+            }
+        }
+        if (shm) isn_shmstats_update(shm);
+        if (dump || (interval_s > 0 && now_ms() >= next_print)) {
+            dump = 0;
+            next_print = now_ms() + interval_s * 1000;
+            print_stats();
+        }
+    }
+
+    if (shm) isn_shmstats_drop(shm);
+    for (int i = 0; i < routes_size; i++) route_close(&routes[i]);
+    unload_config();
+    free(fds);
+    return err;
+}
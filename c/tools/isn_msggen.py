@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+#
+# ISN Message Table Compiler
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# (c) Copyright 2022, Isotel, http://isotel.org
+#
+"""
+Generates a C header and source with the message table from a JSON schema:
+
+    {
+        "name": "flashlight",
+        "messages": [
+            { "name": "id",  "handler": "id_cb",  "desc": "%T0{MyCompany FlashLight} {#sno}={%<Lx}" },
+            { "name": "led", "handler": "led_cb", "desc": "LED {:red}={%hu}{:green}={%hu}{:blue}={%hu}" },
+            { "name": "info", "desc": "Info text without arguments" }
+        ]
+    }
+
+For each message with arguments a packed struct `<name>_<msg>_t` is derived
+from the descriptor, where the fields are named by the preceding `{:field}`
+labels. Optional "args": [["red", "uint8_t"], ...] are verified against the
+descriptor instead. The output provides:
+
+- packed argument structs, with static size assertions,
+- message indices `<NAME>_MSG_<MSG>` to be used with the isn_msg_send(),
+- handler prototypes,
+- the table `<name>_msg_table` with precomputed descriptor lengths,
+  terminated by the ISN_MSG_DESC_END() entry, or with "shared": true
+  the const descriptors `<name>_msg_desc` for the isn_msg_init_desc().
+
+Usage: isn_msggen.py schema.json output_dir
+"""
+
+import json
+import os
+import re
+import sys
+
+# (modifier, conversion class) -> C type, modifiers follow the ISN descriptor format
+TYPES = {
+    ('h', 'u'): 'uint8_t',  ('h', 'd'): 'int8_t',
+    ('',  'u'): 'uint16_t', ('',  'd'): 'int16_t',
+    ('l', 'u'): 'uint32_t', ('l', 'd'): 'int32_t',
+    ('L', 'u'): 'uint64_t', ('L', 'd'): 'int64_t',
+    ('',  'f'): 'float',    ('l', 'f'): 'double',
+}
+
+SIZES = {
+    'uint8_t': 1, 'int8_t': 1, 'char': 1,
+    'uint16_t': 2, 'int16_t': 2,
+    'uint32_t': 4, 'int32_t': 4, 'float': 4,
+    'uint64_t': 8, 'int64_t': 8, 'double': 8,
+}
+
+CONVERSIONS = {'u': 'u', 'x': 'u', 'X': 'u', 'o': 'u', 'b': 'u', 'c': 'u', 'd': 'd', 'i': 'd', 'f': 'f', 'e': 'f', 'g': 'f'}
+
+ARG = re.compile(r'(?:\{[:#](\w+)\}=)?\{%[<>]?(?:\d+)?([hlL]?)([a-zA-Z])')
+
+MAX_DESC_LEN = 255      # isn_msg_size_t
+
+
+class SchemaError(Exception):
+    pass
+
+
+def c_string(s):
+    return '"' + s.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n') + '"'
+
+
+def parse_args(msg):
+    """Derive argument fields from the descriptor, and verify against the optional schema args"""
+    fields = []
+    for n, (label, mod, conv) in enumerate(ARG.findall(msg['desc'])):
+        if conv not in CONVERSIONS or (mod, CONVERSIONS[conv]) not in TYPES:
+            raise SchemaError("%s: unsupported argument %%%s%s" % (msg['name'], mod, conv))
+        fields.append([label or 'arg%d' % n, TYPES[(mod, CONVERSIONS[conv])]])
+
+    if 'args' in msg:
+        args = msg['args']
+        if len(args) != len(fields):
+            raise SchemaError("%s: descriptor has %d arguments, schema %d" % (msg['name'], len(fields), len(args)))
+        for (name, ctype), (_, dtype) in zip(args, fields):
+            if SIZES.get(ctype) != SIZES[dtype]:
+                raise SchemaError("%s: argument %s of type %s does not match the descriptor %s" % (msg['name'], name, ctype, dtype))
+        fields = [list(a) for a in args]
+
+    names = [f[0] for f in fields]
+    for f in names:
+        if names.count(f) > 1:
+            raise SchemaError("%s: duplicated argument %s" % (msg['name'], f))
+    return fields
+
+
+def generate(schema, basename):
+    name = schema['name']
+    NAME = name.upper()
+    messages = schema['messages']
+    if not messages or len(messages) > 127:
+        raise SchemaError("1 to 127 messages are required")
+
+    guard = '__%s_MSG_H__' % NAME
+    h = ['/* Generated by isn_msggen.py from the %s schema, do not edit */' % name, '',
+         '#ifndef ' + guard, '#define ' + guard, '', '#include "isn_msg.h"', '',
+         '#ifdef __cplusplus', 'extern "C" {', '#endif', '']
+    c = ['/* Generated by isn_msggen.py from the %s schema, do not edit */' % name, '',
+         '#include "%s.h"' % basename, '']
+
+    entries = []
+    enum = []
+    handlers = []
+    for i, msg in enumerate(messages):
+        if not re.match(r'^[A-Za-z_]\w*$', msg.get('name', '')):
+            raise SchemaError("message %d requires a valid name" % i)
+        desc = msg['desc']
+        if len(desc.encode('utf-8')) > MAX_DESC_LEN:
+            raise SchemaError("%s: descriptor is longer than %d bytes" % (msg['name'], MAX_DESC_LEN))
+
+        fields = parse_args(msg)
+        handler = msg.get('handler')
+        if fields and not handler:
+            raise SchemaError("%s: message with arguments requires a handler" % msg['name'])
+
+        struct = 'NULL'
+        size = '0'
+        if fields:
+            struct = '%s_%s_t' % (name, msg['name'])
+            size = 'sizeof(%s)' % struct
+            h += ['typedef struct {']
+            h += ['    %s %s;' % (ctype, field) for field, ctype in fields]
+            h += ['} __attribute__((packed)) %s;' % struct, '']
+            total = sum(SIZES.get(ctype, 0) for _, ctype in fields)
+            c += ['CASSERT(sizeof(%s) == %d, %s)' % (struct, total, basename)]
+        if handler and handler not in handlers:
+            handlers.append(handler)
+
+        index = '%s_MSG_%s' % (NAME, msg['name'].upper())
+        enum.append('    %s = %d,' % (index, i))
+        entries.append('    [%s] = { %d, %s, %s, %s, %d },' % (
+            index, msg.get('priority', 0), size, handler or 'NULL', c_string(desc), len(desc.encode('utf-8'))))
+
+    enum += ['    %s_MSG_END = %d,' % (NAME, len(messages)), '    %s_MSG_COUNT = %d' % (NAME, len(messages) + 1)]
+    entries.append('    [%s_MSG_END] = ISN_MSG_DESC_END(%d)' % (NAME, schema.get('end_priority', 0)))
+
+    h += ['/** Message numbers */', 'enum {'] + enum + ['};', '']
+    h += ['void *%s(const void *data);' % hnd for hnd in handlers] + ['']
+    if schema.get('shared'):
+        table = 'const isn_msg_desc_t %s_msg_desc[%s_MSG_COUNT]' % (name, NAME)
+    else:
+        table = 'isn_msg_table_t %s_msg_table[%s_MSG_COUNT]' % (name, NAME)
+    h += ['extern %s;' % table, '']
+    h += ['#ifdef __cplusplus', '}', '#endif', '', '#endif', '']
+
+    c += ['', '%s = {' % table] + entries + ['};', '']
+    return '\n'.join(h), '\n'.join(c)
+
+
+def main(argv):
+    if len(argv) != 3:
+        print(__doc__)
+        return 1
+    with open(argv[1]) as f:
+        schema = json.load(f)
+    basename = schema['name'] + '_msg'
+    try:
+        header, source = generate(schema, basename)
+    except (SchemaError, KeyError) as e:
+        print("%s: %s" % (argv[1], e), file=sys.stderr)
+        return 2
+
+    os.makedirs(argv[2], exist_ok=True)
+    for ext, text in (('.h', header), ('.c', source)):
+        with open(os.path.join(argv[2], basename + ext), 'w') as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,88 @@
+/** \file
+ *  \brief Reader of the ISN Shared Memory Statistics Page
+ *  \author Uros Platise <uros@isotel.org>
+ *  \see isn_shmstats.h
+ *
+ * Usage: isn_shmstat [-i interval_ms] [-n count] /name
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <posix/isn_shmstats.h>
+
+static int depth(const isn_shmstats_page_t *page, int i) {
+    int d = 0;
+    while (page->entries[i].parent >= 0 && d < (int)page->count) {
+        i = page->entries[i].parent;
+        d++;
+    }
+    return d;
+}
+
+static void print_page(const isn_shmstats_page_t *page) {
+    printf("%-28s %10s %10s %8s %8s %10s %10s %8s %8s\n", "layer",
+           "rx_packets", "rx_bytes", "rx_err", "rx_drop", "tx_packets", "tx_bytes", "tx_drop", "tx_retry");
+    for (uint32_t i = 0; i < page->count; i++) {
+        const isn_shmstats_entry_t *e = &page->entries[i];
+        int d = depth(page, i);
+        printf("%*s%-*.*s %10u %10u %8u %8u %10u %10u %8u %8u\n", 2*d, "", 28 - 2*d, ISN_SHMSTATS_NAME_SIZE, e->name,
+               e->stats.rx_packets, e->stats.rx_counter, e->stats.rx_errors, e->stats.rx_dropped,
+               e->stats.tx_packets, e->stats.tx_counter, e->stats.tx_dropped, e->stats.tx_retries);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int interval_ms = 1000, count = 1, opt;
+
+    while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+        switch (opt) {
+            case 'i': interval_ms = atoi(optarg); break;
+            case 'n': count = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-i interval_ms] [-n count, 0 forever] /name\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "Missing name of the shared memory page\n");
+        return 1;
+    }
+
+    int fd = shm_open(argv[optind], O_RDONLY, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(isn_shmstats_page_t)) {
+        perror(argv[optind]);
+        return 2;
+    }
+    const isn_shmstats_page_t *page = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED || isn_shmstats_pagesize(page->capacity) > (size_t)st.st_size) {
+        fprintf(stderr, "Invalid page\n");
+        return 2;
+    }
+
+    isn_shmstats_page_t *copy = malloc(isn_shmstats_pagesize(page->capacity));
+    for (int n = 0; !count || n < count; n++) {
+        if (n) usleep(interval_ms * 1000);
+        int err = isn_shmstats_snapshot(page, copy, 1000);
+        if (err) {
+            fprintf(stderr, err == -1 ? "Invalid or incompatible page\n" : "Page is busy\n");
+            return 3;
+        }
+        printf("update %llu\n", (unsigned long long)copy->updates);
+        print_page(copy);
+    }
+    free(copy);
+    return 0;
+}
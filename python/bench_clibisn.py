@@ -0,0 +1,59 @@
+"""
+Per-call overhead of the ctypes clibisn against the native _clibisn
+
+Writes small frames through a Frame over an UDP driver without clients, so
+the time is spent in the bindings and the library, not in the system.
+
+    cd ../c && cmake -S . -B build && cmake --build build
+    cd ../python && python setup.py build_ext --inplace
+    cd ../c/build && python ../../python/bench_clibisn.py
+"""
+import os
+import sys
+import timeit
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+N = 100000
+PAYLOAD = bytes(range(16))
+
+
+def bench(name, stmt):
+    t = min(timeit.repeat(stmt, number=N, repeat=5)) / N
+    print("%-32s %8.3f us/call" % (name, t * 1e6))
+    return t
+
+
+def native():
+    import _clibisn as isn
+    other = isn.Receiver(lambda drv, src, size, caller: size)
+    dispatch = isn.Dispatch(1)
+    dispatch.add(isn.ISN_PROTO_OTHER, other)
+    dispatch.init()
+    frame = isn.Frame()
+    udp = isn.UDP(33111, frame)
+    frame.init(dispatch, None, udp, 100000)
+    bench("native clock_update()", isn.clock_update)
+    return bench("native io_write(frame, 16 B)", lambda: isn.io_write(frame, PAYLOAD))
+
+
+def ctypes_based():
+    from ctypes import create_string_buffer
+    import clibisn as isn
+    other = isn.Receiver(lambda drv, src, size, caller: size)
+    dispatch = isn.Dispatch(1)
+    dispatch.add(isn.Bindings.ISN_PROTO_OTHER, isn.addressof(other))
+    dispatch.init()
+    frame = isn.Frame()
+    udp = isn.UDP(33112, dispatch)
+    frame.init(dispatch, None, udp, 100000)
+    payload = create_string_buffer(PAYLOAD, len(PAYLOAD))
+    bench("ctypes clib.isn_clock_update()", isn.clib.isn_clock_update)
+    return bench("ctypes io_write(frame, 16 B)", lambda: isn.io_write(frame.obj, payload, len(PAYLOAD)))
+
+
+if __name__ == "__main__":
+    t_native = native()
+    if os.path.exists("libisn.so") or os.path.exists("libisn.dll"):
+        t_ctypes = ctypes_based()
+        print("native is %.1fx faster" % (t_ctypes / t_native))
@@ -67,8 +67,22 @@ class Transport:
         clib.isn_trans_create.restype = my_void_p
         self.obj = clib.isn_trans_create()
 
+    class DispatchTbl(Structure):
+        _fields_ = [("driver", my_void_p),
+                    ("tx_counter", c_uint8),
+                    ("rx_counter", c_uint8),
+                    ("rx_dropped", c_uint8),
+                    ("_aligned", c_uint8)]     # packed, and aligned to 4 bytes
+        _pack_ = 1
+
     def init(self, child, parent, port):
-        clib.isn_trans_init(self.obj, child.obj, parent.obj, c_uint8(port))
+        """ The child receives on the given port, data to the other ports are dropped """
+        self.drop = Receiver(lambda drv, src, size, caller: size)
+        self.tbl = (Transport.DispatchTbl * (port + 1))()
+        for i in range(port):
+            self.tbl[i].driver = addressof(self.drop)
+        self.tbl[port].driver = child.obj
+        clib.isn_trans_init(self.obj, self.tbl, c_size_t(port + 1), parent.obj)
 
     def __del__(self):
         clib.isn_trans_drop(self.obj)
@@ -81,7 +95,7 @@ class Dup:
         self.obj = clib.isn_dup_create()
 
     def init(self, child1, child2):
-        clib.isn_trans_init(self.obj, child1.obj, child2.obj)
+        clib.isn_dup_init(self.obj, child1.obj, child2.obj)
 
     def __del__(self):
         clib.isn_dup_drop(self.obj)
@@ -138,7 +152,8 @@ class Dispatch:
 
 
 class Receiver(Structure):
-    _fields_ = [("recv", my_void_p)]
+    _fields_ = [("recv", my_void_p),
+                ("recv_batch", c_void_p)]
 
     def __init__(self, recv, ptr=False):
         self.recv = recv if ptr else get_recvptr(recv)
@@ -203,10 +218,13 @@ class Message:
         _fields_ = [("priority", c_ubyte),
                     ("size", c_ubyte),
                     ("handler", my_void_p),
-                    ("desc", c_char_p)]
+                    ("desc", c_char_p),
+                    ("desc_len", c_ubyte)]
 
         def __init__(self, desc, size, handler, ptr=True, priority=0):
-            desc = c_char_p(desc.encode('utf-8'))
+            desc = desc.encode('utf-8')
+            desc_len = len(desc) if len(desc) < 256 else 0
+            desc = c_char_p(desc)
 
             self.priority = c_ubyte(priority)
             self.size = c_ubyte(size)
@@ -216,7 +234,7 @@ class Message:
             else:
                 self.handler = None
             self.desc = desc
-            super(Message.Msg, self).__init__(priority, size, self.handler, desc)
+            super(Message.Msg, self).__init__(priority, size, self.handler, desc, desc_len)
 
         def get_handler(self):
             return self.handler
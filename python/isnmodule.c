@@ -0,0 +1,991 @@
+/** \file
+ *  \brief Native Python Module of the ISN Library
+ *  \author Uros Platise <uros@isotel.org>
+ *
+ * A compiled alternative to the ctypes based clibisn.py with the same object
+ * model and method names:
+ * ~~~
+ * import _clibisn as isn
+ *
+ * msg = isn.Message(3)
+ * msg.add("%T0{UDP Example} V1.0 {#sno}={%<Lx}", 8, lambda data: serial.to_bytes(8, 'little'))
+ * msg.add("Example {:counter}={%lu}", 4, counter)
+ * msg.add("%!", 0, None)
+ *
+ * dispatch = isn.Dispatch(2)
+ * dispatch.add(isn.ISN_PROTO_MSG, msg)
+ * dispatch.add(isn.ISN_PROTO_PING, isn.Receiver(lambda drv, src, size, caller: msg.send(1) or size))
+ * dispatch.init()
+ *
+ * udp = isn.UDP(33010, dispatch)
+ * msg.init(udp)
+ * while True:
+ *     udp.poll()
+ *     msg.sched()
+ *     isn.clock_update()
+ * ~~~
+ * Callbacks have the signatures of the clibisn.py, so the existing scripts
+ * run with `from _clibisn import *` in place of `from clibisn import *`:
+ *  - a receiver is called as `recv(drv, src, size, caller)`, with addresses
+ *    as ints, or None for NULL, and returns the accepted size, or None for all,
+ *  - a message handler is called as `handler(data)`, with the address of the
+ *    received arguments or None, and returns the address of the reply, i.e.
+ *    `addressof(ctypes_object)`, or None; returning a bytes-like object of the
+ *    message size is accepted as well,
+ *  - get_cbptr() and get_recvptr() return the callable as is, and the `ptr`
+ *    arguments are accepted, while the C function pointers as obtained by
+ *    the clibisn.get_cbptr() are still used directly,
+ *  - addressof() returns the address of a layer, and of ctypes objects as
+ *    the ctypes.addressof(), so `Dispatch.add(proto, addressof(receiver))`
+ *    works, as do layers, `obj` attributes, and plain addresses.
+ *
+ * Differences to the clibisn.py:
+ *  - there is no `clib` handle of the shared library, use clock_update()
+ *    instead of `clib.isn_clock_update()`, and the stats() methods of the
+ *    layers instead of the ctypes DriverStats,
+ *  - the poll() methods release the GIL while waiting.
+ *
+ * Build with `python setup.py build_ext --inplace` in this directory.
+ */
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * (c) Copyright 2022, Isotel, http://isotel.org
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stddef.h>
+#include "isn.h"
+#include "isn_dup.h"
+#include "posix/isn_serial.h"
+#include "posix/isn_udp.h"
+
+#define CONTAINER_OF(ptr, type, member)     ((type *)((char *)(ptr) - offsetof(type, member)))
+
+void disable_stdout_buffer(void);           // of the isn_logger.c, for the non C code
+
+/*--------------------------------------------------------------------*/
+/* Layer                                                              */
+/*--------------------------------------------------------------------*/
+
+/** Base of all layers, keeps the python objects referenced by the C layers alive */
+typedef struct {
+    PyObject_HEAD
+    isn_layer_t *layer;
+    PyObject *refs;
+}
+LayerObject;
+
+static PyTypeObject LayerType;
+
+/** Address of a layer object, an int, a ctypes pointer, or an object with the obj attribute */
+static void *to_pointer(PyObject *o) {
+    Py_INCREF(o);
+    for (int depth = 0; depth < 4; depth++) {
+        if (PyObject_TypeCheck(o, &LayerType)) {
+            void *p = ((LayerObject *)o)->layer;
+            Py_DECREF(o);
+            if (!p) PyErr_SetString(PyExc_ValueError, "layer is not initialized");
+            return p;
+        }
+        if (PyLong_Check(o)) {
+            void *p = PyLong_AsVoidPtr(o);
+            Py_DECREF(o);
+            if (!p && !PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "NULL pointer");
+            return p;
+        }
+        const char *attr = PyObject_HasAttrString(o, "obj") ? "obj" : "value";
+        PyObject *next = PyObject_GetAttrString(o, attr);
+        Py_DECREF(o);
+        if (!next) {
+            PyErr_SetString(PyExc_TypeError, "expected a layer, an address or an object with the obj attribute");
+            return NULL;
+        }
+        o = next;
+    }
+    Py_DECREF(o);
+    PyErr_SetString(PyExc_TypeError, "expected a layer");
+    return NULL;
+}
+
+/** Layer or NULL for None, referenced by the self */
+static int to_layer(LayerObject *self, PyObject *o, isn_layer_t **layer, int allow_none) {
+    if (o == Py_None && allow_none) {
+        *layer = NULL;
+        return 0;
+    }
+    if (!(*layer = to_pointer(o))) return -1;
+    return PyList_Append(self->refs, o);
+}
+
+static PyObject *layer_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    LayerObject *self = (LayerObject *)type->tp_alloc(type, 0);
+    if (self && !(self->refs = PyList_New(0))) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject *)self;
+}
+
+static int layer_traverse(LayerObject *self, visitproc visit, void *arg) {
+    Py_VISIT(self->refs);
+    return 0;
+}
+
+static int layer_clear(LayerObject *self) {
+    Py_CLEAR(self->refs);
+    return 0;
+}
+
+static void layer_dealloc(LayerObject *self) {
+    PyObject_GC_UnTrack(self);
+    layer_clear(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *layer_getobj(LayerObject *self, void *closure) {
+    return PyLong_FromVoidPtr(self->layer);
+}
+
+static PyObject *stats_dict(const isn_driver_stats_t *s) {
+    return Py_BuildValue("{s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k}",
+        "rx_packets", (unsigned long)s->rx_packets, "rx_counter", (unsigned long)s->rx_counter,
+        "rx_errors", (unsigned long)s->rx_errors, "rx_retries", (unsigned long)s->rx_retries,
+        "rx_dropped", (unsigned long)s->rx_dropped, "tx_packets", (unsigned long)s->tx_packets,
+        "tx_counter", (unsigned long)s->tx_counter, "tx_dropped", (unsigned long)s->tx_dropped,
+        "tx_retries", (unsigned long)s->tx_retries);
+}
+
+/** Statistics of the layers implementing the complete isn_driver_t */
+static PyObject *layer_stats(LayerObject *self, PyObject *unused) {
+    if (!self->layer) Py_RETURN_NONE;
+    return stats_dict(&((isn_driver_t *)self->layer)->stats);
+}
+
+static PyGetSetDef layer_getset[] = {
+    {"obj", (getter)layer_getobj, NULL, "Address of the C layer", NULL},
+    {NULL}
+};
+
+static PyTypeObject LayerType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name      = "_clibisn.Layer",
+    .tp_basicsize = sizeof(LayerObject),
+    .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    .tp_doc       = "Base of the ISN layers",
+    .tp_new       = layer_new,
+    .tp_dealloc   = (destructor)layer_dealloc,
+    .tp_traverse  = (traverseproc)layer_traverse,
+    .tp_clear     = (inquiry)layer_clear,
+    .tp_getset    = layer_getset,
+};
+
+#define LAYER_TYPE(name, object, doc, ...) \
+    static PyTypeObject name##Type = { \
+        PyVarObject_HEAD_INIT(NULL, 0) \
+        .tp_name      = "_clibisn." #name, \
+        .tp_basicsize = sizeof(object), \
+        .tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC, \
+        .tp_doc       = doc, \
+        .tp_new       = layer_new, \
+        .tp_dealloc   = (destructor)layer_dealloc, \
+        .tp_traverse  = (traverseproc)layer_traverse, \
+        .tp_clear     = (inquiry)layer_clear, \
+        .tp_base      = &LayerType, \
+        __VA_ARGS__ \
+    }
+
+/** Layers embedded in the object have the address already before init(), as the layers refer to each other */
+#define EMBEDDED_NEW(name, object, member) \
+    static PyObject *name##_new(PyTypeObject *type, PyObject *args, PyObject *kwds) { \
+        object *self = (object *)layer_new(type, args, kwds); \
+        if (self) self->base.layer = &self->member; \
+        return (PyObject *)self; \
+    }
+
+/** Reports the exception of a callback, which cannot be propagated through the C layers */
+static void report_callback_error(PyObject *callback) {
+    PyErr_WriteUnraisable(callback);
+}
+
+/** Pointer as passed to the ctypes callbacks of the clibisn.py, an int or None for NULL */
+static PyObject *from_pointer(const void *p) {
+    if (!p) Py_RETURN_NONE;
+    return PyLong_FromVoidPtr((void *)p);
+}
+
+/*--------------------------------------------------------------------*/
+/* Receiver                                                           */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_receiver_t drv;
+    PyObject *callback;     ///< borrowed, referenced by base.refs
+}
+ReceiverObject;
+
+static size_t receiver_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    ReceiverObject *self = CONTAINER_OF(drv, ReceiverObject, drv);
+    size_t consumed = size;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    PyObject *ret = PyObject_CallFunction(self->callback, "NNnN",
+        from_pointer(drv), from_pointer(src), (Py_ssize_t)size, from_pointer(caller));
+    if (ret && ret != Py_None && PyLong_Check(ret)) {
+        consumed = PyLong_AsSize_t(ret);
+        if (consumed > size) consumed = size;
+    }
+    Py_XDECREF(ret);
+    if (PyErr_Occurred()) {
+        report_callback_error(self->callback);
+        consumed = size;
+    }
+
+    PyGILState_Release(gil);
+    return consumed;
+}
+
+static int receiver_init(ReceiverObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"recv", "ptr", NULL};
+    PyObject *recv;
+    int ptr = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", kwlist, &recv, &ptr)) return -1;
+
+    if (PyCallable_Check(recv)) {               // python, also as returned by the get_recvptr() below
+        self->drv.recv = receiver_recv;
+    }
+    else {                                      // C function, as by the clibisn.get_recvptr()
+        void *fn = to_pointer(recv);
+        if (!fn) return -1;
+        self->drv.recv = (size_t (*)(isn_layer_t *, const void *, size_t, isn_layer_t *))fn;
+    }
+    (void)ptr;                                  // of the clibisn.py, a callable is never a C function here
+    if (PyList_Append(self->base.refs, recv) < 0) return -1;
+    self->callback   = recv;
+    return 0;
+}
+
+EMBEDDED_NEW(receiver, ReceiverObject, drv)
+
+LAYER_TYPE(Receiver, ReceiverObject, "Receiver(recv, ptr=False), calls recv(drv, src, size, caller) with the addresses, and returns the accepted size",
+    .tp_init = (initproc)receiver_init,
+    .tp_new = receiver_new);
+
+/*--------------------------------------------------------------------*/
+/* Frame                                                              */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_frame_t frame;
+}
+FrameObject;
+
+static PyObject *frame_init_layer(FrameObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"child", "other", "parent", "timeout", "mode", NULL};
+    PyObject *child, *other, *parent;
+    unsigned long timeout;
+    int mode = ISN_FRAME_MODE_COMPACT;
+    isn_layer_t *c, *o, *p;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOOk|i", kwlist, &child, &other, &parent, &timeout, &mode)) return NULL;
+    if (to_layer(&self->base, child, &c, 0) || to_layer(&self->base, other, &o, 1) || to_layer(&self->base, parent, &p, 0)) return NULL;
+
+    isn_frame_init(&self->frame, mode, c, o, p, (isn_clock_counter_t)timeout);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef frame_methods[] = {
+    {"init", (PyCFunction)(void(*)(void))frame_init_layer, METH_VARARGS | METH_KEYWORDS, "init(child, other, parent, timeout, mode=MODE_COMPACT)"},
+    {"stats", (PyCFunction)layer_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+EMBEDDED_NEW(frame, FrameObject, frame)
+
+LAYER_TYPE(Frame, FrameObject, "Short and Compact Frame Layer", .tp_methods = frame_methods,
+    .tp_new = frame_new);
+
+/*--------------------------------------------------------------------*/
+/* User, Transport, Dup, Redirect                                     */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_user_t user;
+}
+UserObject;
+
+static PyObject *user_init_layer(UserObject *self, PyObject *args) {
+    PyObject *child, *parent;
+    unsigned char identifier;
+    isn_layer_t *c, *p;
+    if (!PyArg_ParseTuple(args, "OOb", &child, &parent, &identifier)) return NULL;
+    if (to_layer(&self->base, child, &c, 0) || to_layer(&self->base, parent, &p, 0)) return NULL;
+
+    isn_user_init(&self->user, c, p, identifier);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef user_methods[] = {
+    {"init", (PyCFunction)user_init_layer, METH_VARARGS, "init(child, parent, identifier)"},
+    {"stats", (PyCFunction)layer_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+EMBEDDED_NEW(user, UserObject, user)
+
+LAYER_TYPE(User, UserObject, "User Layer", .tp_methods = user_methods,
+    .tp_new = user_new);
+
+typedef struct {
+    LayerObject base;
+    isn_trans_t trans;
+    isn_trans_dispatchtbl_t *tbl;
+}
+TransportObject;
+
+/** Receiver of the ports without a child */
+static size_t drop_recv(isn_layer_t *drv, const void *src, size_t size, isn_layer_t *caller) {
+    return size;
+}
+
+static isn_receiver_t drop_receiver = {drop_recv};
+
+static PyObject *transport_init_layer(TransportObject *self, PyObject *args) {
+    PyObject *child, *parent;
+    unsigned char port;
+    isn_layer_t *c, *p;
+    if (!PyArg_ParseTuple(args, "OOb", &child, &parent, &port)) return NULL;
+    if (port > 63) {
+        PyErr_SetString(PyExc_ValueError, "port is 0..63");
+        return NULL;
+    }
+    if (to_layer(&self->base, child, &c, 0) || to_layer(&self->base, parent, &p, 0)) return NULL;
+
+    PyMem_Free(self->tbl);
+    if (!(self->tbl = PyMem_Calloc(port + 1, sizeof(isn_trans_dispatchtbl_t)))) return PyErr_NoMemory();
+    for (int i = 0; i < port; i++) self->tbl[i].driver = &drop_receiver;
+    self->tbl[port].driver = c;
+
+    isn_trans_init(&self->trans, self->tbl, port + 1, p);
+    Py_RETURN_NONE;
+}
+
+static void transport_dealloc(TransportObject *self) {
+    PyMem_Free(self->tbl);
+    layer_dealloc(&self->base);
+}
+
+static PyMethodDef transport_methods[] = {
+    {"init", (PyCFunction)transport_init_layer, METH_VARARGS, "init(child, parent, port)"},
+    {"stats", (PyCFunction)layer_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+EMBEDDED_NEW(transport, TransportObject, trans)
+
+LAYER_TYPE(Transport, TransportObject, "Short Transport Layer, with the child on a single port",
+    .tp_methods = transport_methods, .tp_dealloc = (destructor)transport_dealloc,
+    .tp_new = transport_new);
+
+typedef struct {
+    LayerObject base;
+    isn_dup_t dup;
+}
+DupObject;
+
+static PyObject *dup_init_layer(DupObject *self, PyObject *args) {
+    PyObject *child1, *child2;
+    isn_layer_t *c1, *c2;
+    if (!PyArg_ParseTuple(args, "OO", &child1, &child2)) return NULL;
+    if (to_layer(&self->base, child1, &c1, 0) || to_layer(&self->base, child2, &c2, 0)) return NULL;
+
+    isn_dup_init(&self->dup, c1, c2);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef dup_methods[] = {
+    {"init", (PyCFunction)dup_init_layer, METH_VARARGS, "init(child1, child2)"},
+    {NULL}
+};
+
+EMBEDDED_NEW(dup, DupObject, dup)
+
+LAYER_TYPE(Dup, DupObject, "Duplicates received data to two children", .tp_methods = dup_methods,
+    .tp_new = dup_new);
+
+typedef struct {
+    LayerObject base;
+    isn_redirect_t redirect;
+}
+RedirectObject;
+
+static PyObject *redirect_init_layer(RedirectObject *self, PyObject *args) {
+    PyObject *target = Py_None;
+    isn_layer_t *t;
+    if (!PyArg_ParseTuple(args, "|O", &target)) return NULL;
+    if (to_layer(&self->base, target, &t, 1)) return NULL;
+
+    isn_redirect_init(&self->redirect, t);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef redirect_methods[] = {
+    {"init", (PyCFunction)redirect_init_layer, METH_VARARGS, "init(target), or init(None) to loop back to the caller"},
+    {"stats", (PyCFunction)layer_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+EMBEDDED_NEW(redirect, RedirectObject, redirect)
+
+LAYER_TYPE(Redirect, RedirectObject, "Redirect Layer", .tp_methods = redirect_methods,
+    .tp_new = redirect_new);
+
+/*--------------------------------------------------------------------*/
+/* Dispatch                                                           */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_dispatch_t dispatch;
+    isn_bindings_t *binds;
+    Py_ssize_t size;
+    Py_ssize_t last_bind;
+}
+DispatchObject;
+
+static int dispatch_init(DispatchObject *self, PyObject *args, PyObject *kwds) {
+    Py_ssize_t size;
+    if (!PyArg_ParseTuple(args, "n", &size)) return -1;
+    if (size < 0) {
+        PyErr_SetString(PyExc_ValueError, "size must not be negative");
+        return -1;
+    }
+    PyMem_Free(self->binds);
+    if (!(self->binds = PyMem_Calloc(size + 1, sizeof(isn_bindings_t)))) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->size      = size;
+    self->last_bind = -1;
+    return 0;
+}
+
+static PyObject *dispatch_set(DispatchObject *self, PyObject *args) {
+    Py_ssize_t num;
+    int protocol;
+    PyObject *driver;
+    isn_layer_t *d;
+    if (!PyArg_ParseTuple(args, "niO", &num, &protocol, &driver)) return NULL;
+    if (num < 0 || num >= self->size) return PyErr_Format(PyExc_IndexError, "Set bind failed, bind %zd is out of range", num);
+    if (to_layer(&self->base, driver, &d, 1)) return NULL;
+
+    self->binds[num].protocol = protocol;
+    self->binds[num].driver   = d;
+    if (num > self->last_bind) self->last_bind = num;
+    return PyLong_FromSsize_t(num);
+}
+
+static PyObject *dispatch_add(DispatchObject *self, PyObject *args) {
+    int protocol;
+    PyObject *driver;
+    if (!PyArg_ParseTuple(args, "iO", &protocol, &driver)) return NULL;
+    PyObject *setargs = Py_BuildValue("(niO)", self->last_bind + 1, protocol, driver);
+    if (!setargs) return NULL;
+    PyObject *ret = dispatch_set(self, setargs);
+    Py_DECREF(setargs);
+    return ret;
+}
+
+static PyObject *dispatch_init_layer(DispatchObject *self, PyObject *unused) {
+    if (self->last_bind + 1 != self->size) {
+        return PyErr_Format(PyExc_ValueError, "Bind table size not matching, expected %zd, found %zd", self->size, self->last_bind + 1);
+    }
+    self->binds[self->size].protocol = ISN_PROTO_LISTEND;
+    self->binds[self->size].driver   = NULL;
+    isn_dispatch_init(&self->dispatch, self->binds);
+    Py_RETURN_NONE;
+}
+
+static void dispatch_dealloc(DispatchObject *self) {
+    PyMem_Free(self->binds);
+    layer_dealloc(&self->base);
+}
+
+static PyMethodDef dispatch_methods[] = {
+    {"add", (PyCFunction)dispatch_add, METH_VARARGS, "add(protocol, driver) returns the bind number"},
+    {"set", (PyCFunction)dispatch_set, METH_VARARGS, "set(bind_num, protocol, driver)"},
+    {"init", (PyCFunction)dispatch_init_layer, METH_NOARGS, "init() once all the binds are given"},
+    {NULL}
+};
+
+EMBEDDED_NEW(dispatch, DispatchObject, dispatch)
+
+LAYER_TYPE(Dispatch, DispatchObject, "Dispatch(size), dispatches to the children by the protocol",
+    .tp_init = (initproc)dispatch_init, .tp_methods = dispatch_methods, .tp_dealloc = (destructor)dispatch_dealloc,
+    .tp_new = dispatch_new);
+
+/*--------------------------------------------------------------------*/
+/* Message                                                            */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_message_t msg;
+    isn_msg_table_t *table;
+    PyObject **handlers;            ///< python handlers, borrowed, referenced by base.refs, or NULL for C handlers
+    Py_ssize_t size;
+    Py_ssize_t last_msg;
+    int initialized;
+    uint8_t out[256];               ///< output of the handler in a call, messages are up to 255 bytes
+}
+MessageObject;
+
+static void *message_handler(const void *data) {
+    MessageObject *self = CONTAINER_OF(isn_msg_self, MessageObject, msg);
+    int num = isn_msg_self->handler_msgnum;
+    PyObject *handler = self->handlers[num];
+    size_t size = self->table[num].size;
+    void *result = NULL;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    PyObject *ret = PyObject_CallFunction(handler, "N", from_pointer(data));
+    if (ret && PyLong_Check(ret)) {             // address, as of the clibisn.py
+        void *p = PyLong_AsVoidPtr(ret);
+        if (p && size) {
+            memcpy(self->out, p, size);
+            result = self->out;
+        }
+    }
+    else if (ret && ret != Py_None) {
+        Py_buffer b;
+        if (PyObject_GetBuffer(ret, &b, PyBUF_SIMPLE) == 0) {
+            size_t n = (size_t)b.len < size ? (size_t)b.len : size;
+            memcpy(self->out, b.buf, n);
+            memset(self->out + n, 0, size - n);
+            PyBuffer_Release(&b);
+            result = self->out;
+        }
+    }
+    Py_XDECREF(ret);
+    if (PyErr_Occurred()) report_callback_error(handler);
+
+    PyGILState_Release(gil);
+    return result;
+}
+
+static int message_init(MessageObject *self, PyObject *args, PyObject *kwds) {
+    Py_ssize_t size;
+    if (!PyArg_ParseTuple(args, "n", &size)) return -1;
+    if (size < 1 || size > 255) {
+        PyErr_SetString(PyExc_ValueError, "size is 1..255");
+        return -1;
+    }
+    PyMem_Free(self->table);
+    PyMem_Free(self->handlers);
+    self->table    = PyMem_Calloc(size, sizeof(isn_msg_table_t));
+    self->handlers = PyMem_Calloc(size, sizeof(PyObject *));
+    if (!self->table || !self->handlers) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->size     = size;
+    self->last_msg = -1;
+    return 0;
+}
+
+static PyObject *message_set(MessageObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"msg_num", "desc", "size", "handler", "ptr", "priority", NULL};
+    Py_ssize_t num;
+    PyObject *desc, *handler;
+    unsigned char size, priority = 0;
+    int ptr = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "nUbO|pb", kwlist, &num, &desc, &size, &handler, &ptr, &priority)) return NULL;
+    if (num < 0 || num >= self->size) return PyErr_Format(PyExc_IndexError, "Set message failed, message %zd is out of range", num);
+
+    PyObject *encoded = PyUnicode_AsUTF8String(desc);
+    if (!encoded) return NULL;
+    int err = PyList_Append(self->base.refs, encoded);
+    Py_DECREF(encoded);
+    if (err < 0) return NULL;
+
+    isn_msg_table_t *m = &self->table[num];
+    m->priority = priority;
+    m->size     = size;
+    m->desc     = PyBytes_AS_STRING(encoded);
+    m->desc_len = PyBytes_GET_SIZE(encoded) < 256 ? (isn_msg_size_t)PyBytes_GET_SIZE(encoded) : 0;
+    self->handlers[num] = NULL;
+    if (handler == Py_None) {
+        m->handler = NULL;
+    }
+    else if (PyCallable_Check(handler)) {
+        if (PyList_Append(self->base.refs, handler) < 0) return NULL;
+        self->handlers[num] = handler;
+        m->handler = message_handler;
+    }
+    else {      // C function, as by the get_cbptr()
+        if (!(m->handler = (isn_events_handler_t)to_pointer(handler))) return NULL;
+        if (PyList_Append(self->base.refs, handler) < 0) return NULL;
+    }
+    if (num > self->last_msg) self->last_msg = num;
+    return PyLong_FromSsize_t(num);
+}
+
+static PyObject *message_add(MessageObject *self, PyObject *args, PyObject *kwds) {
+    Py_ssize_t n = PyTuple_GET_SIZE(args);
+    PyObject *setargs = PyTuple_New(n + 1);
+    if (!setargs) return NULL;
+    PyTuple_SET_ITEM(setargs, 0, PyLong_FromSsize_t(self->last_msg + 1));
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *a = PyTuple_GET_ITEM(args, i);
+        Py_INCREF(a);
+        PyTuple_SET_ITEM(setargs, i + 1, a);
+    }
+    PyObject *ret = message_set(self, setargs, kwds);
+    Py_DECREF(setargs);
+    return ret;
+}
+
+static PyObject *message_init_layer(MessageObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"parent", "logging", NULL};
+    PyObject *parent;
+    int logging = 0;
+    isn_layer_t *p;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", kwlist, &parent, &logging)) return NULL;
+    if (self->last_msg + 1 != self->size) {
+        return PyErr_Format(PyExc_ValueError, "Message table size not matching, expected %zd, found %zd", self->size, self->last_msg + 1);
+    }
+    if (to_layer(&self->base, parent, &p, 0)) return NULL;
+
+    if (logging) isn_msg_setlogging(ISN_LOGGER_LOG_LEVEL_TRACE);
+    isn_msg_init(&self->msg, self->table, (uint8_t)self->size, p);
+    self->initialized = 1;
+    Py_RETURN_NONE;
+}
+
+static PyObject *message_send(MessageObject *self, PyObject *args) {
+    unsigned char num, priority = 4;
+    if (!PyArg_ParseTuple(args, "b|b", &num, &priority)) return NULL;
+    if (!self->initialized || num >= self->size) return PyErr_Format(PyExc_ValueError, "message %d is out of range, or not initialized", num);
+    isn_msg_send(&self->msg, num, priority);
+    Py_RETURN_NONE;
+}
+
+/** Sends the message of the given handler, python or C */
+static PyObject *message_sendqby(MessageObject *self, PyObject *args) {
+    PyObject *handler;
+    unsigned char priority = 4;
+    if (!PyArg_ParseTuple(args, "O|b", &handler, &priority)) return NULL;
+    if (!self->initialized) return PyErr_Format(PyExc_ValueError, "not initialized");
+
+    for (Py_ssize_t i = 0; i < self->size; i++) {
+        if (self->handlers[i] == handler) {
+            isn_msg_send(&self->msg, (uint8_t)i, priority);
+            return PyLong_FromSsize_t(i);
+        }
+    }
+    isn_events_handler_t fn = (isn_events_handler_t)to_pointer(handler);
+    if (!fn) return NULL;
+    return PyLong_FromLong(isn_msg_sendqby(&self->msg, fn, priority, 1));
+}
+
+static PyObject *message_sched(MessageObject *self, PyObject *unused) {
+    if (!self->initialized) return PyErr_Format(PyExc_ValueError, "not initialized");
+    return PyLong_FromLong(isn_msg_sched(&self->msg));
+}
+
+static void message_dealloc(MessageObject *self) {
+    PyMem_Free(self->table);
+    PyMem_Free(self->handlers);
+    layer_dealloc(&self->base);
+}
+
+static PyMethodDef message_methods[] = {
+    {"add", (PyCFunction)(void(*)(void))message_add, METH_VARARGS | METH_KEYWORDS, "add(desc, size, handler, ptr=True, priority=0) returns the message number"},
+    {"set", (PyCFunction)(void(*)(void))message_set, METH_VARARGS | METH_KEYWORDS, "set(msg_num, desc, size, handler, ptr=True, priority=0)"},
+    {"init", (PyCFunction)(void(*)(void))message_init_layer, METH_VARARGS | METH_KEYWORDS, "init(parent, logging=False) once all messages are given"},
+    {"send", (PyCFunction)message_send, METH_VARARGS, "send(msg_num, priority=4)"},
+    {"sendqby", (PyCFunction)message_sendqby, METH_VARARGS, "sendqby(handler, priority=4)"},
+    {"sched", (PyCFunction)message_sched, METH_NOARGS, "Schedule received callbacks and send pending messages"},
+    {"stats", (PyCFunction)layer_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+EMBEDDED_NEW(message, MessageObject, msg)
+
+LAYER_TYPE(Message, MessageObject, "Message(size), Message Layer",
+    .tp_init = (initproc)message_init, .tp_methods = message_methods, .tp_dealloc = (destructor)message_dealloc,
+    .tp_new = message_new);
+
+/*--------------------------------------------------------------------*/
+/* Serial and UDP                                                     */
+/*--------------------------------------------------------------------*/
+
+typedef struct {
+    LayerObject base;
+    isn_serial_driver_t *serial;
+}
+SerialObject;
+
+static int serial_init(SerialObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"port", "child", "baudrate", "databits", "stopbits", "parity", "logging", NULL};
+    const char *port;
+    PyObject *child;
+    int logging = 0;
+    isn_serial_driver_params_t params = isn_serial_driver_default_params;
+    isn_layer_t *c;
+    params.baud_rate = 115200;
+    params.data_bits = 8;
+    params.stop_bits = 1;
+    params.parity    = ISN_PARITY_NONE;
+    params.flow_control = ISN_FLOW_CONTROL_NONE;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO|iiiip", kwlist, &port, &child,
+            &params.baud_rate, &params.data_bits, &params.stop_bits, &params.parity, &logging)) return -1;
+    if (self->serial || to_layer(&self->base, child, &c, 0)) return -1;
+
+    if (logging) isn_serial_driver_setlogging(ISN_LOGGER_LOG_LEVEL_TRACE);
+    if (!(self->serial = isn_serial_driver_create(port, &params, c))) {
+        PyErr_Format(PyExc_OSError, "Cannot open %s", port);
+        return -1;
+    }
+    self->base.layer = self->serial;
+    return 0;
+}
+
+static PyObject *serial_poll(SerialObject *self, PyObject *args) {
+    long long timeout = 1000;
+    int ret;
+    if (!PyArg_ParseTuple(args, "|L", &timeout)) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ret = isn_serial_driver_poll(self->serial, timeout);
+    Py_END_ALLOW_THREADS
+    if (PyErr_CheckSignals() < 0) return NULL;
+    return PyLong_FromLong(ret);
+}
+
+static PyObject *serial_stats(SerialObject *self, PyObject *unused) {
+    return stats_dict(isn_serial_driver_get_stats(self->serial));
+}
+
+static void serial_dealloc(SerialObject *self) {
+    if (self->serial) isn_serial_driver_free(self->serial);
+    layer_dealloc(&self->base);
+}
+
+static PyMethodDef serial_methods[] = {
+    {"poll", (PyCFunction)serial_poll, METH_VARARGS, "poll(timeout=1000) in ms, with the GIL released"},
+    {"stats", (PyCFunction)serial_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+LAYER_TYPE(Serial, SerialObject, "Serial(port, child, baudrate=115200, databits=8, stopbits=1, parity=PARITY_NONE, logging=False)",
+    .tp_init = (initproc)serial_init, .tp_methods = serial_methods, .tp_dealloc = (destructor)serial_dealloc);
+
+typedef struct {
+    LayerObject base;
+    isn_udp_driver_t *udp;
+}
+UDPObject;
+
+static int udp_init(UDPObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"server_port", "child", "broadcast", "logging", NULL};
+    unsigned short server_port;
+    PyObject *child;
+    int broadcast = 0, logging = 0;
+    isn_layer_t *c;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "HO|ip", kwlist, &server_port, &child, &broadcast, &logging)) return -1;
+    if (self->udp || to_layer(&self->base, child, &c, 0)) return -1;
+
+    if (logging) isn_udp_driver_setlogging(ISN_LOGGER_LOG_LEVEL_TRACE);
+    if (!(self->udp = isn_udp_driver_create(server_port, c, broadcast))) {
+        PyErr_Format(PyExc_OSError, "Cannot open the UDP port %u", server_port);
+        return -1;
+    }
+    self->base.layer = self->udp;
+    return 0;
+}
+
+static PyObject *udp_poll(UDPObject *self, PyObject *args) {
+    long long timeout = 1000;
+    int ret;
+    if (!PyArg_ParseTuple(args, "|L", &timeout)) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ret = isn_udp_driver_poll(self->udp, timeout);
+    Py_END_ALLOW_THREADS
+    if (PyErr_CheckSignals() < 0) return NULL;
+    return PyLong_FromLong(ret);
+}
+
+static PyObject *udp_add_client(UDPObject *self, PyObject *args) {
+    const char *host, *port;
+    if (!PyArg_ParseTuple(args, "ss", &host, &port)) return NULL;
+    return PyLong_FromLong(isn_udp_driver_addclient(self->udp, host, port));
+}
+
+static PyObject *udp_stats(UDPObject *self, PyObject *unused) {
+    return stats_dict(isn_udp_driver_get_stats(self->udp));
+}
+
+static void udp_dealloc(UDPObject *self) {
+    if (self->udp) isn_udp_driver_free(self->udp);
+    layer_dealloc(&self->base);
+}
+
+static PyMethodDef udp_methods[] = {
+    {"poll", (PyCFunction)udp_poll, METH_VARARGS, "poll(timeout=1000) in ms, with the GIL released"},
+    {"add_client", (PyCFunction)udp_add_client, METH_VARARGS, "add_client(host, port)"},
+    {"stats", (PyCFunction)udp_stats, METH_NOARGS, "Driver statistics"},
+    {NULL}
+};
+
+LAYER_TYPE(UDP, UDPObject, "UDP(server_port, child, broadcast=0, logging=False)",
+    .tp_init = (initproc)udp_init, .tp_methods = udp_methods, .tp_dealloc = (destructor)udp_dealloc);
+
+/*--------------------------------------------------------------------*/
+/* Module                                                             */
+/*--------------------------------------------------------------------*/
+
+static PyObject *write_layer(PyObject *args, int with_minsize) {
+    PyObject *layer;
+    Py_buffer b;
+    Py_ssize_t size = -1, minsize = -1;
+    if (!PyArg_ParseTuple(args, with_minsize ? "Oy*nn" : "Oy*|n", &layer, &b, &size, &minsize)) return NULL;
+
+    isn_layer_t *l = to_pointer(layer);
+    if (size < 0 || size > b.len) size = b.len;
+    if (minsize < 0 || minsize > size) minsize = size;
+    int ret = l ? isn_write_atleast(l, b.buf, (size_t)size, (size_t)minsize) : 0;
+    PyBuffer_Release(&b);
+    return l ? PyLong_FromLong(ret) : NULL;
+}
+
+static PyObject *io_write(PyObject *module, PyObject *args) {
+    return write_layer(args, 0);
+}
+
+static PyObject *io_write_atleast(PyObject *module, PyObject *args) {
+    return write_layer(args, 1);
+}
+
+static PyObject *clock_update(PyObject *module, PyObject *unused) {
+    return PyLong_FromUnsignedLong(isn_clock_update());
+}
+
+static PyObject *disable_stdout_buffer_py(PyObject *module, PyObject *unused) {
+    disable_stdout_buffer();
+    Py_RETURN_NONE;
+}
+
+/** Callables are wrapped by the Receiver and Message, so the clibisn.py conversions are not needed */
+static PyObject *get_callable(PyObject *module, PyObject *callback) {
+    Py_INCREF(callback);
+    return callback;
+}
+
+/** Address of a layer, or of a ctypes object as by the ctypes.addressof() */
+static PyObject *addressof(PyObject *module, PyObject *obj) {
+    if (PyObject_TypeCheck(obj, &LayerType)) return PyLong_FromVoidPtr(((LayerObject *)obj)->layer);
+
+    PyObject *ctypes = PyImport_ImportModule("ctypes");
+    PyObject *ret = ctypes ? PyObject_CallMethod(ctypes, "addressof", "O", obj) : NULL;
+    Py_XDECREF(ctypes);
+    return ret;
+}
+
+static PyMethodDef module_methods[] = {
+    {"io_write", io_write, METH_VARARGS, "io_write(layer, data[, size]) writes a bytes-like object to the layer"},
+    {"io_write_atleast", io_write_atleast, METH_VARARGS, "io_write_atleast(layer, data, size, minsize)"},
+    {"clock_update", clock_update, METH_NOARGS, "Update the library clock, returns the counter"},
+    {"disable_stdout_buffer", disable_stdout_buffer_py, METH_NOARGS, "Immediate output of the library logs"},
+    {"get_cbptr", get_callable, METH_O, "get_cbptr(callback) returns the callback, for the clibisn.py compatibility"},
+    {"get_recvptr", get_callable, METH_O, "get_recvptr(function) returns the function, for the clibisn.py compatibility"},
+    {"addressof", addressof, METH_O, "addressof(obj) of a layer, or of a ctypes object"},
+    {NULL}
+};
+
+static struct PyModuleDef clibisn_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name    = "_clibisn",
+    .m_doc     = "Native ISN library bindings, an alternative to the ctypes based clibisn",
+    .m_size    = -1,
+    .m_methods = module_methods,
+};
+
+/** Class constants of the clibisn.py */
+static int add_constant(PyTypeObject *type, const char *name, long value) {
+    PyObject *v = PyLong_FromLong(value);
+    int err = v ? PyDict_SetItemString(type->tp_dict, name, v) : -1;
+    Py_XDECREF(v);
+    PyType_Modified(type);
+    return err;
+}
+
+static int set_constant(PyObject *obj, const char *name, long value) {
+    PyObject *v = PyLong_FromLong(value);
+    int err = v ? PyObject_SetAttrString(obj, name, v) : -1;
+    Py_XDECREF(v);
+    return err;
+}
+
+PyMODINIT_FUNC PyInit__clibisn(void) {
+    PyTypeObject *types[] = {
+        &LayerType, &ReceiverType, &FrameType, &UserType, &TransportType, &DupType,
+        &RedirectType, &DispatchType, &MessageType, &SerialType, &UDPType
+    };
+    PyObject *m = PyModule_Create(&clibisn_module);
+    if (!m) return NULL;
+
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (PyType_Ready(types[i]) < 0) goto error;
+        Py_INCREF(types[i]);
+        if (PyModule_AddObject(m, types[i]->tp_name + sizeof("_clibisn"), (PyObject *)types[i]) < 0) {
+            Py_DECREF(types[i]);
+            goto error;
+        }
+    }
+    if (PyModule_AddIntConstant(m, "ISN_PROTO_PING", ISN_PROTO_PING) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_FRAME", ISN_PROTO_FRAME) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_MSG", ISN_PROTO_MSG) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_TRANS", ISN_PROTO_TRANS) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_TRANL", ISN_PROTO_TRANL) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_OTHER", ISN_PROTO_OTHER) ||
+        PyModule_AddIntConstant(m, "ISN_PROTO_LISTEND", ISN_PROTO_LISTEND) ||
+        PyModule_AddIntConstant(m, "MODE_SHORT", ISN_FRAME_MODE_SHORT) ||
+        PyModule_AddIntConstant(m, "MODE_COMPACT", ISN_FRAME_MODE_COMPACT) ||
+        PyModule_AddIntConstant(m, "PARITY_NONE", ISN_PARITY_NONE) ||
+        PyModule_AddIntConstant(m, "PARITY_ODD", ISN_PARITY_ODD) ||
+        PyModule_AddIntConstant(m, "PARITY_EVEN", ISN_PARITY_EVEN)) goto error;
+
+    if (add_constant(&FrameType, "MODE_SHORT", ISN_FRAME_MODE_SHORT) ||
+        add_constant(&FrameType, "MODE_COMPACT", ISN_FRAME_MODE_COMPACT) ||
+        add_constant(&SerialType, "PARITY_NONE", ISN_PARITY_NONE) ||
+        add_constant(&SerialType, "PARITY_ODD", ISN_PARITY_ODD) ||
+        add_constant(&SerialType, "PARITY_EVEN", ISN_PARITY_EVEN) ||
+        add_constant(&MessageType, "DEFAULT_PRIORITY", 0) ||
+        add_constant(&MessageType, "MSG_PRI_DESCRIPTION", ISN_MSG_PRI_DESCRIPTION) ||
+        add_constant(&MessageType, "MSG_PRI_DESCRIPTIONLOW", ISN_MSG_PRI_DESCRIPTIONLOW) ||
+        add_constant(&MessageType, "MSG_PRI_QUERY_ARGS", ISN_MSG_PRI_QUERY_ARGS) ||
+        add_constant(&MessageType, "MSG_PRI_QUERY_WAIT", __ISN_MSG_PRI_QUERY_WAIT) ||
+        add_constant(&MessageType, "MGG_PRI_UPDATE_ARGS", ISN_MGG_PRI_UPDATE_ARGS)) goto error;
+
+    /* Bindings.ISN_PROTO_OTHER and LISTEND, as of the clibisn.py */
+    PyObject *types_module = PyImport_ImportModule("types");
+    PyObject *bindings = types_module ? PyObject_CallMethod(types_module, "SimpleNamespace", NULL) : NULL;
+    Py_XDECREF(types_module);
+    if (!bindings ||
+        set_constant(bindings, "ISN_PROTO_OTHER", ISN_PROTO_OTHER) ||
+        set_constant(bindings, "ISN_PROTO_LISTEND", ISN_PROTO_LISTEND) ||
+        PyModule_AddObject(m, "Bindings", bindings) < 0) {
+        Py_XDECREF(bindings);
+        goto error;
+    }
+    return m;
+
+error:
+    Py_DECREF(m);
+    return NULL;
+}
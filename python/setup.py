@@ -0,0 +1,32 @@
+"""
+Builds the native _clibisn module, with the library sources compiled in
+
+    python setup.py build_ext --inplace
+"""
+import os
+import re
+from setuptools import setup, Extension
+
+here = os.path.dirname(os.path.abspath(__file__))
+libisn = os.path.join(here, '..', 'c')
+
+
+def library_sources():
+    """ Same sources as of the CMake library, and the posix drivers """
+    with open(os.path.join(libisn, 'src', 'CMakeLists.txt')) as f:
+        names = re.findall(r'^\s+(isn_\w+\.c)\s*$', f.read(), re.MULTILINE)
+    sources = [os.path.join('..', 'c', 'src', n) for n in names]
+    sources += [os.path.join('..', 'c', 'src', 'posix', n) for n in ('isn_clock.c', 'isn_serial.c', 'isn_udp.c')]
+    return sources
+
+
+setup(
+    name='clibisn',
+    version='1.0',
+    description='Native bindings of the ISN Protocol Library',
+    py_modules=['clibisn'],
+    ext_modules=[Extension('_clibisn',
+                           sources=['isnmodule.c'] + library_sources(),
+                           include_dirs=[libisn, os.path.join(libisn, 'include')],
+                           libraries=['ws2_32'] if os.name == 'nt' else [])],
+)